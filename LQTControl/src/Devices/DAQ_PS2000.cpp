@@ -1,7 +1,6 @@
-#include "daq_PS2000.h"
-#include <QtWidgets>
-#include <QtWidgets/QApplication>
-#include <QtWidgets/QMainWindow>
+#include "DAQ_PS2000.h"
+
+daq_PS2000 *daq_PS2000::m_streamingInstance{ nullptr };
 
 /*
  * Public definitions
@@ -41,6 +40,9 @@ void daq_PS2000::setAcquisitionParameters() {
 	// initialize the ADC
 	set_defaults();
 
+	// a block started with the old settings must not be read
+	discardBlockData();
+
 	/* Trigger disabled */
 	ps2000_set_trigger(m_unitOpened.handle, PS2000_NONE, 0, PS2000_RISING, 0, m_acquisitionParameters.auto_trigger_ms);
 
@@ -63,56 +65,6 @@ void daq_PS2000::setAcquisitionParameters() {
 	emit acquisitionParametersChanged(m_acquisitionParameters);
 }
 
-std::array<std::vector<int32_t>, PS2000_MAX_CHANNELS> daq_PS2000::collectBlockData() {
-
-	int32_t times[DAQ_BUFFER_SIZE];
-
-	/* Start collecting data,
-	*  wait for completion */
-	ps2000_run_block(
-		m_unitOpened.handle,
-		m_acquisitionParameters.no_of_samples,
-		m_acquisitionParameters.timebase,
-		m_acquisitionParameters.oversample,
-		&m_acquisitionParameters.time_indisposed_ms
-	);
-
-	while (!ps2000_ready(m_unitOpened.handle)) {
-		Sleep(10);
-	}
-
-	ps2000_stop(m_unitOpened.handle);
-
-	/* Should be done now...
-	*  get the times (in nanoseconds)
-	*  and the values (in ADC counts)
-	*/
-
-	ps2000_get_times_and_values(
-		m_unitOpened.handle,
-		times,
-		m_unitOpened.channelSettings[PS2000_CHANNEL_A].values,
-		m_unitOpened.channelSettings[PS2000_CHANNEL_B].values,
-		NULL,
-		NULL,
-		&m_overflow,
-		m_acquisitionParameters.time_units,
-		m_acquisitionParameters.no_of_samples
-	);
-
-
-	// create vector of voltage values
-	std::array<std::vector<int32_t>, PS2000_MAX_CHANNELS> values;
-	for (gsl::index i{ 0 }; i < m_acquisitionParameters.no_of_samples; i++) {
-		for (gsl::index ch{ 0 }; ch < m_unitOpened.noOfChannels; ch++) {
-			if (m_unitOpened.channelSettings[ch].enabled) {
-				values[ch].push_back(adc_to_mv(m_unitOpened.channelSettings[ch].values[i], m_unitOpened.channelSettings[ch].range));
-			}
-		}
-	}
-	return values;
-}
-
 void daq_PS2000::setOutputVoltage(double voltage) {
 	ps2000_set_sig_gen_built_in(
 		m_unitOpened.handle,			// handle of the oscilloscope
@@ -168,6 +120,97 @@ void daq_PS2000::disconnect() {
  * Private definitions
  */
 
+void daq_PS2000::runBlock() {
+	/* Start collecting data */
+	ps2000_run_block(
+		m_unitOpened.handle,
+		m_acquisitionParameters.no_of_samples,
+		m_acquisitionParameters.timebase,
+		m_acquisitionParameters.oversample,
+		&m_acquisitionParameters.time_indisposed_ms
+	);
+}
+
+void daq_PS2000::readBlock(std::array<std::vector<int32_t>, PS2000_MAX_CHANNELS> &values) {
+
+	int32_t times[DAQ_BUFFER_SIZE];
+
+	/* Wait for completion */
+	while (!ps2000_ready(m_unitOpened.handle)) {
+		Sleep(10);
+	}
+
+	ps2000_stop(m_unitOpened.handle);
+
+	/* Should be done now...
+	*  get the times (in nanoseconds)
+	*  and the values (in ADC counts)
+	*/
+
+	ps2000_get_times_and_values(
+		m_unitOpened.handle,
+		times,
+		m_unitOpened.channelSettings[PS2000_CHANNEL_A].values,
+		m_unitOpened.channelSettings[PS2000_CHANNEL_B].values,
+		NULL,
+		NULL,
+		&m_overflow,
+		m_acquisitionParameters.time_units,
+		m_acquisitionParameters.no_of_samples
+	);
+
+
+	// create vector of voltage values, clearing keeps the capacity
+	for (auto &channel : values) {
+		channel.clear();
+	}
+	for (gsl::index i{ 0 }; i < m_acquisitionParameters.no_of_samples; i++) {
+		for (gsl::index ch{ 0 }; ch < m_unitOpened.noOfChannels; ch++) {
+			if (m_unitOpened.channelSettings[ch].enabled) {
+				values[ch].push_back(adc_to_mv(m_unitOpened.channelSettings[ch].values[i], m_unitOpened.channelSettings[ch].range));
+			}
+		}
+	}
+}
+
+bool daq_PS2000::runStreaming() {
+	m_streamingInstance = this;
+	// the driver aggregates nothing and keeps at most one second of data
+	auto maxSamples = (uint32_t)(1e9 / m_streamingInterval);
+	int16_t ok = ps2000_run_streaming_ns(
+		m_unitOpened.handle,
+		m_streamingInterval,				// sample interval
+		PS2000_NS,							// time units of the sample interval
+		maxSamples,							// maximum number of samples kept by the driver
+		0,									// don't stop automatically
+		1,									// number of samples per aggregate
+		DAQ_BUFFER_SIZE						// size of the overview buffers
+	);
+	return (ok != 0);
+}
+
+void daq_PS2000::pollStreaming() {
+	ps2000_get_streaming_last_values(m_unitOpened.handle, &daq_PS2000::streamingCallback);
+}
+
+void daq_PS2000::haltStreaming() {
+	ps2000_stop(m_unitOpened.handle);
+	m_streamingInstance = nullptr;
+}
+
+void __stdcall daq_PS2000::streamingCallback(int16_t **overviewBuffers, int16_t overflow, uint32_t triggeredAt, int16_t triggered, int16_t auto_stop, uint32_t nValues) {
+	if (!m_streamingInstance) {
+		return;
+	}
+	m_streamingInstance->m_overflow = overflow;
+	// without aggregation the maximum and minimum buffers contain the same values
+	for (gsl::index ch{ 0 }; ch < m_streamingInstance->m_unitOpened.noOfChannels; ch++) {
+		if (m_streamingInstance->m_unitOpened.channelSettings[ch].enabled && overviewBuffers[ch * 2]) {
+			m_streamingInstance->appendStreamingValues(ch, overviewBuffers[ch * 2], nValues);
+		}
+	}
+}
+
 /****************************************************************************
 * set_defaults - restore default settings
 ****************************************************************************/
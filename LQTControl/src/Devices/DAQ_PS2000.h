@@ -1,9 +1,7 @@
 #ifndef DAQ_PS2000_H
 #define DAQ_PS2000_H
 
-#include <QMainWindow>
-#include <QtCore/QObject>
-#include <QtWidgets>
+#include <QtCore>
 #include <vector>
 #include <array>
 #include <chrono>
@@ -12,8 +10,8 @@
 #include <gsl/gsl>
 #include "ps2000.h"
 #include "daq.h"
-#include "..\circularBuffer.h"
-#include "..\generalmath.h"
+#include "../circularBuffer.h"
+#include "../generalmath.h"
 
 #define DAQ_BUFFER_SIZE 	8000
 #define SINGLE_CH_SCOPE 1				// Single channel scope
@@ -38,7 +36,6 @@ class daq_PS2000 : public daq {
 		explicit daq_PS2000(QObject *parent);
 		~daq_PS2000();
 		void setAcquisitionParameters() override;
-		std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> collectBlockData() override;
 		void setOutputVoltage(double voltage) override;
 
 		double getCurrentSamplingRate() override;
@@ -51,6 +48,16 @@ class daq_PS2000 : public daq {
 		void set_defaults(void) override;
 		void get_info(void) override;
 
+		void runBlock() override;
+		void readBlock(std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> &values) override;
+
+		bool runStreaming() override;
+		void pollStreaming() override;
+		void haltStreaming() override;
+		static void __stdcall streamingCallback(int16_t **overviewBuffers, int16_t overflow, uint32_t triggeredAt, int16_t triggered, int16_t auto_stop, uint32_t nValues);
+		// the PS2000 streaming callback has no user parameter
+		static daq_PS2000 *m_streamingInstance;
+
 		int m_defaultTimebaseIndex{ 10 };
 };
 
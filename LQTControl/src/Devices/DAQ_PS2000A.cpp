@@ -1,7 +1,4 @@
-#include "daq_PS2000A.h"
-#include <QtWidgets>
-#include <QtWidgets/QApplication>
-#include <QtWidgets/QMainWindow>
+#include "DAQ_PS2000A.h"
 
 /*
  * Public definitions
@@ -45,6 +42,9 @@ void daq_PS2000A::setAcquisitionParameters() {
 	// initialize the ADC
 	set_defaults();
 
+	// a block started with the old settings must not be read
+	discardBlockData();
+
 	/* Trigger disabled */
 	ps2000aSetSimpleTrigger(
 		m_unitOpened.handle,		// handle
@@ -76,65 +76,6 @@ void daq_PS2000A::setAcquisitionParameters() {
 	emit acquisitionParametersChanged(m_acquisitionParameters);
 }
 
-std::array<std::vector<int32_t>, PS2000A_MAX_CHANNELS> daq_PS2000A::collectBlockData() {
-
-	/* Start collecting data,
-	*  wait for completion */
-	ps2000aRunBlock(
-		m_unitOpened.handle,						// handle
-		0,										// noOfPreTriggerSamples
-		m_acquisitionParameters.no_of_samples,	// noOfPostTriggerSamples
-		m_acquisitionParameters.timebase,			// timebase
-		m_acquisitionParameters.oversample,		// oversample
-		&m_acquisitionParameters.time_indisposed_ms,	//timeIndisposedMs
-		0,										// segmentIndex
-		NULL,									// lpReady
-		NULL									// * pParameter
-	);
-
-	int16_t ready{ 0 };
-	ps2000aIsReady(m_unitOpened.handle, &ready);
-	while (!ready) {
-		Sleep(10);
-		ps2000aIsReady(m_unitOpened.handle, &ready);
-	}
-
-	for (gsl::index ch{ 0 }; ch < 4; ch++) {
-		ps2000aSetDataBuffers(
-			m_unitOpened.handle,
-			(int16_t)ch,
-			buffers[ch * 2],
-			buffers[ch * 2 + 1],
-			DAQ_BUFFER_SIZE,
-			0,
-			PS2000A_RATIO_MODE_NONE
-		);
-	}
-
-	ps2000aGetValues(
-		m_unitOpened.handle,
-		0,
-		&m_acquisitionParameters.no_of_samples,
-		NULL,
-		PS2000A_RATIO_MODE_NONE,
-		0,
-		NULL
-	);
-
-	ps2000aStop(m_unitOpened.handle);
-
-	// create vector of voltage values
-	std::array<std::vector<int32_t>, PS2000A_MAX_CHANNELS> values;
-	for (gsl::index i{ 0 }; i < static_cast<int32_t>(m_acquisitionParameters.no_of_samples); i++) {
-		for (gsl::index ch{ 0 }; ch < m_unitOpened.noOfChannels; ch++) {
-			if (m_unitOpened.channelSettings[ch].enabled) {
-				values[ch].push_back(adc_to_mv(buffers[ch * 2][i], m_unitOpened.channelSettings[ch].range));
-			}
-		}
-	}
-	return values;
-}
-
 void daq_PS2000A::setOutputVoltage(double voltage) {
 	ps2000aSetSigGenBuiltIn(
 		m_unitOpened.handle,			// handle of the oscilloscope
@@ -200,6 +141,118 @@ void daq_PS2000A::disconnect() {
  * Private definitions
  */
 
+void daq_PS2000A::runBlock() {
+	/* Start collecting data */
+	ps2000aRunBlock(
+		m_unitOpened.handle,						// handle
+		0,										// noOfPreTriggerSamples
+		m_acquisitionParameters.no_of_samples,	// noOfPostTriggerSamples
+		m_acquisitionParameters.timebase,			// timebase
+		m_acquisitionParameters.oversample,		// oversample
+		&m_acquisitionParameters.time_indisposed_ms,	//timeIndisposedMs
+		0,										// segmentIndex
+		NULL,									// lpReady
+		NULL									// * pParameter
+	);
+}
+
+void daq_PS2000A::readBlock(std::array<std::vector<int32_t>, PS2000A_MAX_CHANNELS> &values) {
+
+	/* Wait for completion */
+	int16_t ready{ 0 };
+	ps2000aIsReady(m_unitOpened.handle, &ready);
+	while (!ready) {
+		Sleep(10);
+		ps2000aIsReady(m_unitOpened.handle, &ready);
+	}
+
+	for (gsl::index ch{ 0 }; ch < 4; ch++) {
+		ps2000aSetDataBuffers(
+			m_unitOpened.handle,
+			(int16_t)ch,
+			buffers[ch * 2],
+			buffers[ch * 2 + 1],
+			DAQ_BUFFER_SIZE,
+			0,
+			PS2000A_RATIO_MODE_NONE
+		);
+	}
+
+	ps2000aGetValues(
+		m_unitOpened.handle,
+		0,
+		&m_acquisitionParameters.no_of_samples,
+		NULL,
+		PS2000A_RATIO_MODE_NONE,
+		0,
+		NULL
+	);
+
+	ps2000aStop(m_unitOpened.handle);
+
+	// create vector of voltage values, clearing keeps the capacity
+	for (auto &channel : values) {
+		channel.clear();
+	}
+	for (gsl::index i{ 0 }; i < static_cast<int32_t>(m_acquisitionParameters.no_of_samples); i++) {
+		for (gsl::index ch{ 0 }; ch < m_unitOpened.noOfChannels; ch++) {
+			if (m_unitOpened.channelSettings[ch].enabled) {
+				values[ch].push_back(adc_to_mv(buffers[ch * 2][i], m_unitOpened.channelSettings[ch].range));
+			}
+		}
+	}
+}
+
+
+bool daq_PS2000A::runStreaming() {
+	for (gsl::index ch{ 0 }; ch < m_unitOpened.noOfChannels; ch++) {
+		ps2000aSetDataBuffers(
+			m_unitOpened.handle,
+			(int16_t)ch,
+			buffers[ch * 2],
+			buffers[ch * 2 + 1],
+			DAQ_BUFFER_SIZE,
+			0,
+			PS2000A_RATIO_MODE_NONE
+		);
+	}
+
+	PICO_STATUS status = ps2000aRunStreaming(
+		m_unitOpened.handle,
+		&m_streamingInterval,				// sample interval, set to the actual interval by the driver
+		PS2000A_NS,							// time units of the sample interval
+		0,									// maxPreTriggerSamples
+		(uint32_t)(1e9 / m_streamingInterval),	// maxPostTriggerSamples, one second of data
+		0,									// don't stop automatically
+		1,									// downSampleRatio
+		PS2000A_RATIO_MODE_NONE,			// downSampleRatioMode
+		DAQ_BUFFER_SIZE						// overviewBufferSize
+	);
+	return (status == PICO_OK);
+}
+
+void daq_PS2000A::pollStreaming() {
+	ps2000aGetStreamingLatestValues(m_unitOpened.handle, &daq_PS2000A::streamingCallback, this);
+}
+
+void daq_PS2000A::haltStreaming() {
+	ps2000aStop(m_unitOpened.handle);
+}
+
+void __stdcall daq_PS2000A::streamingCallback(int16_t handle, int32_t noOfSamples, uint32_t startIndex, int16_t overflow, uint32_t triggerAt, int16_t triggered, int16_t autoStop, void *pParameter) {
+	auto device = static_cast<daq_PS2000A *>(pParameter);
+	if (!device || noOfSamples <= 0) {
+		return;
+	}
+	device->m_overflow = overflow;
+	// the driver copied the new values to the buffers registered in runStreaming()
+	for (gsl::index ch{ 0 }; ch < device->m_unitOpened.noOfChannels; ch++) {
+		if (device->m_unitOpened.channelSettings[ch].enabled) {
+			device->appendStreamingValues(ch, &device->buffers[ch * 2][startIndex], noOfSamples);
+		}
+	}
+}
+
 /****************************************************************************
 * set_defaults - restore default settings
 ****************************************************************************/
@@ -1,9 +1,7 @@
 #ifndef DAQ_PS2000A_H
 #define DAQ_PS2000A_H
 
-#include <QMainWindow>
-#include <QtCore/QObject>
-#include <QtWidgets>
+#include <QtCore>
 #include <vector>
 #include <array>
 #include <chrono>
@@ -12,8 +10,8 @@
 #include <gsl/gsl>
 #include "ps2000aApi.h"
 #include "daq.h"
-#include "..\circularBuffer.h"
-#include "..\generalmath.h"
+#include "../circularBuffer.h"
+#include "../generalmath.h"
 
 #define DAQ_BUFFER_SIZE 	8000
 #define SINGLE_CH_SCOPE 1				// Single channel scope
@@ -40,7 +38,6 @@ class daq_PS2000A : public daq {
 		explicit daq_PS2000A(QObject *parent);
 		~daq_PS2000A();
 		void setAcquisitionParameters() override;
-		std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> collectBlockData() override;
 		void setOutputVoltage(double voltage) override;
 
 		double getCurrentSamplingRate() override;
@@ -53,6 +50,14 @@ class daq_PS2000A : public daq {
 		void set_defaults(void) override;
 		void get_info(void) override;
 
+		void runBlock() override;
+		void readBlock(std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> &values) override;
+
+		bool runStreaming() override;
+		void pollStreaming() override;
+		void haltStreaming() override;
+		static void __stdcall streamingCallback(int16_t handle, int32_t noOfSamples, uint32_t startIndex, int16_t overflow, uint32_t triggerAt, int16_t triggered, int16_t autoStop, void *pParameter);
+
 		int m_defaultTimebaseIndex{ 12 };
 
 		int16_t buffers[PS2000A_MAX_CHANNEL_BUFFERS][DAQ_BUFFER_SIZE * sizeof(int16_t)]{ 0 };
@@ -0,0 +1,243 @@
+#include "DAQ_Synthetic.h"
+
+/*
+ * Public definitions
+ */
+
+daq_Synthetic::daq_Synthetic(QObject *parent) :
+	daq(parent,
+		{ 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000 },
+		{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 },
+		200e6
+	) {
+	m_acquisitionParameters.timebaseIndex = m_defaultTimebaseIndex;
+	m_acquisitionParameters.timebase = m_availableTimebases[m_defaultTimebaseIndex];
+	// calculate sampling rates
+	m_availableSamplingRates.resize(m_availableTimebases.size());
+	std::transform(m_availableTimebases.begin(), m_availableTimebases.end(), m_availableSamplingRates.begin(),
+		[this](int timebase) {
+			return this->m_maxSamplingRate / pow(2, timebase);
+		}
+	);
+	if (qEnvironmentVariableIsSet("LQTCONTROL_DAQ_SEED")) {
+		bool ok{ false };
+		uint seed = qEnvironmentVariable("LQTCONTROL_DAQ_SEED").toUInt(&ok);
+		m_settings.seed = ok ? seed : m_settings.seed;
+	}
+	if (qEnvironmentVariableIsSet("LQTCONTROL_DAQ_NOISE")) {
+		bool ok{ false };
+		double noise = qEnvironmentVariable("LQTCONTROL_DAQ_NOISE").toDouble(&ok);
+		m_settings.noise = ok ? noise : m_settings.noise;
+	}
+	if (qEnvironmentVariableIsSet("LQTCONTROL_DAQ_LATENCY")) {
+		bool ok{ false };
+		int latency = qEnvironmentVariable("LQTCONTROL_DAQ_LATENCY").toInt(&ok);
+		m_settings.captureLatency = ok ? latency : m_settings.captureLatency;
+	}
+}
+
+daq_Synthetic::~daq_Synthetic() {
+	disconnect();
+}
+
+void daq_Synthetic::setAcquisitionParameters() {
+	for (gsl::index ch{ 0 }; ch < m_unitOpened.noOfChannels; ch++) {
+		m_unitOpened.channelSettings[ch].enabled = m_acquisitionParameters.channelSettings[ch].enabled;
+		m_unitOpened.channelSettings[ch].coupling = m_acquisitionParameters.channelSettings[ch].coupling;
+		m_unitOpened.channelSettings[ch].range = m_acquisitionParameters.channelSettings[ch].range;
+	}
+
+	set_defaults();
+
+	// a block started with the old settings must not be read
+	discardBlockData();
+
+	// the synthetic device keeps as many samples as a real one
+	m_acquisitionParameters.oversample = 1;
+	m_acquisitionParameters.max_samples = DAQ_BUFFER_SIZE;
+	if (m_acquisitionParameters.no_of_samples > (uint32_t)m_acquisitionParameters.max_samples) {
+		m_acquisitionParameters.no_of_samples = m_acquisitionParameters.max_samples;
+	}
+	m_acquisitionParameters.time_interval = (int32_t)round(1e9 / getCurrentSamplingRate());
+	m_acquisitionParameters.time_units = 2;	// nanoseconds
+
+	emit acquisitionParametersChanged(m_acquisitionParameters);
+}
+
+void daq_Synthetic::setOutputVoltage(double voltage) {
+	// the signal generator of the PS2000 has an offset range of +-2 V
+	voltage = (voltage > 2.0) ? 2.0 : voltage;
+	voltage = (voltage < -2.0) ? -2.0 : voltage;
+	m_outputVoltage = voltage;
+}
+
+double daq_Synthetic::getCurrentSamplingRate() {
+	return this->m_maxSamplingRate / pow(2, m_acquisitionParameters.timebase);
+}
+
+void daq_Synthetic::setSyntheticSettings(SYNTHETIC_SETTINGS settings) {
+	m_settings = settings;
+	m_generator.seed(m_settings.seed);
+}
+
+SYNTHETIC_SETTINGS daq_Synthetic::getSyntheticSettings() {
+	return m_settings;
+}
+
+void daq_Synthetic::setDetuningModel(std::function<double(std::chrono::time_point<std::chrono::system_clock>)> model) {
+	m_detuningModel = model;
+}
+
+/*
+ * Public slots
+ */
+
+void daq_Synthetic::connect() {
+	if (!m_isConnected) {
+		// every connection starts from the same state, so runs are reproducible
+		m_generator.seed(m_settings.seed);
+		m_noise.reset();
+		m_uniform.reset();
+		m_time = 0;
+		m_outputVoltage = 0;
+		get_info();
+		setAcquisitionParameters();
+		m_isConnected = true;
+	}
+	emit(connected(m_isConnected));
+}
+
+void daq_Synthetic::disconnect() {
+	if (m_isConnected) {
+		if (timer && timer->isActive()) {
+			timer->stop();
+			m_acquisitionRunning = false;
+		}
+		stopStreaming();
+		m_isConnected = false;
+	}
+	emit(connected(m_isConnected));
+}
+
+/*
+ * Private definitions
+ */
+
+void daq_Synthetic::runBlock() {
+	// the capture starts at m_blockStartTime, which is set by the caller
+	m_acquisitionParameters.time_indisposed_ms = (int32_t)(1e3 * m_acquisitionParameters.no_of_samples / getCurrentSamplingRate());
+}
+
+void daq_Synthetic::readBlock(std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> &values) {
+	// a real device is only ready once the capture and the transfer are finished
+	auto captureDuration = std::chrono::microseconds((int64_t)(1e6 * m_acquisitionParameters.no_of_samples / getCurrentSamplingRate()));
+	Clock::get()->sleepUntil(m_blockStartTime + captureDuration + std::chrono::milliseconds(m_settings.captureLatency));
+
+	generateSamples(m_acquisitionParameters.no_of_samples, getCurrentSamplingRate(), m_blockStartTime);
+
+	// create vector of voltage values, clearing keeps the capacity
+	for (auto &channel : values) {
+		channel.clear();
+	}
+	for (gsl::index i{ 0 }; i < m_acquisitionParameters.no_of_samples; i++) {
+		for (gsl::index ch{ 0 }; ch < m_unitOpened.noOfChannels; ch++) {
+			if (m_unitOpened.channelSettings[ch].enabled) {
+				values[ch].push_back(adc_to_mv(m_unitOpened.channelSettings[ch].values[i], m_unitOpened.channelSettings[ch].range));
+			}
+		}
+	}
+}
+
+bool daq_Synthetic::runStreaming() {
+	m_streamingStart = Clock::get()->now();
+	m_streamedSamples = 0;
+	return true;
+}
+
+void daq_Synthetic::pollStreaming() {
+	// hand over the samples the device would have acquired since the last poll
+	double samplingRate = 1e9 / m_streamingInterval;
+	double elapsed = std::chrono::duration_cast<std::chrono::microseconds>(Clock::get()->now() - m_streamingStart).count() / 1e6;
+	auto due = (uint64_t)(elapsed * samplingRate);
+	while (m_streamedSamples < due) {
+		// the overview buffers of the driver hold at most DAQ_BUFFER_SIZE samples per call
+		auto nrSamples = (uint32_t)((due - m_streamedSamples < DAQ_BUFFER_SIZE) ? due - m_streamedSamples : DAQ_BUFFER_SIZE);
+		auto start = m_streamingStart + std::chrono::microseconds((int64_t)(1e6 * m_streamedSamples / samplingRate));
+		generateSamples(nrSamples, samplingRate, start);
+		for (gsl::index ch{ 0 }; ch < m_unitOpened.noOfChannels; ch++) {
+			if (m_unitOpened.channelSettings[ch].enabled) {
+				appendStreamingValues(ch, m_unitOpened.channelSettings[ch].values, nrSamples);
+			}
+		}
+		m_streamedSamples += nrSamples;
+	}
+}
+
+void daq_Synthetic::haltStreaming() {
+	m_streamedSamples = 0;
+}
+
+/*
+ * Fills the value buffers of the enabled channels with nrSamples samples in ADC counts, the first one taken at start.
+ * The transmission through the cell is a Lorentzian line, the laser is detuned by the drift
+ * and the output voltage of the signal generator, or as the detuning model tells.
+ */
+void daq_Synthetic::generateSamples(uint32_t nrSamples, double samplingRate, std::chrono::time_point<std::chrono::system_clock> start) {
+	m_overflow = 0;
+	gsl::index overflowSample{ -1 };
+	if (m_settings.overflowRate > 0 && m_uniform(m_generator) < m_settings.overflowRate) {
+		overflowSample = (gsl::index)(m_uniform(m_generator) * nrSamples);
+	}
+
+	double dt = 1 / samplingRate;
+	for (gsl::index i{ 0 }; i < (gsl::index)nrSamples; i++) {
+		double detuning = (m_settings.detuning + m_settings.drift * m_time + m_outputVoltage) / m_settings.linewidth;
+		if (m_detuningModel) {
+			auto time = start + std::chrono::microseconds((int64_t)(1e6 * i * dt));
+			detuning = (m_detuningModel(time) + m_outputVoltage) / m_settings.linewidth;
+		}
+		double transmission = 1 - m_settings.absorptionDepth / (1 + detuning * detuning);
+
+		double absorption = m_settings.absorptionLevel * transmission + m_settings.offsetA + m_settings.noise * m_noise(m_generator);
+		double reference = m_settings.referenceLevel + m_settings.offsetB + m_settings.noise * m_noise(m_generator);
+		if (i == overflowSample) {
+			absorption = 2.0 * m_input_ranges[m_unitOpened.channelSettings[0].range];
+		}
+
+		m_unitOpened.channelSettings[0].values[i] = toADC(absorption, 0);
+		m_unitOpened.channelSettings[1].values[i] = toADC(reference, 1);
+		m_time += dt;
+	}
+}
+
+// Converts to ADC counts in the current range of the channel and flags samples beyond the range.
+int16_t daq_Synthetic::toADC(double mv, gsl::index ch) {
+	if (!m_unitOpened.channelSettings[ch].enabled) {
+		return 0;
+	}
+	double adc = mv * 32767 / m_input_ranges[m_unitOpened.channelSettings[ch].range];
+	if (adc > 32767 || adc < -32767) {
+		m_overflow |= (1 << ch);
+		adc = (adc > 0) ? 32767 : -32767;
+	}
+	return (int16_t)round(adc);
+}
+
+void daq_Synthetic::set_defaults(void) {
+	// there is no hardware to configure, the channel settings are read while generating
+}
+
+void daq_Synthetic::get_info(void) {
+	m_unitOpened.handle = 1;
+	m_unitOpened.model = 0;
+	m_unitOpened.firstRange = 0;
+	m_unitOpened.lastRange = (int)m_input_ranges.size() - 1;
+	m_unitOpened.maxTimebase = m_availableTimebases.back();
+	m_unitOpened.timebases = m_unitOpened.maxTimebase;
+	m_unitOpened.noOfChannels = DUAL_SCOPE;
+	m_unitOpened.hasAdvancedTriggering = false;
+	m_unitOpened.hasSignalGenerator = true;
+	m_unitOpened.hasEts = false;
+	m_unitOpened.hasFastStreaming = true;
+	m_unitOpened.bufferSize = DAQ_BUFFER_SIZE;
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#ifndef DAQ_SYNTHETIC_H
+#define DAQ_SYNTHETIC_H
+
+#include <QtCore>
+#include <vector>
+#include <array>
+#include <chrono>
+#include <random>
+#include <functional>
+
+#include <gsl/gsl>
+#include "daq.h"
+
+typedef struct SYNTHETIC_SETTINGS {
+	uint32_t seed{ 1 };					//		seed of the noise and overflow generator
+	double referenceLevel{ 400 };		// [mV]	signal of the reference detector (channel B)
+	double absorptionLevel{ 150 };		// [mV]	signal behind the absorption cell (channel A) far from the line
+	double absorptionDepth{ 0.8 };		// [1]	fraction of the light absorbed on resonance
+	double linewidth{ 0.5 };			// [V]	half width at half maximum of the line in units of the output voltage
+	double detuning{ 0.5 };				// [V]	detuning of the laser from the line at zero output voltage
+	double drift{ 0.001 };				// [V/s]	drift of the detuning
+	double noise{ 1.0 };				// [mV]	standard deviation of the noise on both channels
+	double offsetA{ 0 };				// [mV]	offset of channel A
+	double offsetB{ 0 };				// [mV]	offset of channel B
+	double overflowRate{ 0 };			// [1]	probability of a block or poll containing a sample beyond the range
+	int captureLatency{ 2 };			// [ms]	time between the end of a capture and the block being ready
+} SYNTHETIC_SETTINGS;
+
+/*
+ * A simulated data acquisition, which needs neither the PicoScope SDK nor a device.
+ * It generates the absorption and reference signals of a laser tuned across an absorption line.
+ * The signals only depend on the seed and on the number of samples generated since connecting,
+ * so two runs with the same settings produce the same data.
+ */
+class daq_Synthetic : public daq {
+	Q_OBJECT
+
+	public:
+		explicit daq_Synthetic(QObject *parent);
+		~daq_Synthetic();
+		void setAcquisitionParameters() override;
+		void setOutputVoltage(double voltage) override;
+
+		double getCurrentSamplingRate() override;
+
+		void setSyntheticSettings(SYNTHETIC_SETTINGS settings);
+		SYNTHETIC_SETTINGS getSyntheticSettings();
+
+		// Replaces the detuning and drift of the settings by a model of the laser, e.g. a digital twin.
+		// The model returns the detuning [V] at the time of a sample, the output voltage is added to it.
+		void setDetuningModel(std::function<double(std::chrono::time_point<std::chrono::system_clock>)> model);
+
+	public slots:
+		void connect() override;
+		void disconnect() override;
+
+	private:
+		void set_defaults(void) override;
+		void get_info(void) override;
+
+		void runBlock() override;
+		void readBlock(std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> &values) override;
+
+		bool runStreaming() override;
+		void pollStreaming() override;
+		void haltStreaming() override;
+
+		void generateSamples(uint32_t nrSamples, double samplingRate, std::chrono::time_point<std::chrono::system_clock> start);
+		int16_t toADC(double mv, gsl::index ch);
+
+		SYNTHETIC_SETTINGS m_settings;
+		std::mt19937 m_generator;
+		std::normal_distribution<double> m_noise{ 0.0, 1.0 };
+		std::uniform_real_distribution<double> m_uniform{ 0.0, 1.0 };
+		double m_time{ 0 };						// [s]	time of the next generated sample
+		double m_outputVoltage{ 0 };			// [V]	current output voltage of the signal generator
+		std::chrono::time_point<std::chrono::system_clock> m_streamingStart;	// time the streaming was started
+		std::function<double(std::chrono::time_point<std::chrono::system_clock>)> m_detuningModel{ nullptr };
+		uint64_t m_streamedSamples{ 0 };		//		number of samples generated since the streaming was started
+
+		int m_defaultTimebaseIndex{ 10 };
+};
+
+#endif // DAQ_SYNTHETIC_H
\ No newline at end of file
@@ -1,29 +1,109 @@
 #include "LQT.h"
+#if defined(Q_OS_WIN)
 #include <windows.h>
-
-LQT::LQT() noexcept {}
+#endif
+#include <algorithm>
+#include <QThread>
+
+LQT::LQT() noexcept {
+	// allows to use another port, e.g. the pseudo-terminal of the LQT emulator
+	if (qEnvironmentVariableIsSet("LQTCONTROL_LASER_PORT")) {
+		m_portName = qEnvironmentVariable("LQTCONTROL_LASER_PORT").toStdString();
+	}
+	if (qEnvironmentVariableIsSet("LQTCONTROL_LASER_TRACE")) {
+		m_traceFile = qEnvironmentVariable("LQTCONTROL_LASER_TRACE").toStdString();
+	}
+	if (qEnvironmentVariableIsSet("LQTCONTROL_LASER_REPLAY")) {
+		m_replayFile = qEnvironmentVariable("LQTCONTROL_LASER_REPLAY").toStdString();
+		bool ok{ false };
+		double timeScale = qEnvironmentVariable("LQTCONTROL_LASER_REPLAY_SCALE").toDouble(&ok);
+		m_replayTimeScale = ok ? timeScale : 1.0;
+	}
+	for (gsl::index i{ 0 }; i < static_cast<int>(LQT_COMMAND::COUNT); i++) {
+		m_commandStatistics[i].command = static_cast<LQT_COMMAND>(i);
+	}
+	// queries are answered immediately, settings might take the laser a moment
+	m_commandStatistics[static_cast<int>(LQT_COMMAND::GETTEMPERATURE)].timeout = 200;
+	m_commandStatistics[static_cast<int>(LQT_COMMAND::GETMAXTEMPERATURE)].timeout = 200;
+	m_commandStatistics[static_cast<int>(LQT_COMMAND::GETMOD)].timeout = 200;
+	m_commandStatistics[static_cast<int>(LQT_COMMAND::GETLOCK)].timeout = 200;
+	m_commandStatistics[static_cast<int>(LQT_COMMAND::GETLE)].timeout = 200;
+	for (gsl::index i{ 0 }; i < static_cast<int>(LQT_PRIORITY::COUNT); i++) {
+		m_priorityStatistics[i].priority = static_cast<LQT_PRIORITY>(i);
+	}
+}
 
 LQT::~LQT() {
 	disconnect();
 }
 
 void LQT::init() {
-	m_laserPort = new QSerialPort();
+	if (!m_laserPort) {
+		if (m_replayFile.size() > 0) {
+			m_laserPort = std::make_unique<ReplayTransport>(m_replayTimeScale);
+			m_portName = m_replayFile;
+		} else {
+			m_laserPort = std::make_unique<QSerialPortTransport>();
+		}
+	}
+	if (m_traceFile.size() > 0) {
+		m_laserPort = std::make_unique<RecordingTransport>(m_laserPort.release(), m_traceFile);
+	}
+	m_statusTimer = new QTimer();
+	QMetaObject::Connection connection = QObject::connect(
+		m_statusTimer,
+		&QTimer::timeout,
+		this,
+		&LQT::pollStatus
+	);
+	m_verificationTimer = new QTimer();
+	m_verificationTimer->setSingleShot(true);
+	connection = QObject::connect(
+		m_verificationTimer,
+		&QTimer::timeout,
+		this,
+		&LQT::verifyDeferred
+	);
+	// Waking the event loop does not allocate, unlike posting a queued call for every request.
+	// The dispatcher signals it is awake on every pass of the event loop.
+	auto dispatcher = QAbstractEventDispatcher::instance();
+	if (dispatcher) {
+		connection = QObject::connect(
+			dispatcher,
+			&QAbstractEventDispatcher::awake,
+			this,
+			&LQT::processScheduledQueue
+		);
+		m_dispatcher = dispatcher;
+	}
 }
 
 void LQT::connect() {
 	if (!m_isConnected) {
-		m_laserPort->setPortName("COM1");
-		m_laserPort->setBaudRate(QSerialPort::Baud19200);
-		m_laserPort->setStopBits(QSerialPort::OneStop);
-		m_laserPort->setParity(QSerialPort::NoParity);
-		m_isConnected = m_laserPort->open(QIODevice::ReadWrite);
-		readSettings();
+		m_isConnected = m_laserPort->open(m_portName, m_baudRate);
+		m_pipelining = true;
+		// the cached values are of no use after reconnecting
+		{
+			std::lock_guard<std::mutex> lock(m_shadowMutex);
+			m_shadow = LQT_SHADOW{};
+		}
+		{
+			std::lock_guard<std::mutex> lock(m_verificationMutex);
+			m_verificationStatistics = VERIFICATION_STATISTICS{};
+			m_unverifiedSetpoint = NAN;
+		}
+		request(LQT_COMMAND::READSETTINGS, 0, LQT_PRIORITY::STATUS);
+		if (m_isConnected && m_statusPollingInterval > 0) {
+			m_statusTimer->start(m_statusPollingInterval);
+		}
 	}
 	emit(connected(m_isConnected));
 }
 
 void LQT::disconnect() {
+	if (m_statusTimer) {
+		m_statusTimer->stop();
+	}
 	if (m_isConnected) {
 		m_laserPort->close();
 	}
@@ -31,40 +111,486 @@ void LQT::disconnect() {
 	emit(connected(m_isConnected));
 }
 
-void LQT::readSettings() {
-	m_settings.temperature = getTemperature();
-	m_settings.maxTemperature = getMaxTemperature();
-	m_settings.modEnabled = getMod();
-	m_settings.lockEnabled = getLe();
-	m_settings.lock = getLock();
+// The queries are written in small batches, more important requests may run in between.
+// Only the settings whose cached value is stale are queried, unless forced.
+void LQT::readSettings(LQT_PRIORITY priority, bool force) {
+	std::vector<LQT_QUERY> queries;
+	{
+		std::lock_guard<std::mutex> lock(m_shadowMutex);
+		double temperature;
+		bool state;
+		if (force || !getShadowValue(m_shadow.temperature, temperature)) {
+			queries.push_back({ "utempoffset?", LQT_COMMAND::GETTEMPERATURE });
+		}
+		if (force || !getShadowValue(m_shadow.maxTemperature, temperature)) {
+			queries.push_back({ "maxutempoffset?", LQT_COMMAND::GETMAXTEMPERATURE });
+		}
+		if (force || !getShadowValue(m_shadow.modEnabled, state)) {
+			queries.push_back({ "Mod?", LQT_COMMAND::GETMOD });
+		}
+		if (force || !getShadowValue(m_shadow.lockEnabled, state)) {
+			queries.push_back({ "Le?", LQT_COMMAND::GETLE });
+		}
+		if (force || !getShadowValue(m_shadow.lock, state)) {
+			queries.push_back({ "Lock?", LQT_COMMAND::GETLOCK });
+		}
+	}
+
+	for (size_t i{ 0 }; i < queries.size(); i += m_batchSize) {
+		size_t end = (i + m_batchSize < queries.size()) ? i + m_batchSize : queries.size();
+		std::vector<LQT_QUERY> batch(queries.begin() + i, queries.begin() + end);
+		std::vector<std::string> responses;
+		if (!m_pipelining || !receiveBatch(batch, responses)) {
+			// Some devices drop input while they are busy answering, query them one by one.
+			if (m_pipelining) {
+				qWarning("The laser did not answer the pipelined queries, falling back to sequential queries.");
+				m_pipelining = false;
+			}
+			responses.clear();
+			for (const auto &query : batch) {
+				responses.push_back(receive(query.request, query.command));
+			}
+		}
+		{
+			std::lock_guard<std::mutex> lock(m_shadowMutex);
+			for (size_t j{ 0 }; j < batch.size(); j++) {
+				const auto &response = responses[j];
+				if (response.size() == 0) {
+					continue;
+				}
+				double temperature;
+				switch (batch[j].command) {
+					case LQT_COMMAND::GETTEMPERATURE:
+						if (parseTemperature(response, temperature)) {
+							updateShadow(m_shadow.temperature, temperature);
+						}
+						break;
+					case LQT_COMMAND::GETMAXTEMPERATURE:
+						if (parseTemperature(response, temperature)) {
+							updateShadow(m_shadow.maxTemperature, temperature);
+						}
+						break;
+					case LQT_COMMAND::GETMOD:
+						updateShadow(m_shadow.modEnabled, response != "Laser Modulation OFF");
+						break;
+					case LQT_COMMAND::GETLE:
+						updateShadow(m_shadow.lockEnabled, response != "LOCK ENABLE=OFF");
+						break;
+					case LQT_COMMAND::GETLOCK:
+						updateShadow(m_shadow.lock, response != "LOCK=OFF");
+						break;
+					default:
+						break;
+				}
+			}
+		}
+		yieldTo(priority);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_shadowMutex);
+		m_settings.temperature = m_shadow.temperature.value;
+		m_settings.maxTemperature = m_shadow.maxTemperature.value;
+		m_settings.modEnabled = m_shadow.modEnabled.value;
+		m_settings.lockEnabled = m_shadow.lockEnabled.value;
+		m_settings.lock = m_shadow.lock.value;
+	}
 
 	emit(settingsChanged(m_settings));
 }
 
+void LQT::pollStatus() {
+	request(LQT_COMMAND::READSETTINGS, 0, LQT_PRIORITY::STATUS);
+}
+
+void LQT::setStatusPollingInterval(int interval) {
+	m_statusPollingInterval = interval;
+	if (!m_statusTimer) {
+		return;
+	}
+	if (m_isConnected && m_statusPollingInterval > 0) {
+		m_statusTimer->start(m_statusPollingInterval);
+	} else {
+		m_statusTimer->stop();
+	}
+}
+
 /*
  * Functions regarding the serial communication
  */
 
-std::string LQT::receive(std::string request) {
+void LQT::setTransport(SerialTransport *transport) {
+	m_laserPort.reset(transport);
+}
+
+void LQT::setPort(std::string port, int baudRate) {
+	m_portName = port;
+	m_baudRate = baudRate;
+}
+
+void LQT::setTraceFile(std::string traceFile) {
+	m_traceFile = traceFile;
+}
+
+void LQT::setReplayFile(std::string replayFile, double timeScale) {
+	m_replayFile = replayFile;
+	m_replayTimeScale = timeScale;
+}
+
+// A non-negative timeout shortens the timeout of the command, e.g. to the remaining latency budget.
+std::string LQT::receive(std::string request, LQT_COMMAND command, int timeout) {
 
 	m_laserPort->clear();
+	m_receiveBuffer.clear();
+
+	int commandTimeout = m_commandStatistics[static_cast<int>(command)].timeout;
+	timeout = (timeout >= 0 && timeout < commandTimeout) ? timeout : commandTimeout;
+	auto start = std::chrono::steady_clock::now();
+	auto deadline = start + std::chrono::milliseconds(timeout);
 
 	request = request + m_terminator;
 	writeToDevice(request.c_str());
 
+	// Read until the terminator of the response arrived instead of waiting for a gap
 	std::string response{ "" };
-	if (m_laserPort->waitForBytesWritten(1000)) {
-		// read response
-		if (m_laserPort->waitForReadyRead(1000)) {
-			QByteArray responseData = m_laserPort->readAll();
-			while (m_laserPort->waitForReadyRead(10))
-				responseData += m_laserPort->readAll();
+	bool answered{ false };
+	if (m_laserPort->waitForBytesWritten(timeout)) {
+		while (!(answered = extractResponse(response))) {
+			auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+			if (remaining <= 0 || !m_laserPort->waitForReadyRead((int)remaining)) {
+				break;
+			}
+			QByteArray received = m_laserPort->readAll();
+			m_receiveBuffer.append(received.constData(), received.size());
+		}
+	}
+	recordLatency(command, start, answered);
 
-			response = responseData;
+	return response;
+}
+
+// Writes all queries back to back and assigns the responses in order. Returns false if a
+// response is missing or does not match its query, the responses cannot be trusted then.
+// The latency of every response is measured from the time its query was written.
+bool LQT::receiveBatch(const std::vector<LQT_QUERY> &queries, std::vector<std::string> &responses) {
+
+	m_laserPort->clear();
+	m_receiveBuffer.clear();
+	responses.clear();
+
+	std::vector<std::chrono::steady_clock::time_point> sent;
+	int timeout{ 0 };
+	for (const auto &query : queries) {
+		sent.push_back(std::chrono::steady_clock::now());
+		writeToDevice((query.request + m_terminator).c_str());
+		timeout += m_commandStatistics[static_cast<int>(query.command)].timeout;
+	}
+
+	if (!m_laserPort->waitForBytesWritten(timeout)) {
+		return false;
+	}
+	for (size_t i{ 0 }; i < queries.size(); i++) {
+		const auto &query = queries[i];
+		// every response gets the timeout of its command from the previous response on
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_commandStatistics[static_cast<int>(query.command)].timeout);
+		std::string response{ "" };
+		bool answered{ false };
+		while (!(answered = extractResponse(response))) {
+			auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+			if (remaining <= 0 || !m_laserPort->waitForReadyRead((int)remaining)) {
+				break;
+			}
+			QByteArray received = m_laserPort->readAll();
+			m_receiveBuffer.append(received.constData(), received.size());
+		}
+		recordLatency(query.command, sent[i], answered);
+		if (!answered || !lqtResponse::isValid(query.command, response)) {
+			return false;
 		}
+		responses.push_back(response);
 	}
+	return true;
+}
 
-	return stripCRLF(response);
+// Returns false if the response is no temperature, a malformed response is dropped with a warning.
+bool LQT::parseTemperature(const std::string &response, double &temperature) {
+	if (response.size() == 0) {
+		return false;
+	}
+	if (!lqtResponse::parseTemperature(response, temperature)) {
+		qWarning("The laser sent no valid temperature: %s", response.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool LQT::extractResponse(std::string &response) {
+	return lqtResponse::extract(m_receiveBuffer, response);
+}
+
+void LQT::recordLatency(LQT_COMMAND command, std::chrono::steady_clock::time_point start, bool answered) {
+	auto &statistics = m_commandStatistics[static_cast<int>(command)];
+	statistics.requests++;
+	if (answered) {
+		double latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() / 1e3;
+		auto nrAnswered = statistics.requests - statistics.timeouts;
+		statistics.lastLatency = latency;
+		statistics.meanLatency += (latency - statistics.meanLatency) / nrAnswered;
+		statistics.maxLatency = (latency > statistics.maxLatency) ? latency : statistics.maxLatency;
+	} else {
+		statistics.timeouts++;
+		qWarning("The laser did not answer command %d within %d ms.", static_cast<int>(command), statistics.timeout);
+	}
+	emit(commandStatisticsChanged(statistics));
+}
+
+/*
+ * Non-blocking functions
+ */
+
+// Pending setpoints are coalesced, so only the newest one is written and
+// every caller of the coalesced request gets its result.
+std::shared_future<double> LQT::setTemperatureAsync(double temperature, LQT_PRIORITY priority, std::function<void(double)> callback) {
+	return request(LQT_COMMAND::SETTEMPERATURE, temperature, priority, callback);
+}
+
+// Served from the cache without using the serial line as long as the cached value is not stale,
+// the callback is invoked immediately then.
+std::shared_future<double> LQT::getTemperatureAsync(LQT_PRIORITY priority, std::function<void(double)> callback) {
+	double temperature;
+	bool cached;
+	{
+		std::lock_guard<std::mutex> lock(m_shadowMutex);
+		cached = getShadowValue(m_shadow.temperature, temperature);
+	}
+	if (!cached) {
+		return request(LQT_COMMAND::GETTEMPERATURE, 0, priority, callback);
+	}
+	std::promise<double> promise;
+	promise.set_value(temperature);
+	if (callback) {
+		callback(temperature);
+	}
+	return promise.get_future().share();
+}
+
+void LQT::refreshTemperature(LQT_PRIORITY priority) {
+	double temperature;
+	bool cached;
+	{
+		std::lock_guard<std::mutex> lock(m_shadowMutex);
+		cached = getShadowValue(m_shadow.temperature, temperature);
+	}
+	if (!cached) {
+		post(LQT_COMMAND::GETTEMPERATURE, 0, priority);
+	}
+}
+
+double LQT::getLastTemperature() {
+	std::lock_guard<std::mutex> lock(m_shadowMutex);
+	return m_shadow.temperature.value;
+}
+
+double LQT::getLastTemperature(std::chrono::steady_clock::time_point &updated) {
+	std::lock_guard<std::mutex> lock(m_shadowMutex);
+	updated = m_shadow.temperature.updated;
+	return m_shadow.temperature.value;
+}
+
+LQT_SHADOW LQT::getShadow() {
+	std::lock_guard<std::mutex> lock(m_shadowMutex);
+	return m_shadow;
+}
+
+// Has to be called with the shadow mutex locked.
+template <typename T>
+void LQT::updateShadow(SHADOW_VALUE<T> &field, T value) {
+	field.value = value;
+	field.updated = std::chrono::steady_clock::now();
+	field.valid = true;
+}
+
+// Returns false if the cached value is stale, has to be called with the shadow mutex locked.
+template <typename T>
+bool LQT::getShadowValue(const SHADOW_VALUE<T> &field, T &value) {
+	value = field.value;
+	if (!field.valid) {
+		return false;
+	}
+	auto age = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - field.updated).count();
+	return age <= field.maxAge;
+}
+
+// Queues a command, requests of a higher priority class are executed first.
+// A pending request of the same command is replaced and takes the higher priority of both.
+std::shared_future<double> LQT::request(LQT_COMMAND command, double value, LQT_PRIORITY priority, std::function<void(double)> callback) {
+	std::shared_future<double> future;
+	enqueue(command, value, priority, callback, &future);
+	return future;
+}
+
+void LQT::post(LQT_COMMAND command, double value, LQT_PRIORITY priority) {
+	enqueue(command, value, priority, nullptr, nullptr);
+}
+
+// The writes of the lock loop are posted without a future, so they do not allocate.
+void LQT::enqueue(LQT_COMMAND command, double value, LQT_PRIORITY priority, std::function<void(double)> callback, std::shared_future<double> *future) {
+	m_queue.enqueue(command, value, priority, callback, future);
+	if (!m_processScheduled.exchange(true)) {
+		auto dispatcher = m_dispatcher.load();
+		if (dispatcher) {
+			dispatcher->wakeUp();
+		} else {
+			QMetaObject::invokeMethod(this, &LQT::processQueue, Qt::QueuedConnection);
+		}
+	}
+}
+
+bool LQT::hasPendingRequest(LQT_COMMAND command) {
+	return m_queue.hasPending(command);
+}
+
+bool LQT::hasPendingRequest(LQT_PRIORITY above) {
+	return m_queue.hasPending(above);
+}
+
+size_t LQT::getQueueLength() {
+	return m_queue.size();
+}
+
+size_t LQT::getPendingCallbacks() {
+	return m_queue.pendingCallbacks();
+}
+
+bool LQT::takeRequest(LQT_REQUEST &request, int above) {
+	return m_queue.take(request, above);
+}
+
+void LQT::processQueue() {
+	m_processScheduled = false;
+	LQT_REQUEST request;
+	while (takeRequest(request)) {
+		runRequest(request);
+	}
+}
+
+void LQT::processScheduledQueue() {
+	if (m_processScheduled) {
+		processQueue();
+	}
+}
+
+// Runs all pending requests of a higher priority class than the running one.
+// Long running requests call this between two round trips.
+void LQT::yieldTo(LQT_PRIORITY running) {
+	LQT_REQUEST request;
+	bool preempted{ false };
+	while (takeRequest(request, (int)running)) {
+		preempted = true;
+		runRequest(request);
+	}
+	if (preempted) {
+		std::lock_guard<std::mutex> lock(m_statisticsMutex);
+		m_priorityStatistics[static_cast<int>(running)].preemptions++;
+	}
+}
+
+void LQT::runRequest(LQT_REQUEST &request) {
+	auto started = std::chrono::steady_clock::now();
+	double result = execute(request);
+	auto finished = std::chrono::steady_clock::now();
+
+	double wait = std::chrono::duration_cast<std::chrono::microseconds>(started - request.queued).count() / 1e3;
+	double latency = std::chrono::duration_cast<std::chrono::microseconds>(finished - request.queued).count() / 1e3;
+	PRIORITY_STATISTICS statistics;
+	{
+		// the statistics are read from other threads
+		std::lock_guard<std::mutex> lock(m_statisticsMutex);
+		auto &stats = m_priorityStatistics[static_cast<int>(request.priority)];
+		stats.requests++;
+		stats.meanWait += (wait - stats.meanWait) / stats.requests;
+		stats.maxWait = (wait > stats.maxWait) ? wait : stats.maxWait;
+		stats.meanLatency += (latency - stats.meanLatency) / stats.requests;
+		stats.maxLatency = (latency > stats.maxLatency) ? latency : stats.maxLatency;
+		statistics = stats;
+	}
+	emit(priorityStatisticsChanged(statistics));
+
+	if (request.promise) {
+		request.promise->set_value(result);
+	}
+	for (auto &callback : request.callbacks) {
+		callback(result);
+	}
+}
+
+double LQT::execute(LQT_REQUEST &request) {
+	double result{ nan("1") };
+	switch (request.command) {
+		case LQT_COMMAND::SETTEMPERATURE: {
+			// Stop retrying as soon as a newer setpoint or more important work is pending,
+			// so a stale value is never written after a newer one.
+			bool verified{ false };
+			result = writeVerified(request.value, getLastTemperature(), [this](double value, int timeout) { return setTemperature(value, timeout); },
+				[this, &request]() { return hasPendingRequest(LQT_COMMAND::SETTEMPERATURE) || hasPendingRequest(request.priority); },
+				verified);
+			std::lock_guard<std::mutex> lock(m_verificationMutex);
+			if (!verified && m_verificationPolicy.deferVerification) {
+				m_unverifiedSetpoint = request.value;
+				m_unverifiedPriority = request.priority;
+				// don't postpone a scheduled verification, it checks the newest setpoint anyway
+				if (!m_verificationTimer->isActive()) {
+					m_verificationTimer->start(m_verificationPolicy.verificationDelay);
+				}
+			} else {
+				m_unverifiedSetpoint = NAN;
+			}
+			break;
+		}
+		case LQT_COMMAND::GETTEMPERATURE:
+			result = getTemperature();
+			break;
+		case LQT_COMMAND::TEMPERATURECONTROL:
+			enableTemperatureControl(request.value != 0);
+			result = request.value;
+			break;
+		case LQT_COMMAND::READSETTINGS:
+			readSettings(request.priority);
+			result = m_settings.temperature;
+			break;
+		default:
+			break;
+	}
+	return result;
+}
+
+PRIORITY_STATISTICS LQT::getPriorityStatistics(LQT_PRIORITY priority) {
+	std::lock_guard<std::mutex> lock(m_statisticsMutex);
+	return m_priorityStatistics[static_cast<int>(priority)];
+}
+
+void LQT::setTimeout(LQT_COMMAND command, int timeout) {
+	m_commandStatistics[static_cast<int>(command)].timeout = timeout;
+}
+
+COMMAND_STATISTICS LQT::getCommandStatistics(LQT_COMMAND command) {
+	return m_commandStatistics[static_cast<int>(command)];
+}
+
+void LQT::resetCommandStatistics() {
+	for (auto &statistics : m_commandStatistics) {
+		auto command = statistics.command;
+		auto timeout = statistics.timeout;
+		statistics = COMMAND_STATISTICS{};
+		statistics.command = command;
+		statistics.timeout = timeout;
+	}
+	std::lock_guard<std::mutex> lock(m_statisticsMutex);
+	for (auto &statistics : m_priorityStatistics) {
+		auto priority = statistics.priority;
+		statistics = PRIORITY_STATISTICS{};
+		statistics.priority = priority;
+	}
 }
 
 void LQT::send(std::string message) {
@@ -96,73 +622,190 @@ std::string LQT::stripCRLF(std::string msg) {
 * Functions for setting and getting the temperature
 */
 
-double LQT::setTemperature(double temperature) {
-	std::string temp = receive(fmt::format("utempoffset={:06.3f}", temperature));
-	if (temp.size() == 0) {
+double LQT::setTemperature(double temperature, int timeout) {
+	std::string temp = receive(fmt::format("utempoffset={:06.3f}", temperature), LQT_COMMAND::SETTEMPERATURE, timeout);
+	double value;
+	if (!parseTemperature(temp, value)) {
 		return nan("1");
-	} else {
-		return stod(temp);
 	}
+	std::lock_guard<std::mutex> lock(m_shadowMutex);
+	updateShadow(m_shadow.temperature, value);
+	return value;
 }
 
 double LQT::getTemperature() {
-	std::string temp = receive("utempoffset?");
-	if (temp.size() == 0) {
+	std::string temp = receive("utempoffset?", LQT_COMMAND::GETTEMPERATURE);
+	double value;
+	if (!parseTemperature(temp, value)) {
 		return nan("1");
-	} else {
-		return stod(temp);
 	}
+	std::lock_guard<std::mutex> lock(m_shadowMutex);
+	updateShadow(m_shadow.temperature, value);
+	return value;
 }
 
-double LQT::setMaxTemperature(double temperature) {
-	std::string temp =  receive(fmt::format("maxutempoffset={:06.3f}", temperature));
-	if (temp.size() == 0) {
+double LQT::setMaxTemperature(double temperature, int timeout) {
+	std::string temp =  receive(fmt::format("maxutempoffset={:06.3f}", temperature), LQT_COMMAND::SETMAXTEMPERATURE, timeout);
+	double value;
+	if (!parseTemperature(temp, value)) {
 		return nan("1");
-	} else {
-		return stod(temp);
 	}
+	std::lock_guard<std::mutex> lock(m_shadowMutex);
+	updateShadow(m_shadow.maxTemperature, value);
+	return value;
 }
 
 double LQT::getMaxTemperature() {
-	std::string temp = receive("maxutempoffset?");
-	if (temp.size() == 0) {
+	std::string temp = receive("maxutempoffset?", LQT_COMMAND::GETMAXTEMPERATURE);
+	double value;
+	if (!parseTemperature(temp, value)) {
 		return nan("1");
-	} else {
-		return stod(temp);
 	}
+	return value;
 }
 
 // The laser sometimes does not accept the temperature setting on the first try.
-// These functions set the temperature until it has the correct value or it fails for the 10th time.
+// These functions set the temperature until it has the correct value or the verification policy gives up.
 double LQT::setTemperatureForce(double temperature) {
-	double setTemp = setTemperature(temperature);
-	gsl::index i{ 0 };
-	while (abs(setTemp - temperature) > 0.001 && i++ < 10) {
-		setTemp = setTemperature(temperature);
-	}
-	return setTemp;
+	bool verified{ false };
+	return writeVerified(temperature, getLastTemperature(), [this](double value, int timeout) { return setTemperature(value, timeout); },
+		[]() { return false; }, verified);
 }
 
 double LQT::setMaxTemperatureForce(double temperature) {
-	double setTemp = setMaxTemperature(temperature);
-	gsl::index i{ 0 };
-	while (abs(setTemp - temperature) > 0.001  && i++ < 10) {
-		setTemp = setMaxTemperature(temperature);
+	bool verified{ false };
+	return writeVerified(temperature, NAN, [this](double value, int timeout) { return setMaxTemperature(value, timeout); },
+		[]() { return false; }, verified);
+}
+
+/*
+ * Functions regarding the verification of setpoints
+ */
+
+// Writes a setpoint and repeats it until the echoed value matches, as long as the retries and the
+// latency budget of the policy allow it. Every write may only wait for the remaining budget.
+// Small steps from the previous value are written only once.
+double LQT::writeVerified(double value, double previous, std::function<double(double, int)> set, std::function<bool()> preempted, bool &verified) {
+	VERIFICATION_POLICY policy = getVerificationPolicy();
+	auto start = std::chrono::steady_clock::now();
+	auto deadline = start + std::chrono::milliseconds(policy.latencyBudget);
+	auto remaining = [deadline]() {
+		return (int)std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+	};
+
+	double result = set(value, policy.latencyBudget);
+	bool fastPath = (!isnan(previous) && abs(value - previous) < policy.fastPathStep);
+	// a missing answer (NaN) counts as a mismatch
+	verified = (abs(result - value) <= policy.tolerance);
+
+	int retries{ 0 };
+	double backoff = policy.backoff;
+	while (!verified && !fastPath && retries < policy.maxRetries && !preempted()) {
+		if (backoff > 0) {
+			if (std::chrono::steady_clock::now() + std::chrono::milliseconds((int)backoff) >= deadline) {
+				break;
+			}
+			QThread::msleep((unsigned long)backoff);
+			backoff *= policy.backoffFactor;
+		}
+		int timeout = remaining();
+		if (timeout <= 0) {
+			break;
+		}
+		result = set(value, timeout);
+		verified = (abs(result - value) <= policy.tolerance);
+		retries++;
+	}
+
+	double latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() / 1e3;
+	VERIFICATION_STATISTICS statistics;
+	{
+		std::lock_guard<std::mutex> lock(m_verificationMutex);
+		auto &stats = m_verificationStatistics;
+		stats.writes++;
+		stats.retries += retries;
+		if (verified && retries == 0) {
+			stats.acceptedFirst++;
+		} else if (verified) {
+			stats.acceptedRetry++;
+		} else if (fastPath) {
+			stats.fastPath++;
+		} else {
+			stats.unverified++;
+		}
+		stats.meanLatency += (latency - stats.meanLatency) / stats.writes;
+		stats.maxLatency = (latency > stats.maxLatency) ? latency : stats.maxLatency;
+		statistics = stats;
+	}
+	emit(verificationStatisticsChanged(statistics));
+	return result;
+}
+
+// Checks whether the laser took the last unverified temperature setpoint and writes it again if not.
+// The temperature is read through the queue, so the verification does not overtake more important requests.
+void LQT::verifyDeferred() {
+	double setpoint;
+	LQT_PRIORITY priority;
+	{
+		std::lock_guard<std::mutex> lock(m_verificationMutex);
+		setpoint = m_unverifiedSetpoint;
+		priority = m_unverifiedPriority;
+		m_unverifiedSetpoint = NAN;
 	}
-	return setTemp;
+	// a newer setpoint makes the verification obsolete
+	if (isnan(setpoint) || hasPendingRequest(LQT_COMMAND::SETTEMPERATURE)) {
+		return;
+	}
+	request(LQT_COMMAND::GETTEMPERATURE, 0, priority, [this, setpoint, priority](double temperature) {
+		if (hasPendingRequest(LQT_COMMAND::SETTEMPERATURE)) {
+			return;
+		}
+		bool accepted = (abs(temperature - setpoint) <= getVerificationPolicy().tolerance);
+		VERIFICATION_STATISTICS statistics;
+		{
+			std::lock_guard<std::mutex> lock(m_verificationMutex);
+			if (accepted) {
+				m_verificationStatistics.deferredAccepted++;
+			} else {
+				m_verificationStatistics.deferredFailed++;
+			}
+			statistics = m_verificationStatistics;
+		}
+		emit(verificationStatisticsChanged(statistics));
+		if (!accepted) {
+			request(LQT_COMMAND::SETTEMPERATURE, setpoint, priority);
+		}
+	});
+}
+
+void LQT::setVerificationPolicy(VERIFICATION_POLICY policy) {
+	std::lock_guard<std::mutex> lock(m_verificationMutex);
+	m_verificationPolicy = policy;
+}
+
+VERIFICATION_POLICY LQT::getVerificationPolicy() {
+	std::lock_guard<std::mutex> lock(m_verificationMutex);
+	return m_verificationPolicy;
+}
+
+VERIFICATION_STATISTICS LQT::getVerificationStatistics() {
+	std::lock_guard<std::mutex> lock(m_verificationMutex);
+	return m_verificationStatistics;
 }
 
 /*
  * Functions for setting and getting the lock states
  */
 
-void LQT::setFeature(std::string feature, bool value) {
+// Returns whether the laser acknowledged the setting.
+bool LQT::setFeature(std::string feature, bool value, LQT_COMMAND command) {
 	std::string msg;
 	if (value) {
-		msg = receive(feature + "=on");
+		msg = receive(feature + "=on", command);
 	} else {
-		msg = receive(feature + "=off");
+		msg = receive(feature + "=off", command);
 	}
+	return msg.size() > 0;
 }
 
 void LQT::enableTemperatureControl(bool enable) {
@@ -172,40 +815,52 @@ void LQT::enableTemperatureControl(bool enable) {
 }
 
 void LQT::setMod(bool mod) {
-	setFeature("mod", mod);
+	if (setFeature("mod", mod, LQT_COMMAND::SETMOD)) {
+		std::lock_guard<std::mutex> lock(m_shadowMutex);
+		updateShadow(m_shadow.modEnabled, mod);
+	}
 }
 
 bool LQT::getMod() {
-	std::string msg = receive("Mod?");
-	if (msg == "Laser Modulation OFF") {
-		return false;
-	} else {
-		return true;
+	std::string msg = receive("Mod?", LQT_COMMAND::GETMOD);
+	bool value = (msg != "Laser Modulation OFF");
+	if (msg.size() > 0) {
+		std::lock_guard<std::mutex> lock(m_shadowMutex);
+		updateShadow(m_shadow.modEnabled, value);
 	}
+	return value;
 }
 
 void LQT::setLock(bool lock) {
-	setFeature("Lock", lock);
+	if (setFeature("Lock", lock, LQT_COMMAND::SETLOCK)) {
+		std::lock_guard<std::mutex> shadowLock(m_shadowMutex);
+		updateShadow(m_shadow.lock, lock);
+	}
 }
 
 bool LQT::getLock() {
-	std::string msg = receive("Lock?");
-	if (msg == "LOCK=OFF") {
-		return false;
-	} else {
-		return true;
+	std::string msg = receive("Lock?", LQT_COMMAND::GETLOCK);
+	bool value = (msg != "LOCK=OFF");
+	if (msg.size() > 0) {
+		std::lock_guard<std::mutex> lock(m_shadowMutex);
+		updateShadow(m_shadow.lock, value);
 	}
+	return value;
 }
 
 void LQT::setLe(bool le) {
-	setFeature("Le", le);
+	if (setFeature("Le", le, LQT_COMMAND::SETLE)) {
+		std::lock_guard<std::mutex> lock(m_shadowMutex);
+		updateShadow(m_shadow.lockEnabled, le);
+	}
 }
 
 bool LQT::getLe() {
-	std::string msg = receive("Le?");
-	if (msg == "LOCK ENABLE=OFF") {
-		return false;
-	} else {
-		return true;
+	std::string msg = receive("Le?", LQT_COMMAND::GETLE);
+	bool value = (msg != "LOCK ENABLE=OFF");
+	if (msg.size() > 0) {
+		std::lock_guard<std::mutex> lock(m_shadowMutex);
+		updateShadow(m_shadow.lockEnabled, value);
 	}
+	return value;
 }
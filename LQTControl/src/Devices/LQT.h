@@ -1,9 +1,23 @@
 #ifndef LQT_H
 #define LQT_H
 
-#include <QSerialPort>
+#include <QTimer>
+#include <QAbstractEventDispatcher>
 #include "fmt/format.h"
 #include <gsl/gsl>
+#include <array>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <future>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include "serialTransport.h"
+#include "traceTransport.h"
+#include "requestQueue.h"
+#include "lqtResponse.h"
 
 typedef struct LQT_SETTINGS {
 	double temperature{ 0 };
@@ -13,6 +27,72 @@ typedef struct LQT_SETTINGS {
 	bool lock{ false };
 } LQT_SETTINGS;
 
+typedef struct COMMAND_STATISTICS {
+	LQT_COMMAND command{ LQT_COMMAND::OTHER };	//		the command type these statistics belong to
+	int timeout{ 1000 };						// [ms]	time to wait for the terminated response
+	uint64_t requests{ 0 };						//		number of requests sent
+	uint64_t timeouts{ 0 };						//		number of requests without a complete response
+	double lastLatency{ 0 };					// [ms]	round-trip time of the last answered request
+	double meanLatency{ 0 };					// [ms]	mean round-trip time of the answered requests
+	double maxLatency{ 0 };						// [ms]	maximum round-trip time of the answered requests
+} COMMAND_STATISTICS;
+
+typedef struct PRIORITY_STATISTICS {
+	LQT_PRIORITY priority{ LQT_PRIORITY::STATUS };	//		the priority class these statistics belong to
+	uint64_t requests{ 0 };							//		number of executed requests
+	uint64_t preemptions{ 0 };						//		number of times a running request let higher classes go first
+	double meanWait{ 0 };							// [ms]	mean time from queueing to starting a request
+	double maxWait{ 0 };							// [ms]	maximum time from queueing to starting a request
+	double meanLatency{ 0 };						// [ms]	mean time from queueing to finishing a request
+	double maxLatency{ 0 };							// [ms]	maximum time from queueing to finishing a request
+} PRIORITY_STATISTICS;
+
+// Cached value of a laser setting, only trusted up to its maximum age
+template <typename T>
+struct SHADOW_VALUE {
+	T value{};											//		last value acknowledged or reported by the laser
+	std::chrono::steady_clock::time_point updated;		//		time the value was updated
+	bool valid{ false };								//		whether the value was ever updated
+	int maxAge{ 1000 };									// [ms]	age after which the value is stale
+};
+
+typedef struct LQT_SHADOW {
+	SHADOW_VALUE<double> temperature{ NAN, {}, false, 1000 };
+	SHADOW_VALUE<double> maxTemperature{ NAN, {}, false, 60000 };
+	SHADOW_VALUE<bool> modEnabled{ false, {}, false, 5000 };
+	SHADOW_VALUE<bool> lockEnabled{ false, {}, false, 5000 };
+	SHADOW_VALUE<bool> lock{ false, {}, false, 5000 };
+} LQT_SHADOW;
+
+typedef struct VERIFICATION_POLICY {
+	int latencyBudget{ 200 };		// [ms]	maximum time spent on writing and verifying a setpoint
+	int maxRetries{ 10 };			//		maximum number of repeated writes of a setpoint
+	int backoff{ 0 };				// [ms]	wait before the first retry
+	double backoffFactor{ 2 };		// [1]	factor the wait is multiplied with after every retry
+	double tolerance{ 0.001 };		// [K]	maximum difference between the setpoint and the echoed value
+	double fastPathStep{ 0 };		// [K]	steps smaller than this are not retried, off since the laser may ignore a new setpoint
+	bool deferVerification{ true };	//		verify an unverified temperature setpoint later again
+	int verificationDelay{ 500 };	// [ms]	delay of the deferred verification
+} VERIFICATION_POLICY;
+
+typedef struct VERIFICATION_STATISTICS {
+	uint64_t writes{ 0 };			//		number of setpoints written
+	uint64_t acceptedFirst{ 0 };	//		number of setpoints accepted on the first write
+	uint64_t acceptedRetry{ 0 };	//		number of setpoints accepted after retrying
+	uint64_t unverified{ 0 };		//		number of setpoints not accepted within the budget
+	uint64_t fastPath{ 0 };			//		number of setpoints written without verification
+	uint64_t retries{ 0 };			//		number of repeated writes
+	uint64_t deferredAccepted{ 0 };	//		number of deferred verifications which found the setpoint
+	uint64_t deferredFailed{ 0 };	//		number of deferred verifications which had to write the setpoint again
+	double meanLatency{ 0 };		// [ms]	mean time spent on writing and verifying a setpoint
+	double maxLatency{ 0 };			// [ms]	maximum time spent on writing and verifying a setpoint
+} VERIFICATION_STATISTICS;
+
+typedef struct LQT_QUERY {
+	std::string request;						//		query sent to the laser
+	LQT_COMMAND command{ LQT_COMMAND::OTHER };	//		command type of the query
+} LQT_QUERY;
+
 class LQT : public QObject {
 	Q_OBJECT
 
@@ -24,7 +104,15 @@ public:
 	* Functions regarding the serial communication
 	*/
 
-	std::string receive(std::string request);
+	// has to be called before connecting, LQT takes ownership of the transport
+	void setTransport(SerialTransport *transport);
+	void setPort(std::string port, int baudRate = 19200);
+	// have to be called before init()
+	void setTraceFile(std::string traceFile);
+	void setReplayFile(std::string replayFile, double timeScale = 1.0);
+
+	std::string receive(std::string request, LQT_COMMAND command = LQT_COMMAND::OTHER, int timeout = -1);
+	bool receiveBatch(const std::vector<LQT_QUERY> &queries, std::vector<std::string> &responses);
 	void send(std::string message);
 	qint64 writeToDevice(const char * data);
 	std::string stripCRLF(std::string msg);
@@ -34,18 +122,18 @@ public:
 	*/
 
 	// temperature
-	double setTemperature(double temperature);
+	double setTemperature(double temperature, int timeout = -1);
 	double getTemperature();
 
 	// maximum temperature
-	double setMaxTemperature(double temperature);
+	double setMaxTemperature(double temperature, int timeout = -1);
 	double getMaxTemperature();
 
 	/*
 	* Functions for setting and getting the lock states
 	*/
 
-	void setFeature(std::string feature, bool value);
+	bool setFeature(std::string feature, bool value, LQT_COMMAND command = LQT_COMMAND::OTHER);
 
 	// mod status
 	void setMod(bool mod);
@@ -59,6 +147,44 @@ public:
 	void setLe(bool le);
 	bool getLe();
 
+	/*
+	* Non-blocking functions, which can be called from any thread.
+	* The requests are queued and executed on the thread of the LQT object.
+	*/
+
+	std::shared_future<double> request(LQT_COMMAND command, double value, LQT_PRIORITY priority, std::function<void(double)> callback = nullptr);
+	// queues a request without a future, so queueing it does not allocate
+	void post(LQT_COMMAND command, double value, LQT_PRIORITY priority);
+	std::shared_future<double> setTemperatureAsync(double temperature, LQT_PRIORITY priority = LQT_PRIORITY::USER, std::function<void(double)> callback = nullptr);
+	std::shared_future<double> getTemperatureAsync(LQT_PRIORITY priority = LQT_PRIORITY::USER, std::function<void(double)> callback = nullptr);
+	// queues reading the temperature only if the cached value is stale
+	void refreshTemperature(LQT_PRIORITY priority = LQT_PRIORITY::STATUS);
+	double getLastTemperature();
+	// also returns the time the laser reported the temperature
+	double getLastTemperature(std::chrono::steady_clock::time_point &updated);
+	LQT_SHADOW getShadow();
+	// number of queued requests and of the callbacks waiting for them
+	size_t getQueueLength();
+	size_t getPendingCallbacks();
+
+	/*
+	* Functions regarding the response timing
+	*/
+
+	void setTimeout(LQT_COMMAND command, int timeout);
+	void setStatusPollingInterval(int interval);
+
+	/*
+	* Functions regarding the verification of setpoints
+	*/
+
+	void setVerificationPolicy(VERIFICATION_POLICY policy);
+	VERIFICATION_POLICY getVerificationPolicy();
+	VERIFICATION_STATISTICS getVerificationStatistics();
+	COMMAND_STATISTICS getCommandStatistics(LQT_COMMAND command);
+	PRIORITY_STATISTICS getPriorityStatistics(LQT_PRIORITY priority);
+	void resetCommandStatistics();
+
 public slots:
 	void init();
 	void connect();
@@ -67,21 +193,77 @@ public slots:
 	// control temperature feature
 	void enableTemperatureControl(bool enable);
 
+	// queue reading all settings
+	void pollStatus();
+
 	// force setting the temperature
 	double setTemperatureForce(double temperature);
 	double setMaxTemperatureForce(double temperature);
 
 private:
-	QSerialPort* m_laserPort{ nullptr };
+	std::unique_ptr<SerialTransport> m_laserPort{ nullptr };
+	std::string m_portName{ "COM1" };
+	int m_baudRate{ 19200 };
+	std::string m_traceFile{ "" };		// records the serial traffic to this file if set
+	std::string m_replayFile{ "" };	// replays the serial traffic from this file instead of using the port if set
+	double m_replayTimeScale{ 1.0 };	// time scale of the replay
 	bool m_isConnected{ false };
 	std::string m_terminator{ "\r" };
+	std::string m_receiveBuffer;	// received bytes of the incomplete response
+	std::array<COMMAND_STATISTICS, static_cast<int>(LQT_COMMAND::COUNT)> m_commandStatistics;
+
+	RequestQueue m_queue;							// pending requests, at most one per command
+	std::atomic<bool> m_processScheduled{ false };	// whether processing the queue is already scheduled
+	std::atomic<QAbstractEventDispatcher *> m_dispatcher{ nullptr };	// event dispatcher of the thread of the LQT object
+	std::mutex m_shadowMutex;
+	LQT_SHADOW m_shadow;							// laser state as last acknowledged or reported
+
+	std::mutex m_statisticsMutex;
+	std::array<PRIORITY_STATISTICS, static_cast<int>(LQT_PRIORITY::COUNT)> m_priorityStatistics;
+
+	bool hasPendingRequest(LQT_COMMAND command);
+	bool hasPendingRequest(LQT_PRIORITY above);
+	void enqueue(LQT_COMMAND command, double value, LQT_PRIORITY priority, std::function<void(double)> callback, std::shared_future<double> *future);
+	bool takeRequest(LQT_REQUEST &request, int above = -1);
+	void processQueue();
+	void processScheduledQueue();
+	void yieldTo(LQT_PRIORITY running);
+	void runRequest(LQT_REQUEST &request);
+	double execute(LQT_REQUEST &request);
+
+	QTimer *m_statusTimer{ nullptr };
+	int m_statusPollingInterval{ 10000 };	// [ms]	interval of the status polling, 0 to disable it
+	bool m_pipelining{ true };				//		whether the laser answers queries written back to back
+	size_t m_batchSize{ 3 };				//		maximum number of queries written back to back
+
+	std::mutex m_verificationMutex;
+	VERIFICATION_POLICY m_verificationPolicy;
+	VERIFICATION_STATISTICS m_verificationStatistics;
+	QTimer *m_verificationTimer{ nullptr };
+	double m_unverifiedSetpoint{ NAN };		// [K]	temperature setpoint which has to be verified later
+	LQT_PRIORITY m_unverifiedPriority{ LQT_PRIORITY::USER };
+
+	double writeVerified(double value, double previous, std::function<double(double, int)> set, std::function<bool()> preempted, bool &verified);
+	void verifyDeferred();
+
+	bool extractResponse(std::string &response);
+	bool parseTemperature(const std::string &response, double &temperature);
+
+	template <typename T>
+	void updateShadow(SHADOW_VALUE<T> &field, T value);
+	template <typename T>
+	bool getShadowValue(const SHADOW_VALUE<T> &field, T &value);
+	void recordLatency(LQT_COMMAND command, std::chrono::steady_clock::time_point start, bool answered);
 
 	LQT_SETTINGS m_settings;
-	void readSettings();
+	void readSettings(LQT_PRIORITY priority = LQT_PRIORITY::STATUS, bool force = false);
 
 signals:
 	void connected(bool);
 	void settingsChanged(LQT_SETTINGS);
+	void commandStatisticsChanged(COMMAND_STATISTICS);
+	void priorityStatisticsChanged(PRIORITY_STATISTICS);
+	void verificationStatisticsChanged(VERIFICATION_STATISTICS);
 };
 
 #endif // LQT_H
\ No newline at end of file
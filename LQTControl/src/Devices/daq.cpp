@@ -1,9 +1,5 @@
-#include "daq_PS2000.h"
-#include <QtWidgets>
-#include <QtWidgets/QApplication>
-#include <QtWidgets/QMainWindow>
-
-#include "daq_PS2000.h"
+#include "daq.h"
+#include <algorithm>
 
 /*
  * Public definitions
@@ -57,6 +53,166 @@ void daq::setNumberSamples(int32_t no_of_samples) {
 	setAcquisitionParameters();
 }
 
+// Returns the block which capture was already started with startCollectingBlockData()
+// or captures a new one.
+std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> daq::collectBlockData() {
+	std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> values;
+	collectBlockData(values);
+	return values;
+}
+
+void daq::collectBlockData(std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> &values) {
+	// the device cannot capture a block while it streams
+	if (m_streaming) {
+		for (auto &channel : values) {
+			channel.clear();
+		}
+		return;
+	}
+	startCollectingBlockData();
+	m_blockRunning = false;
+	readBlock(values);
+}
+
+// Starts the capture of the next block without waiting for it,
+// so that it can run while the previous block is processed.
+// The live acquisition pauses until the block is read or discarded.
+void daq::startCollectingBlockData() {
+	if (!m_blockRunning) {
+		m_blockStartTime = Clock::get()->now();
+		runBlock();
+		m_blockRunning = true;
+	}
+}
+
+uint64_t daq::getLatestBlock(std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> &values, uint32_t decimation) {
+	decimation = (decimation < 1) ? 1 : decimation;
+	QMutexLocker locker(&m_latestBlockMutex);
+	for (gsl::index channel{ 0 }; channel < (gsl::index)values.size(); channel++) {
+		const auto &block = m_latestBlock[channel];
+		values[channel].resize((block.size() + decimation - 1) / decimation);
+		for (gsl::index i{ 0 }; i < (gsl::index)values[channel].size(); i++) {
+			values[channel][i] = block[i * decimation];
+		}
+	}
+	return m_latestBlockSequence;
+}
+
+void daq::setLatestBlockRequested(bool requested) {
+	m_latestBlockRequested = requested;
+}
+
+void daq::setSharedRing(SharedRingWriter *ring) {
+	m_sharedRing = ring;
+}
+
+// Writes the block captured from the given time on to the shared memory ring in place, the values beyond the size of a slot are dropped.
+void daq::writeSharedRing(const std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> &values, std::chrono::time_point<std::chrono::system_clock> time, double samplingRate) {
+	uint32_t maxSamples = m_sharedRing->getMaxSamples();
+	uint32_t channels = m_sharedRing->getChannels();
+	channels = (channels < values.size()) ? channels : (uint32_t)values.size();
+	auto record = static_cast<SHARED_LIVE_RECORD *>(m_sharedRing->beginWrite());
+	record->time = std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+	record->samplingRate = samplingRate;
+	record->channels = channels;
+	record->samples = 0;
+	record->enabled = 0;
+	for (uint32_t channel{ 0 }; channel < channels; channel++) {
+		if (values[channel].empty()) {
+			continue;
+		}
+		uint32_t samples = (values[channel].size() < maxSamples) ? (uint32_t)values[channel].size() : maxSamples;
+		std::copy_n(values[channel].begin(), samples, sharedRing::liveValues(record, maxSamples, channel));
+		record->samples = (samples > record->samples) ? samples : record->samples;
+		record->enabled |= 1u << channel;
+	}
+	m_sharedRing->endWrite();
+}
+
+// Makes sure the next call to collectBlockData() does not return an old block.
+void daq::discardBlockData() {
+	m_blockRunning = false;
+}
+
+std::chrono::time_point<std::chrono::system_clock> daq::getBlockStartTime() {
+	return m_blockStartTime;
+}
+
+bool daq::startStreaming() {
+	if (m_streaming) {
+		return true;
+	}
+	discardBlockData();
+	for (auto &channel : m_streamingValues) {
+		channel.clear();
+	}
+	// we try to stream with the currently selected sampling rate, the device tells us what it actually uses
+	m_streamingInterval = (uint32_t)round(1e9 / getCurrentSamplingRate());
+	m_streaming = runStreaming();
+	m_streamingStart = Clock::get()->now();
+	m_streamingCollected = 0;
+	return m_streaming;
+}
+
+void daq::stopStreaming() {
+	if (m_streaming) {
+		haltStreaming();
+		m_streaming = false;
+	}
+}
+
+// Returns exactly nrSamples values per enabled channel, or false if the device has not acquired them yet.
+bool daq::collectStreamingBlock(uint32_t nrSamples, std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> &values) {
+	if (!m_streaming) {
+		return false;
+	}
+	if (getStreamingBacklog() < nrSamples) {
+		pollStreaming();
+		if (getStreamingBacklog() < nrSamples) {
+			return false;
+		}
+	}
+	for (gsl::index ch{ 0 }; ch < DAQ_MAX_CHANNELS; ch++) {
+		auto &streamed = m_streamingValues[ch];
+		if (!m_unitOpened.channelSettings[ch].enabled || streamed.size() < nrSamples) {
+			values[ch].clear();
+			continue;
+		}
+		values[ch].resize(nrSamples);
+		for (gsl::index i{ 0 }; i < (gsl::index)nrSamples; i++) {
+			values[ch][i] = adc_to_mv(streamed[i], m_unitOpened.channelSettings[ch].range);
+		}
+		streamed.erase(streamed.begin(), streamed.begin() + nrSamples);
+	}
+	// the live acquisition pauses while streaming, so the streamed blocks take its place in the ring
+	if (m_sharedRing) {
+		double samplingRate = getStreamingSamplingRate();
+		auto passed = std::chrono::duration<double>(m_streamingCollected / samplingRate);
+		writeSharedRing(values, m_streamingStart + std::chrono::duration_cast<std::chrono::system_clock::duration>(passed), samplingRate);
+	}
+	m_streamingCollected += nrSamples;
+	return true;
+}
+
+// The channels are streamed together, but we only count the ones which are enabled.
+size_t daq::getStreamingBacklog() {
+	bool enabled{ false };
+	size_t backlog{ 0 };
+	for (gsl::index ch{ 0 }; ch < DAQ_MAX_CHANNELS; ch++) {
+		if (!m_unitOpened.channelSettings[ch].enabled) {
+			continue;
+		}
+		auto size = m_streamingValues[ch].size();
+		backlog = (!enabled || size < backlog) ? size : backlog;
+		enabled = true;
+	}
+	return backlog;
+}
+
+double daq::getStreamingSamplingRate() {
+	return (m_streamingInterval > 0) ? 1e9 / m_streamingInterval : getCurrentSamplingRate();
+}
+
 /*
  * Public slots
  */
@@ -65,7 +221,7 @@ void daq::init() {
 	// create timers and connect their signals
 	// after moving daq_PS2000 to another thread
 	timer = new QTimer();
-	QMetaObject::Connection connection = QWidget::connect(
+	QMetaObject::Connection connection = QObject::connect(
 		timer,
 		&QTimer::timeout,
 		this,
@@ -79,7 +235,8 @@ void daq::startStopAcquisition() {
 		m_acquisitionRunning = false;
 	} else {
 		setAcquisitionParameters();
-		timer->start(20);
+		m_timerMonitor.reset();
+		timer->start(m_acquisitionTimeout);
 		m_acquisitionRunning = true;
 	}
 	emit(s_acquisitionRunning(m_acquisitionRunning));
@@ -97,11 +254,24 @@ int16_t daq::mv_to_adc(int16_t mv, int16_t ch) {
 	return ((mv * 32767) / m_input_ranges[ch]);
 }
 
+void daq::appendStreamingValues(gsl::index ch, const int16_t *values, uint32_t nrValues) {
+	m_streamingValues[ch].insert(m_streamingValues[ch].end(), values, values + nrValues);
+}
+
 /*
  * Protected slots
  */
 
 void daq::getBlockData() {
+	// The pipelined lock has started the capture of its next block, which is
+	// only read by its next tick. Reading it here would hand the lock a block
+	// captured at another time, so the live acquisition skips until it is read.
+	// While the lock is paced by the sample clock, the device streams and captures no blocks.
+	if (m_blockRunning || m_streaming) {
+		return;
+	}
+	m_timerMonitor.tickStarted();
+
 	std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> values = collectBlockData();
 
 	//m_liveBuffer->m_freeBuffers->acquire();
@@ -113,5 +283,21 @@ void daq::getBlockData() {
 	}
 	m_liveBuffer->m_usedBuffers->release();
 
+	// the consumers only hold the lock while they copy the block
+	if (m_latestBlockRequested) {
+		QMutexLocker locker(&m_latestBlockMutex);
+		for (gsl::index channel{ 0 }; channel < (gsl::index)values.size(); channel++) {
+			m_latestBlock[channel].assign(values[channel].begin(), values[channel].end());
+		}
+	}
+	++m_latestBlockSequence;
+
+	if (m_sharedRing) {
+		writeSharedRing(values, m_blockStartTime, getCurrentSamplingRate());
+	}
+
 	emit collectedBlockData();
+
+	m_timerMonitor.tickFinished();
+	emit timingStatisticsChanged(m_timerMonitor.getStatistics());
 }
\ No newline at end of file
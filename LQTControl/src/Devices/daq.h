@@ -1,17 +1,19 @@
 #ifndef DAQ_H
 #define DAQ_H
 
-#include <QMainWindow>
-#include <QtCore/QObject>
-#include <QtWidgets>
+#include <QtCore>
 #include <vector>
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <ctime>
 
 #include <gsl/gsl>
-#include "..\circularBuffer.h"
-#include "..\generalmath.h"
+#include "../circularBuffer.h"
+#include "../generalmath.h"
+#include "../timerMonitor.h"
+#include "../clock.h"
+#include "../sharedRingWriter.h"
 
 #define DAQ_BUFFER_SIZE 	8000
 #define SINGLE_CH_SCOPE 1				// Single channel scope
@@ -26,7 +28,8 @@ typedef enum enPSCoupling {
 
 typedef enum class PSTypes {
 	MODEL_PS2000 = 0,
-	MODEL_PS2000A = 1
+	MODEL_PS2000A = 1,
+	MODEL_SYNTHETIC = 2
 } PS_TYPES;
 
 typedef struct CHANNEL_SETTINGS {
@@ -83,7 +86,26 @@ class daq : public QObject {
 		explicit daq(QObject *parent, std::vector<int32_t> ranges, std::vector<int> timebases, double maxSamplingRate);
 
 		virtual void setAcquisitionParameters() = 0;
-		virtual std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> collectBlockData() = 0;
+		std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> collectBlockData();
+		// fills the given vectors, which keep their capacity, so collecting blocks of the same size does not allocate
+		void collectBlockData(std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> &values);
+		void startCollectingBlockData();
+		void discardBlockData();
+		std::chrono::time_point<std::chrono::system_clock> getBlockStartTime();
+		// copies every decimation-th sample of the last block of the live acquisition, returns its sequence number or 0 if there is none
+		uint64_t getLatestBlock(std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> &values, uint32_t decimation = 1);
+		// the last block is only kept while a consumer asked for it, so the live acquisition does not copy every block for nobody
+		void setLatestBlockRequested(bool requested);
+		// the blocks of the live acquisition and the streamed blocks are also written to this ring, has to be set before the DAQ is moved to its thread
+		void setSharedRing(SharedRingWriter *ring);
+
+		// continuous acquisition paced by the sample clock of the device
+		bool startStreaming();
+		void stopStreaming();
+		bool collectStreamingBlock(uint32_t nrSamples, std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> &values);
+		double getStreamingSamplingRate();
+		// number of streamed values per enabled channel which were not collected yet
+		size_t getStreamingBacklog();
 		virtual void setOutputVoltage(double voltage) = 0;
 		virtual double getCurrentSamplingRate() = 0;
 
@@ -100,7 +122,7 @@ class daq : public QObject {
 
 		std::vector<int32_t> m_input_ranges;
 
-		std::vector<std::string> PS_NAMES = { "PS2000", "PS2000A" };
+		std::vector<std::string> PS_NAMES = { "PS2000", "PS2000A", "Synthetic" };
 
 	public slots:
 		virtual void connect() = 0;
@@ -113,6 +135,16 @@ class daq : public QObject {
 		virtual void set_defaults(void) = 0;
 		virtual void get_info(void) = 0;
 
+		// start the capture of a block and read it once it is ready
+		virtual void runBlock() = 0;
+		virtual void readBlock(std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> &values) = 0;
+
+		// start streaming, hand the latest values to appendStreamingValues() and stop streaming
+		virtual bool runStreaming() = 0;
+		virtual void pollStreaming() = 0;
+		virtual void haltStreaming() = 0;
+		void appendStreamingValues(gsl::index ch, const int16_t *values, uint32_t nrValues);
+
 		int32_t adc_to_mv(int32_t raw, int32_t ch);
 		int16_t mv_to_adc(int16_t mv, int16_t ch);
 
@@ -120,9 +152,24 @@ class daq : public QObject {
 		bool m_isConnected{ false };
 		bool m_acquisitionRunning{ false };
 		QTimer* timer{ nullptr };
+		int m_acquisitionTimeout{ 20 };		// [ms]	time until next acquisition run
+		TimerMonitor m_timerMonitor{ TIMERS::ACQUISITIONTIMER, m_acquisitionTimeout };
 		ACQUISITION_PARAMETERS m_acquisitionParameters;
 		int16_t m_overflow{ 0 };
 		bool m_scale_to_mv{ true };
+		bool m_blockRunning{ false };		//		whether the lock started a block capture which it has not read yet
+		std::chrono::time_point<std::chrono::system_clock> m_blockStartTime;	// time the current block capture was started
+		bool m_streaming{ false };
+		uint32_t m_streamingInterval{ 0 };	// [ns]	actual sample interval while streaming
+		std::array<std::vector<int16_t>, DAQ_MAX_CHANNELS> m_streamingValues;	// streamed values not yet collected, a vector keeps its capacity
+		std::chrono::time_point<std::chrono::system_clock> m_streamingStart;	// time the streaming was started
+		uint64_t m_streamingCollected{ 0 };	//		number of values per channel collected since the streaming was started
+		QMutex m_latestBlockMutex;
+		std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> m_latestBlock;	// [mV]	last block of the live acquisition for other consumers than the live view
+		std::atomic<uint64_t> m_latestBlockSequence{ 0 };	//	number of blocks acquired by the live acquisition
+		std::atomic<bool> m_latestBlockRequested{ false };	//	whether a consumer reads the last block
+		SharedRingWriter *m_sharedRing{ nullptr };
+		void writeSharedRing(const std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> &values, std::chrono::time_point<std::chrono::system_clock> time, double samplingRate);
 
 		double m_maxSamplingRate{ 0 };
 		std::vector<int> m_availableTimebases;
@@ -136,6 +183,7 @@ class daq : public QObject {
 		void connected(bool);
 		void acquisitionParametersChanged(ACQUISITION_PARAMETERS);
 		void collectedBlockData();
+		void timingStatisticsChanged(TIMER_STATISTICS);
 };
 
 #endif // DAQ_H
\ No newline at end of file
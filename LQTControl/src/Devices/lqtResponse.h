@@ -0,0 +1,69 @@
+#ifndef LQTRESPONSE_H
+#define LQTRESPONSE_H
+
+#include <string>
+#include <cstdlib>
+#include <cmath>
+#include "requestQueue.h"
+
+/*
+ * Framing and parsing of the responses of the laser, independent of the transport.
+ */
+class lqtResponse {
+public:
+	// Extracts the first terminated line from the received bytes, empty lines are skipped.
+	// Returns false and keeps the incomplete line in the buffer if there is none.
+	static bool extract(std::string &buffer, std::string &response) {
+		while (buffer.size() > 0) {
+			auto end = buffer.find_first_of("\r\n");
+			if (end == std::string::npos) {
+				return false;
+			}
+			bool empty = (end == 0);
+			if (!empty) {
+				response.assign(buffer, 0, end);
+			}
+			buffer.erase(0, end + 1);
+			if (!empty) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Returns false if the response is not exactly one finite number.
+	static bool parseTemperature(const std::string &response, double &temperature) {
+		if (response.size() == 0) {
+			return false;
+		}
+		char *end{ nullptr };
+		double value = strtod(response.c_str(), &end);
+		if (*end != '\0' || !std::isfinite(value)) {
+			return false;
+		}
+		temperature = value;
+		return true;
+	}
+
+	// Checks the format of a response, so a dropped query cannot shift the responses of a batch.
+	static bool isValid(LQT_COMMAND command, const std::string &response) {
+		double temperature;
+		switch (command) {
+			case LQT_COMMAND::SETTEMPERATURE:
+			case LQT_COMMAND::GETTEMPERATURE:
+			case LQT_COMMAND::SETMAXTEMPERATURE:
+			case LQT_COMMAND::GETMAXTEMPERATURE:
+				return parseTemperature(response, temperature);
+			case LQT_COMMAND::GETMOD:
+				return response.rfind("Laser Modulation", 0) == 0;
+			case LQT_COMMAND::GETLE:
+				return response.rfind("LOCK ENABLE=", 0) == 0;
+			case LQT_COMMAND::GETLOCK:
+				return response.rfind("LOCK=", 0) == 0;
+			default:
+				return response.size() > 0;
+		}
+	}
+};
+
+#endif // LQTRESPONSE_H
\ No newline at end of file
@@ -0,0 +1,151 @@
+#ifndef REQUESTQUEUE_H
+#define REQUESTQUEUE_H
+
+#include <vector>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <functional>
+#include <memory>
+#include <algorithm>
+
+enum class LQT_COMMAND {
+	SETTEMPERATURE,
+	GETTEMPERATURE,
+	SETMAXTEMPERATURE,
+	GETMAXTEMPERATURE,
+	SETMOD,
+	GETMOD,
+	SETLOCK,
+	GETLOCK,
+	SETLE,
+	GETLE,
+	TEMPERATURECONTROL,	// sets mod, lock and lock enable at once
+	READSETTINGS,		// reads all settings
+	OTHER,
+	COUNT
+};
+
+// Priority classes of the requests, a higher class is always served first
+enum class LQT_PRIORITY {
+	STATUS,		// status polls and settings readback
+	USER,		// commands from the user interface
+	SCAN,		// scan steps
+	CONTROL,	// writes of the lock loop
+	COUNT
+};
+
+typedef struct LQT_REQUEST {
+	LQT_COMMAND command{ LQT_COMMAND::OTHER };		//		command to execute
+	double value{ 0 };								//		value to set
+	LQT_PRIORITY priority{ LQT_PRIORITY::USER };	//		priority class of the request
+	std::chrono::steady_clock::time_point queued;	//		time the request was queued
+	std::shared_ptr<std::promise<double>> promise;	//		fulfilled with the result once the command was executed
+	std::shared_future<double> future;				//		future handed out to the callers of a coalesced request
+	std::vector<std::function<void(double)>> callbacks;	//	invoked on the serial thread with the result
+} LQT_REQUEST;
+
+/*
+ * The pending requests of the laser, which can be queued from any thread.
+ * There is at most one pending request per command, a newer request of the same command
+ * is coalesced with it: the pending request takes the newest value and the higher priority
+ * of both and keeps the time it was queued first. So a setpoint of the lock loop never
+ * loses its priority to a less important request of the same command queued after it,
+ * and a stale value is never written after a newer one.
+ */
+class RequestQueue {
+
+public:
+	RequestQueue();
+
+	// the promise is only created if a future is requested, so queueing without one does not allocate
+	void enqueue(LQT_COMMAND command, double value, LQT_PRIORITY priority, std::function<void(double)> callback, std::shared_future<double> *future);
+	// takes the oldest request of the highest priority class above the given one
+	bool take(LQT_REQUEST &request, int above = -1);
+	bool hasPending(LQT_COMMAND command);
+	bool hasPending(LQT_PRIORITY above);
+	// number of queued requests and of the callbacks waiting for them
+	size_t size();
+	size_t pendingCallbacks();
+
+private:
+	std::mutex m_mutex;
+	std::vector<LQT_REQUEST> m_queue;	// pending requests, in order of queueing, at most one per command
+};
+
+// the requests are coalesced per command, so the queue never has to grow
+inline RequestQueue::RequestQueue() {
+	m_queue.reserve(static_cast<int>(LQT_COMMAND::COUNT));
+}
+
+inline void RequestQueue::enqueue(LQT_COMMAND command, double value, LQT_PRIORITY priority, std::function<void(double)> callback, std::shared_future<double> *future) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto pending = std::find_if(m_queue.begin(), m_queue.end(), [command](const LQT_REQUEST &request) {
+		return request.command == command;
+	});
+	if (pending == m_queue.end()) {
+		m_queue.emplace_back();
+		pending = m_queue.end() - 1;
+		pending->command = command;
+		pending->queued = std::chrono::steady_clock::now();
+		pending->priority = priority;
+	}
+	pending->value = value;
+	pending->priority = (priority > pending->priority) ? priority : pending->priority;
+	if (callback) {
+		pending->callbacks.push_back(callback);
+	}
+	if (future) {
+		if (!pending->promise) {
+			pending->promise = std::make_shared<std::promise<double>>();
+			pending->future = pending->promise->get_future().share();
+		}
+		*future = pending->future;
+	}
+}
+
+inline bool RequestQueue::take(LQT_REQUEST &request, int above) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto next = m_queue.end();
+	for (auto it = m_queue.begin(); it != m_queue.end(); it++) {
+		if ((int)it->priority > above && (next == m_queue.end() || it->priority > next->priority)) {
+			next = it;
+		}
+	}
+	if (next == m_queue.end()) {
+		return false;
+	}
+	request = std::move(*next);
+	m_queue.erase(next);
+	return true;
+}
+
+inline bool RequestQueue::hasPending(LQT_COMMAND command) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return std::any_of(m_queue.begin(), m_queue.end(), [command](const LQT_REQUEST &request) {
+		return request.command == command;
+	});
+}
+
+inline bool RequestQueue::hasPending(LQT_PRIORITY above) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return std::any_of(m_queue.begin(), m_queue.end(), [above](const LQT_REQUEST &request) {
+		return request.priority > above;
+	});
+}
+
+inline size_t RequestQueue::size() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_queue.size();
+}
+
+inline size_t RequestQueue::pendingCallbacks() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	size_t callbacks{ 0 };
+	for (const auto &request : m_queue) {
+		callbacks += request.callbacks.size();
+	}
+	return callbacks;
+}
+
+#endif // REQUESTQUEUE_H
\ No newline at end of file
@@ -0,0 +1,33 @@
+#include "serialTransport.h"
+
+bool QSerialPortTransport::open(const std::string &port, int baudRate) {
+	m_port.setPortName(QString::fromStdString(port));
+	m_port.setBaudRate(baudRate);
+	m_port.setStopBits(QSerialPort::OneStop);
+	m_port.setParity(QSerialPort::NoParity);
+	return m_port.open(QIODevice::ReadWrite);
+}
+
+void QSerialPortTransport::close() {
+	m_port.close();
+}
+
+void QSerialPortTransport::clear() {
+	m_port.clear();
+}
+
+qint64 QSerialPortTransport::write(const char *data) {
+	return m_port.write(data);
+}
+
+bool QSerialPortTransport::waitForBytesWritten(int timeout) {
+	return m_port.waitForBytesWritten(timeout);
+}
+
+bool QSerialPortTransport::waitForReadyRead(int timeout) {
+	return m_port.waitForReadyRead(timeout);
+}
+
+QByteArray QSerialPortTransport::readAll() {
+	return m_port.readAll();
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#ifndef SERIALTRANSPORT_H
+#define SERIALTRANSPORT_H
+
+#include <QSerialPort>
+#include <QByteArray>
+#include <string>
+
+/*
+ * Byte stream to the laser. All functions are called from the thread of the LQT object.
+ */
+class SerialTransport {
+
+public:
+	virtual ~SerialTransport() {};
+
+	virtual bool open(const std::string &port, int baudRate) = 0;
+	virtual void close() = 0;
+
+	// discards all buffered input and output
+	virtual void clear() = 0;
+	virtual qint64 write(const char *data) = 0;
+	virtual bool waitForBytesWritten(int timeout) = 0;
+	virtual bool waitForReadyRead(int timeout) = 0;
+	virtual QByteArray readAll() = 0;
+};
+
+class QSerialPortTransport : public SerialTransport {
+
+public:
+	bool open(const std::string &port, int baudRate) override;
+	void close() override;
+
+	void clear() override;
+	qint64 write(const char *data) override;
+	bool waitForBytesWritten(int timeout) override;
+	bool waitForReadyRead(int timeout) override;
+	QByteArray readAll() override;
+
+private:
+	QSerialPort m_port;
+};
+
+#endif // SERIALTRANSPORT_H
\ No newline at end of file
@@ -0,0 +1,228 @@
+#include "traceTransport.h"
+#include <algorithm>
+#include <thread>
+
+namespace {
+	const char traceMagic[8]{ 'L', 'Q', 'T', 'T', 'R', 'A', 'C', 'E' };
+	const uint32_t traceVersion{ 1 };
+
+	template <typename T>
+	void writeValue(std::ofstream &stream, T value) {
+		unsigned char bytes[sizeof(T)];
+		for (size_t i{ 0 }; i < sizeof(T); i++) {
+			bytes[i] = (unsigned char)((uint64_t)value >> (8 * i));
+		}
+		stream.write((const char *)bytes, sizeof(T));
+	}
+
+	template <typename T>
+	bool readValue(std::ifstream &stream, T &value) {
+		unsigned char bytes[sizeof(T)];
+		if (!stream.read((char *)bytes, sizeof(T))) {
+			return false;
+		}
+		uint64_t result{ 0 };
+		for (size_t i{ 0 }; i < sizeof(T); i++) {
+			result |= (uint64_t)bytes[i] << (8 * i);
+		}
+		value = (T)result;
+		return true;
+	}
+}
+
+/*
+ * Recording
+ */
+
+RecordingTransport::RecordingTransport(SerialTransport *transport, std::string traceFile) noexcept :
+	m_transport(transport), m_traceFile(traceFile) {}
+
+// The trace is appended to, so a reconnect does not lose the traffic recorded before. A file
+// which is no trace is left alone and nothing is recorded.
+bool RecordingTransport::open(const std::string &port, int baudRate) {
+	bool exists{ false };
+	{
+		std::ifstream trace(m_traceFile, std::ios::binary);
+		char magic[sizeof(traceMagic)];
+		uint32_t version{ 0 };
+		if (trace.read(magic, sizeof(magic))) {
+			exists = true;
+			if (!std::equal(magic, magic + sizeof(magic), traceMagic) || !readValue(trace, version) || version != traceVersion) {
+				qWarning("The file %s is no trace of this version, the traffic is not recorded.", m_traceFile.c_str());
+				return m_transport->open(port, baudRate);
+			}
+		}
+	}
+	m_trace.open(m_traceFile, std::ios::binary | std::ios::app);
+	if (m_trace.is_open()) {
+		if (!exists) {
+			m_trace.write(traceMagic, sizeof(traceMagic));
+			writeValue(m_trace, traceVersion);
+		}
+	} else {
+		qWarning("Could not open the trace file %s.", m_traceFile.c_str());
+	}
+	if (!m_started) {
+		m_start = std::chrono::steady_clock::now();
+		m_started = true;
+	}
+	return m_transport->open(port, baudRate);
+}
+
+void RecordingTransport::close() {
+	m_transport->close();
+	if (m_trace.is_open()) {
+		m_trace.close();
+	}
+}
+
+void RecordingTransport::clear() {
+	m_transport->clear();
+}
+
+qint64 RecordingTransport::write(const char *data) {
+	record(TRACE_DIRECTION::TRACEWRITE, QByteArray(data));
+	return m_transport->write(data);
+}
+
+bool RecordingTransport::waitForBytesWritten(int timeout) {
+	return m_transport->waitForBytesWritten(timeout);
+}
+
+bool RecordingTransport::waitForReadyRead(int timeout) {
+	return m_transport->waitForReadyRead(timeout);
+}
+
+QByteArray RecordingTransport::readAll() {
+	QByteArray data = m_transport->readAll();
+	if (data.size() > 0) {
+		record(TRACE_DIRECTION::TRACEREAD, data);
+	}
+	return data;
+}
+
+void RecordingTransport::record(TRACE_DIRECTION direction, const QByteArray &data) {
+	if (!m_trace.is_open()) {
+		return;
+	}
+	auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count();
+	writeValue(m_trace, (uint8_t)direction);
+	writeValue(m_trace, (uint64_t)time);
+	writeValue(m_trace, (uint32_t)data.size());
+	m_trace.write(data.constData(), data.size());
+}
+
+/*
+ * Replay
+ */
+
+ReplayTransport::ReplayTransport(double timeScale) noexcept : m_timeScale(timeScale) {}
+
+bool ReplayTransport::readTrace(const std::string &traceFile, std::vector<TRACE_RECORD> &records) {
+	records.clear();
+	std::ifstream trace(traceFile, std::ios::binary);
+	char magic[sizeof(traceMagic)];
+	uint32_t version{ 0 };
+	if (!trace.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), traceMagic)
+		|| !readValue(trace, version) || version != traceVersion) {
+		return false;
+	}
+	while (true) {
+		uint8_t direction;
+		TRACE_RECORD record;
+		uint32_t length;
+		if (!readValue(trace, direction) || !readValue(trace, record.time) || !readValue(trace, length)) {
+			break;
+		}
+		record.direction = (TRACE_DIRECTION)direction;
+		record.data.resize((int)length);
+		if (!trace.read(record.data.data(), length)) {
+			break;
+		}
+		records.push_back(record);
+	}
+	return true;
+}
+
+bool ReplayTransport::open(const std::string &port, int /*baudRate*/) {
+	m_nextRecord = 0;
+	m_received.clear();
+	m_mismatches = 0;
+	if (!readTrace(port, m_records)) {
+		qWarning("Could not read the trace file %s.", port.c_str());
+		return false;
+	}
+	return true;
+}
+
+void ReplayTransport::close() {
+	m_records.clear();
+	m_received.clear();
+}
+
+void ReplayTransport::clear() {
+	deliverDue();
+	m_received.clear();
+}
+
+// Responses of the previous request which were never read are dropped, like on a real port.
+qint64 ReplayTransport::write(const char *data) {
+	QByteArray request(data);
+	while (m_nextRecord < m_records.size() && m_records[m_nextRecord].direction != TRACE_DIRECTION::TRACEWRITE) {
+		m_nextRecord++;
+	}
+	if (m_nextRecord < m_records.size()) {
+		if (m_records[m_nextRecord].data != request) {
+			m_mismatches++;
+		}
+		m_writeRecordTime = m_records[m_nextRecord].time;
+		m_nextRecord++;
+	}
+	m_writeTime = clock::now();
+	return request.size();
+}
+
+bool ReplayTransport::waitForBytesWritten(int /*timeout*/) {
+	return true;
+}
+
+bool ReplayTransport::waitForReadyRead(int timeout) {
+	deliverDue();
+	if (m_received.size() > 0) {
+		return true;
+	}
+	auto deadline = clock::now() + std::chrono::milliseconds(timeout);
+	bool pending = (m_nextRecord < m_records.size() && m_records[m_nextRecord].direction == TRACE_DIRECTION::TRACEREAD);
+	if (pending && dueTime(m_records[m_nextRecord]) <= deadline) {
+		std::this_thread::sleep_until(dueTime(m_records[m_nextRecord]));
+		deliverDue();
+		return true;
+	}
+	std::this_thread::sleep_until(deadline);
+	return false;
+}
+
+QByteArray ReplayTransport::readAll() {
+	deliverDue();
+	QByteArray data = m_received;
+	m_received.clear();
+	return data;
+}
+
+uint64_t ReplayTransport::getMismatches() {
+	return m_mismatches;
+}
+
+ReplayTransport::clock::time_point ReplayTransport::dueTime(const TRACE_RECORD &record) {
+	auto delay = (record.time > m_writeRecordTime) ? record.time - m_writeRecordTime : 0;
+	return m_writeTime + std::chrono::nanoseconds((long long)(m_timeScale * delay));
+}
+
+void ReplayTransport::deliverDue() {
+	auto now = clock::now();
+	while (m_nextRecord < m_records.size() && m_records[m_nextRecord].direction == TRACE_DIRECTION::TRACEREAD
+		&& dueTime(m_records[m_nextRecord]) <= now) {
+		m_received += m_records[m_nextRecord].data;
+		m_nextRecord++;
+	}
+}
\ No newline at end of file
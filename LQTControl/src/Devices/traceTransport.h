@@ -0,0 +1,92 @@
+#ifndef TRACETRANSPORT_H
+#define TRACETRANSPORT_H
+
+#include "serialTransport.h"
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+/*
+ * Binary trace of the serial traffic:
+ *   header:  "LQTTRACE" (8 bytes), version (uint32)
+ *   records: direction (uint8), time since the start [ns] (uint64), length (uint32), data
+ * All numbers are little endian. A recording is appended to an existing trace, the times of the
+ * records appended by another run of the program start at zero again.
+ */
+typedef enum enTraceDirection {
+	TRACEWRITE,		// request sent to the laser
+	TRACEREAD		// response received from the laser
+} TRACE_DIRECTION;
+
+typedef struct TRACE_RECORD {
+	TRACE_DIRECTION direction{ TRACE_DIRECTION::TRACEWRITE };
+	uint64_t time{ 0 };		// [ns]	time since the start of the recording
+	QByteArray data;
+} TRACE_RECORD;
+
+/*
+ * Passes everything to another transport and records the traffic with monotonic timestamps.
+ */
+class RecordingTransport : public SerialTransport {
+
+public:
+	RecordingTransport(SerialTransport *transport, std::string traceFile) noexcept;
+
+	bool open(const std::string &port, int baudRate) override;
+	void close() override;
+
+	void clear() override;
+	qint64 write(const char *data) override;
+	bool waitForBytesWritten(int timeout) override;
+	bool waitForReadyRead(int timeout) override;
+	QByteArray readAll() override;
+
+private:
+	std::unique_ptr<SerialTransport> m_transport;
+	std::string m_traceFile;
+	std::ofstream m_trace;
+	std::chrono::steady_clock::time_point m_start;
+	bool m_started{ false };		//		whether the start time of the recording is set
+
+	void record(TRACE_DIRECTION direction, const QByteArray &data);
+};
+
+/*
+ * Plays a recorded trace back. The port is the path of the trace file. Every response is
+ * delivered with its original delay after the preceding request, multiplied by the time scale.
+ */
+class ReplayTransport : public SerialTransport {
+
+public:
+	explicit ReplayTransport(double timeScale = 1.0) noexcept;
+
+	bool open(const std::string &port, int baudRate) override;
+	void close() override;
+
+	void clear() override;
+	qint64 write(const char *data) override;
+	bool waitForBytesWritten(int timeout) override;
+	bool waitForReadyRead(int timeout) override;
+	QByteArray readAll() override;
+
+	static bool readTrace(const std::string &traceFile, std::vector<TRACE_RECORD> &records);
+
+	uint64_t getMismatches();
+
+private:
+	typedef std::chrono::steady_clock clock;
+
+	double m_timeScale{ 1.0 };
+	std::vector<TRACE_RECORD> m_records;
+	size_t m_nextRecord{ 0 };			//		index of the next record to replay
+	clock::time_point m_writeTime;		//		time of the last request during replay
+	uint64_t m_writeRecordTime{ 0 };	// [ns]	time of the last request in the trace
+	QByteArray m_received;				//		responses which are due, but not read yet
+	uint64_t m_mismatches{ 0 };			//		number of requests which differ from the trace
+
+	clock::time_point dueTime(const TRACE_RECORD &record);
+	void deliverDue();
+};
+
+#endif // TRACETRANSPORT_H
\ No newline at end of file
@@ -0,0 +1,95 @@
+#include "allocationCounter.h"
+
+#if defined(LQTCONTROL_COUNT_ALLOCATIONS)
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+	std::atomic<int64_t> liveAllocations{ 0 };
+	std::atomic<uint64_t> totalAllocations{ 0 };
+	// constant initialized, so it can be used before the thread runs any constructor
+	thread_local uint64_t threadAllocations{ 0 };
+
+	void *allocate(std::size_t size) noexcept {
+		void *pointer = std::malloc(size ? size : 1);
+		if (pointer) {
+			liveAllocations.fetch_add(1, std::memory_order_relaxed);
+			totalAllocations.fetch_add(1, std::memory_order_relaxed);
+			threadAllocations++;
+		}
+		return pointer;
+	}
+
+	void deallocate(void *pointer) noexcept {
+		if (pointer) {
+			liveAllocations.fetch_sub(1, std::memory_order_relaxed);
+			std::free(pointer);
+		}
+	}
+}
+
+bool allocationCounter::enabled() {
+	return true;
+}
+
+int64_t allocationCounter::live() {
+	return liveAllocations.load(std::memory_order_relaxed);
+}
+
+uint64_t allocationCounter::total() {
+	return totalAllocations.load(std::memory_order_relaxed);
+}
+
+uint64_t allocationCounter::thread() {
+	return threadAllocations;
+}
+
+void *operator new(std::size_t size) {
+	void *pointer = allocate(size);
+	if (!pointer) {
+		throw std::bad_alloc();
+	}
+	return pointer;
+}
+
+void *operator new[](std::size_t size) {
+	void *pointer = allocate(size);
+	if (!pointer) {
+		throw std::bad_alloc();
+	}
+	return pointer;
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+	return allocate(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+	return allocate(size);
+}
+
+void operator delete(void *pointer) noexcept {
+	deallocate(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+	deallocate(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+	deallocate(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept {
+	deallocate(pointer);
+}
+
+void operator delete(void *pointer, const std::nothrow_t &) noexcept {
+	deallocate(pointer);
+}
+
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept {
+	deallocate(pointer);
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,41 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <cstdint>
+
+/*
+ * Counts the heap allocations by replacing the global operator new and delete.
+ * The counting is compiled in with LQTCONTROL_COUNT_ALLOCATIONS, which the debug builds,
+ * the simulation and the benchmarks define. Otherwise all counts stay zero.
+ */
+class allocationCounter {
+public:
+	// whether the allocations are counted at all
+	static bool enabled();
+	// number of allocations which were not freed yet
+	static int64_t live();
+	// number of allocations since the program started
+	static uint64_t total();
+	// number of allocations the calling thread made since it started
+	static uint64_t thread();
+};
+
+#if !defined(LQTCONTROL_COUNT_ALLOCATIONS)
+inline bool allocationCounter::enabled() {
+	return false;
+}
+
+inline int64_t allocationCounter::live() {
+	return 0;
+}
+
+inline uint64_t allocationCounter::total() {
+	return 0;
+}
+
+inline uint64_t allocationCounter::thread() {
+	return 0;
+}
+#endif
+
+#endif // ALLOCATIONCOUNTER_H
\ No newline at end of file
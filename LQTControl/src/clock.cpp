@@ -0,0 +1,42 @@
+#include "clock.h"
+#include <atomic>
+#include <thread>
+
+namespace {
+	Clock systemClock;
+	std::atomic<Clock *> currentClock{ &systemClock };
+}
+
+Clock::time_point Clock::now() {
+	return std::chrono::system_clock::now();
+}
+
+void Clock::sleepUntil(time_point time) {
+	std::this_thread::sleep_until(time);
+}
+
+Clock *Clock::get() {
+	return currentClock;
+}
+
+void Clock::set(Clock *clock) {
+	currentClock = clock ? clock : &systemClock;
+}
+
+VirtualClock::VirtualClock(time_point start) noexcept : m_now(start) {}
+
+Clock::time_point VirtualClock::now() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_now;
+}
+
+// Sleeping returns immediately, the time jumps to the end of the sleep.
+void VirtualClock::sleepUntil(time_point time) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_now = (time > m_now) ? time : m_now;
+}
+
+void VirtualClock::advance(std::chrono::microseconds duration) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_now += std::chrono::duration_cast<time_point::duration>(duration);
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <chrono>
+#include <mutex>
+
+/*
+ * Source of the time used by the lock loop and the data acquisition.
+ * This is the system clock, unless a simulation replaces it by a virtual clock,
+ * where waiting for a capture advances the time instead of blocking.
+ */
+class Clock {
+
+public:
+	typedef std::chrono::system_clock::time_point time_point;
+
+	virtual ~Clock() {};
+
+	virtual time_point now();
+	virtual void sleepUntil(time_point time);
+
+	// the clock used by all objects, the caller keeps its ownership, nullptr restores the system clock
+	static Clock *get();
+	static void set(Clock *clock);
+};
+
+/*
+ * Time which only passes when it is advanced or when somebody sleeps.
+ */
+class VirtualClock : public Clock {
+
+public:
+	explicit VirtualClock(time_point start = std::chrono::system_clock::now()) noexcept;
+
+	time_point now() override;
+	void sleepUntil(time_point time) override;
+	void advance(std::chrono::microseconds duration);
+
+private:
+	std::mutex m_mutex;
+	time_point m_now;
+};
+
+#endif // CLOCK_H
\ No newline at end of file
@@ -12,32 +12,32 @@
 
 class generalmath {
 public:
-	static double mean(std::vector<int> vector) {
+	static double mean(const std::vector<int> &vector) {
 		return std::accumulate(std::begin(vector), std::end(vector), 0.0) / vector.size();
 	}
 
-	static double mean(std::vector<double> vector) {
+	static double mean(const std::vector<double> &vector) {
 		return std::accumulate(std::begin(vector), std::end(vector), 0.0) / vector.size();
 	}
 
-	static std::complex<double> mean(std::vector<std::complex<double>> vector) {
+	static std::complex<double> mean(const std::vector<std::complex<double>> &vector) {
 		return std::accumulate(std::begin(vector), std::end(vector), std::complex<double>(0.0, 0.0)) / std::complex<double>(vector.size(), 0);
 	}
 
 	template <typename T = double>
-	static T max(std::vector<T> vector) {
-		std::vector<T>::iterator result = std::max_element(std::begin(vector), std::end(vector));
+	static T max(const std::vector<T> &vector) {
+		typename std::vector<T>::const_iterator result = std::max_element(std::begin(vector), std::end(vector));
 		return *result;
 	}
 
 	template <typename T = double>
-	static T min(std::vector<T> vector) {
-		std::vector<T>::iterator result = std::min_element(std::begin(vector), std::end(vector));
+	static T min(const std::vector<T> &vector) {
+		typename std::vector<T>::const_iterator result = std::min_element(std::begin(vector), std::end(vector));
 		return *result;
 	}
 
 	template <typename T = double>
-	static T absSum(std::vector<T> vector) {
+	static T absSum(const std::vector<T> &vector) {
 		T sum{ 0 };
 		for (int jj{ 0 }; jj < vector.size(); jj++) {
 			sum += abs(vector[jj]);
@@ -45,7 +45,7 @@ public:
 		return sum;
 	}
 
-	static double floatingMean(std::vector<double> vector, size_t nrValues, size_t offset = 0) {
+	static double floatingMean(const std::vector<double> &vector, size_t nrValues, size_t offset = 0) {
 		// If we request a floating mean over all or more elements, just return the global mean.
 		if (nrValues >= vector.size()) {
 			return mean(vector);
@@ -67,7 +67,7 @@ public:
 		}
 	}
 
-	static double standardDeviation(std::vector<double> vector) {
+	static double standardDeviation(const std::vector<double> &vector) {
 		if (vector.size() == 0) {
 			return nan("1");
 		}
@@ -80,7 +80,7 @@ public:
 		return sqrt(accum / (vector.size() - 1));
 	}
 
-	static double floatingStandardDeviation(std::vector<double> vector, size_t nrValues, size_t offset = 0) {
+	static double floatingStandardDeviation(const std::vector<double> &vector, size_t nrValues, size_t offset = 0) {
 		// If we request a floating standard deviation over all or more elements, just return the global standard deviation.
 		if (nrValues >= vector.size()) {
 			return standardDeviation(vector);
@@ -105,7 +105,7 @@ public:
 		return sqrt(accum / (nrValues - 1));
 	}
 
-	static double floatingMax(std::vector<double> vector, size_t nrValues) {
+	static double floatingMax(const std::vector<double> &vector, size_t nrValues) {
 		if (vector.size() == 0) {
 			return nan("1");
 		}
@@ -119,7 +119,7 @@ public:
 		return max;
 	}
 
-	static int32_t floatingMax(std::vector<int32_t> vector, size_t nrValues) {
+	static int32_t floatingMax(const std::vector<int32_t> &vector, size_t nrValues) {
 		if (vector.size() == 0) {
 			// should return NaN, but there is no NaN implementation for int/int32_t
 			return 0;
@@ -147,6 +147,21 @@ public:
 		return xs;
 	}
 
+	// fills the vector in place with equally spaced values from min to max, so it keeps its buffer
+	template <typename T>
+	static void linspace(T min, T max, std::vector<T> &xs) {
+		T spacing = (xs.size() > 1) ? (max - min) / static_cast<T>(xs.size() - 1) : 0;
+		for (gsl::index i{ 0 }; i < (gsl::index)xs.size(); i++) {
+			xs[i] = min + i * spacing;
+		}
+	}
+
+	// one step of a first order low-pass filter with the corner frequency [Hz] over the time step dt [s]
+	static double lowpass(double filtered, double value, double frequency, double dt) {
+		double alpha = 1 - exp(-2 * 3.14159265358979323846 * frequency * dt);
+		return filtered + alpha * (value - filtered);
+	}
+
 	static gsl::index indexWrapped(int index, int size) {
 		return (index % size + size) % size;
 	}
@@ -0,0 +1,88 @@
+#ifndef IPCFRAME_H
+#define IPCFRAME_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Frames of the local control and data API of LQTControl, see ipcProtocol.h for the messages.
+ * It only depends on the standard library, so clients can include it without Qt.
+ *
+ * Every message is a frame of a 12 byte header and a payload, all values are little-endian:
+ *
+ *   uint32	magic	IPC_MAGIC, a stream which lost its framing is closed instead of being misread
+ *   uint32	size	number of payload bytes following the header, at most IPC_MAX_PAYLOAD
+ *   uint16	type	IPC_MESSAGE
+ *   uint16	tag		chosen by the client for a request and echoed in its REPLY, 0 for notifications
+ */
+
+#define IPC_MAGIC 0x4354514C	// "LQTC"
+#define IPC_HEADER_SIZE 12
+#define IPC_MAX_PAYLOAD (16 * 1024 * 1024)
+
+typedef enum enIpcFrameStatus {
+	IPC_FRAME_COMPLETE,			// the header and the whole payload were received
+	IPC_FRAME_INCOMPLETE,		// the frame needs more bytes
+	IPC_FRAME_BAD_MAGIC,		// the bytes do not start with IPC_MAGIC
+	IPC_FRAME_OVERSIZED			// the payload is larger than IPC_MAX_PAYLOAD
+} IPC_FRAME_STATUS;
+
+typedef struct IPC_HEADER {
+	uint32_t size{ 0 };			//		number of payload bytes
+	uint16_t type{ 0 };			//		IPC_MESSAGE
+	uint16_t tag{ 0 };			//		tag of the request
+} IPC_HEADER;
+
+namespace ipc {
+	inline uint32_t readUint32(const char *data) {
+		auto bytes = reinterpret_cast<const uint8_t *>(data);
+		return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+	}
+
+	inline uint16_t readUint16(const char *data) {
+		auto bytes = reinterpret_cast<const uint8_t *>(data);
+		return (uint16_t)(bytes[0] | (bytes[1] << 8));
+	}
+
+	inline void writeUint32(char *data, uint32_t value) {
+		for (int i{ 0 }; i < 4; i++) {
+			data[i] = (char)((value >> (8 * i)) & 0xFF);
+		}
+	}
+
+	inline void writeUint16(char *data, uint16_t value) {
+		data[0] = (char)(value & 0xFF);
+		data[1] = (char)(value >> 8);
+	}
+
+	// writes the header to the first IPC_HEADER_SIZE bytes
+	inline void writeHeader(char *data, const IPC_HEADER &header) {
+		writeUint32(data, IPC_MAGIC);
+		writeUint32(data + 4, header.size);
+		writeUint16(data + 8, header.type);
+		writeUint16(data + 10, header.tag);
+	}
+
+	// Checks the frame at the start of the received bytes and reads its header. The magic and the size
+	// are checked as soon as their bytes arrived, so a broken stream is detected before its payload.
+	inline IPC_FRAME_STATUS parseFrame(const char *data, size_t size, IPC_HEADER &header) {
+		if (size >= 4 && readUint32(data) != IPC_MAGIC) {
+			return IPC_FRAME_BAD_MAGIC;
+		}
+		if (size >= 8 && readUint32(data + 4) > IPC_MAX_PAYLOAD) {
+			return IPC_FRAME_OVERSIZED;
+		}
+		if (size < IPC_HEADER_SIZE) {
+			return IPC_FRAME_INCOMPLETE;
+		}
+		header.size = readUint32(data + 4);
+		header.type = readUint16(data + 8);
+		header.tag = readUint16(data + 10);
+		if (size < IPC_HEADER_SIZE + (size_t)header.size) {
+			return IPC_FRAME_INCOMPLETE;
+		}
+		return IPC_FRAME_COMPLETE;
+	}
+}
+
+#endif // IPCFRAME_H
\ No newline at end of file
@@ -0,0 +1,77 @@
+#ifndef IPCPROTOCOL_H
+#define IPCPROTOCOL_H
+
+#include <QtCore>
+
+#include "ipcFrame.h"
+
+/*
+ * Messages of the local control and data API of LQTControl, ipcFrame.h describes their frames.
+ *
+ * The payloads are listed at IPC_MESSAGE. Numbers are written like QDataStream does it with
+ * little-endian byte order and double precision, uint8 is used for booleans.
+ */
+
+#define IPC_PROTOCOL_VERSION 2
+
+typedef enum class enIpcMessage : uint16_t {
+	// requests of the client, answered by a REPLY with the tag of the request
+	HELLO = 0x01,				//		-> REPLY, then STATE
+	CONNECT = 0x02,				//		connects the laser and the DAQ
+	DISCONNECT = 0x03,			//		disconnects the laser and the DAQ
+	SCAN = 0x04,				// uint8 run	starts or stops the scan
+	ACQUIRE = 0x05,				// uint8 run	starts or stops the acquisition for the lock
+	LOCK = 0x06,				// uint8 lock	engages or releases the lock, engaging starts the acquisition and engages once it settled
+	SET_LOCK_PARAMETER = 0x07,	// uint16 LOCKPARAMETERS, double value	answered once the lock accepted or rejected the value
+	SET_SCAN_PARAMETER = 0x08,	// uint16 SCANPARAMETERS, double value	answered once the lock accepted or rejected the value
+	SET_TEMPERATURE = 0x09,		// double [K] temperature offset of the laser
+	GET_STATE = 0x0A,			//		-> REPLY, then STATE
+	SUBSCRIBE = 0x0B,			// uint32 IPC_TOPICS, uint32 decimation of the live blocks
+	// answers and notifications of the server
+	REPLY = 0x81,				// uint16 IPC_STATUS, for HELLO followed by uint16 IPC_PROTOCOL_VERSION
+	STATE = 0x82,				// uint8 laser connected, uint8 DAQ connected, uint8 scan running, uint8 acquisition running, uint8 LOCKSTATE
+	LOCK_TICK = 0x83,			// uint64 tick, uint32 dropped, int64 [us] time since the epoch, double [K] temperature offset,
+								// double [1] transmission, double [1] error, double [V] output voltage, double absorption, double reference
+	SCAN_PASS = 0x84,			// uint32 dropped, int32 pass, int32 steps, double [K] temperature offset, double absorption,
+								// double reference, double [1] quotient
+	LIVE_BLOCK = 0x85			// uint64 block, uint32 dropped, double [Hz] sampling rate of the decimated samples, uint32 channels,
+								// then per channel uint32 samples and the int32 [mV] values
+} IPC_MESSAGE;
+
+typedef enum enIpcTopics {
+	TOPIC_STATE = 0x01,			// STATE whenever a connection, the scan, the acquisition or the lock changes
+	TOPIC_LOCK = 0x02,			// LOCK_TICK for every update of the lock
+	TOPIC_SCAN = 0x04,			// SCAN_PASS for every step of the scan
+	TOPIC_LIVE = 0x08			// LIVE_BLOCK for every block of the live acquisition
+} IPC_TOPICS;
+
+typedef enum enIpcStatus {
+	IPC_OK = 0,					// the request was accepted, its effect is reported by STATE
+	IPC_UNKNOWN_REQUEST = 1,	// the type is not a request
+	IPC_INVALID_ARGUMENT = 2,	// the payload is too short or a value is out of range
+	IPC_NOT_CONNECTED = 3		// the request needs the laser or the DAQ
+} IPC_STATUS;
+
+namespace ipc {
+	inline void prepareStream(QDataStream &stream) {
+		stream.setVersion(QDataStream::Qt_5_15);
+		stream.setByteOrder(QDataStream::LittleEndian);
+		stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+	}
+
+	// starts the frame with its header, the payload is appended and the size written by finishFrame()
+	inline void startFrame(QByteArray &frame, IPC_MESSAGE type, uint16_t tag) {
+		// unlike clear(), keeps a reserved buffer
+		frame.resize(IPC_HEADER_SIZE);
+		IPC_HEADER header;
+		header.type = (uint16_t)type;
+		header.tag = tag;
+		writeHeader(frame.data(), header);
+	}
+
+	inline void finishFrame(QByteArray &frame) {
+		writeUint32(frame.data() + 4, (uint32_t)(frame.size() - IPC_HEADER_SIZE));
+	}
+}
+
+#endif // IPCPROTOCOL_H
\ No newline at end of file
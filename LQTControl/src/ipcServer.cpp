@@ -0,0 +1,457 @@
+#include "ipcServer.h"
+
+IpcServer::IpcServer(QObject *parent, daq **dataAcquisition, Locking *lockingControl, LQT *laserControl) :
+	QObject(parent), m_dataAcquisition(dataAcquisition), m_lockingControl(lockingControl), m_laserControl(laserControl) {
+
+	m_frame.reserve(64 * 1024);
+
+	// only the user running LQTControl may connect
+	m_server.setSocketOptions(QLocalServer::UserAccessOption);
+	QMetaObject::Connection connection = QObject::connect(&m_server, &QLocalServer::newConnection, this, &IpcServer::newConnection);
+
+	connection = QObject::connect(m_laserControl, &LQT::connected, this, [this](bool connected) {
+		m_laserConnected = connected;
+		stateChanged();
+	});
+	connection = QObject::connect(m_lockingControl, &Locking::s_scanRunning, this, [this](bool running) {
+		m_scanRunning = running;
+		stateChanged();
+	});
+	connection = QObject::connect(m_lockingControl, &Locking::s_acquireLockingRunning, this, [this](bool running) {
+		m_acquireLockingRunning = running;
+		// the lock data may have been resized, so the next update is the first one to send
+		m_lockIndex = -1;
+		stateChanged();
+	});
+	connection = QObject::connect(m_lockingControl, &Locking::lockStateChanged, this, [this](LOCKSTATE state) {
+		m_lockState = state;
+		stateChanged();
+	});
+	connection = QObject::connect(m_lockingControl, &Locking::locked, this, &IpcServer::lockUpdated);
+	connection = QObject::connect(m_lockingControl, &Locking::s_scanPassAcquired, this, &IpcServer::scanPassAcquired);
+	acquisitionChanged();
+}
+
+IpcServer::~IpcServer() {
+	close();
+}
+
+bool IpcServer::listen(const QString &name) {
+	// a server which crashed leaves its socket behind
+	QLocalServer::removeServer(name);
+	if (!m_server.listen(name)) {
+		qWarning("Could not listen on %s: %s", qPrintable(name), qPrintable(m_server.errorString()));
+		return false;
+	}
+	qInfo("Listening on %s.", qPrintable(m_server.fullServerName()));
+	return true;
+}
+
+void IpcServer::close() {
+	m_server.close();
+	for (auto &client : m_clients) {
+		client.socket->disconnect(this);
+		client.socket->abort();
+		client.socket->deleteLater();
+	}
+	m_clients.clear();
+	liveSubscriptionsChanged();
+}
+
+void IpcServer::acquisitionChanged() {
+	QObject::disconnect(m_daqConnection);
+	QObject::disconnect(m_blockConnection);
+	m_daqConnected = false;
+	if (*m_dataAcquisition) {
+		m_daqConnection = QObject::connect(*m_dataAcquisition, &daq::connected, this, [this](bool connected) {
+			m_daqConnected = connected;
+			stateChanged();
+		});
+		m_blockConnection = QObject::connect(*m_dataAcquisition, &daq::collectedBlockData, this, &IpcServer::blockAcquired);
+	}
+	liveSubscriptionsChanged();
+	stateChanged();
+}
+
+void IpcServer::newConnection() {
+	while (m_server.hasPendingConnections()) {
+		QLocalSocket *socket = m_server.nextPendingConnection();
+		IPC_CLIENT client;
+		client.socket = socket;
+		m_clients.insert(socket, client);
+
+		QMetaObject::Connection connection = QObject::connect(socket, &QLocalSocket::readyRead, this, [this, socket]() {
+			auto client = m_clients.find(socket);
+			if (client != m_clients.end()) {
+				readRequests(*client);
+			}
+		});
+		// queued, so a client is not removed while one of its requests is handled
+		connection = QObject::connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+			m_clients.remove(socket);
+			socket->deleteLater();
+			liveSubscriptionsChanged();
+			qInfo("IPC client disconnected, %d connected.", m_clients.size());
+		}, Qt::QueuedConnection);
+		qInfo("IPC client connected, %d connected.", m_clients.size());
+	}
+}
+
+void IpcServer::readRequests(IPC_CLIENT &client) {
+	client.received.append(client.socket->readAll());
+	IPC_HEADER header;
+	while (client.socket->state() == QLocalSocket::ConnectedState) {
+		IPC_FRAME_STATUS status = ipc::parseFrame(client.received.constData(), client.received.size(), header);
+		if (status == IPC_FRAME_INCOMPLETE) {
+			return;
+		}
+		if (status == IPC_FRAME_BAD_MAGIC) {
+			qWarning("IPC client sent a frame without the magic, closing the connection.");
+			client.socket->abort();
+			return;
+		}
+		if (status == IPC_FRAME_OVERSIZED) {
+			qWarning("IPC client sent a frame of more than %d bytes, closing the connection.", IPC_MAX_PAYLOAD);
+			client.socket->abort();
+			return;
+		}
+		QByteArray data = QByteArray::fromRawData(client.received.constData() + IPC_HEADER_SIZE, header.size);
+		QDataStream payload(data);
+		ipc::prepareStream(payload);
+		handleRequest(client, header, payload);
+		client.received.remove(0, IPC_HEADER_SIZE + header.size);
+	}
+}
+
+void IpcServer::handleRequest(IPC_CLIENT &client, const IPC_HEADER &header, QDataStream &payload) {
+	quint8 flag{ 0 };
+	quint16 parameter{ 0 };
+	double value{ 0 };
+	IPC_MESSAGE type = (IPC_MESSAGE)header.type;
+	switch (type) {
+		case IPC_MESSAGE::HELLO:
+			ipc::startFrame(m_frame, IPC_MESSAGE::REPLY, header.tag);
+			{
+				QDataStream stream(&m_frame, QIODevice::WriteOnly | QIODevice::Append);
+				ipc::prepareStream(stream);
+				stream << (quint16)IPC_OK << (quint16)IPC_PROTOCOL_VERSION;
+			}
+			ipc::finishFrame(m_frame);
+			client.socket->write(m_frame);
+			sendState(client);
+			return;
+
+		case IPC_MESSAGE::GET_STATE:
+			reply(client, header.tag, IPC_OK);
+			sendState(client);
+			return;
+
+		case IPC_MESSAGE::SUBSCRIBE: {
+			quint32 topics{ 0 };
+			quint32 decimation{ 1 };
+			payload >> topics >> decimation;
+			if (payload.status() != QDataStream::Ok || decimation < 1) {
+				reply(client, header.tag, IPC_INVALID_ARGUMENT);
+				return;
+			}
+			client.topics = topics;
+			client.decimation = decimation;
+			liveSubscriptionsChanged();
+			reply(client, header.tag, IPC_OK);
+			if (client.topics & TOPIC_STATE) {
+				sendState(client);
+			}
+			return;
+		}
+
+		case IPC_MESSAGE::CONNECT:
+			if (!m_laserConnected) {
+				QMetaObject::invokeMethod(m_laserControl, &LQT::connect, Qt::QueuedConnection);
+			}
+			if (!m_daqConnected && *m_dataAcquisition) {
+				QMetaObject::invokeMethod(*m_dataAcquisition, &daq::connect, Qt::QueuedConnection);
+			}
+			reply(client, header.tag, IPC_OK);
+			return;
+
+		case IPC_MESSAGE::DISCONNECT:
+			// the scan and the lock are stopped first, they run on the thread of the DAQ
+			QMetaObject::invokeMethod(m_lockingControl, [this]() {
+				if (m_lockingControl->scanData.m_running) {
+					m_lockingControl->startScan();
+				}
+				if (m_lockingControl->getAcquireLockingRunning()) {
+					m_lockingControl->startStopAcquireLocking();
+				}
+			}, Qt::QueuedConnection);
+			if (m_daqConnected && *m_dataAcquisition) {
+				QMetaObject::invokeMethod(*m_dataAcquisition, &daq::disconnect, Qt::QueuedConnection);
+			}
+			if (m_laserConnected) {
+				QMetaObject::invokeMethod(m_laserControl, &LQT::disconnect, Qt::QueuedConnection);
+			}
+			reply(client, header.tag, IPC_OK);
+			return;
+
+		case IPC_MESSAGE::SCAN:
+		case IPC_MESSAGE::ACQUIRE:
+		case IPC_MESSAGE::LOCK:
+			payload >> flag;
+			if (payload.status() != QDataStream::Ok) {
+				reply(client, header.tag, IPC_INVALID_ARGUMENT);
+				return;
+			}
+			if (flag && (!m_laserConnected || !m_daqConnected)) {
+				reply(client, header.tag, IPC_NOT_CONNECTED);
+				return;
+			}
+			// the states are checked on the thread of the lock, so a request never toggles twice
+			QMetaObject::invokeMethod(m_lockingControl, [this, type, run = (bool)flag]() {
+				if (type == IPC_MESSAGE::SCAN) {
+					if (m_lockingControl->scanData.m_running != run) {
+						m_lockingControl->startScan();
+					}
+					return;
+				}
+				// a later LOCK or ACQUIRE request cancels an engagement still waiting for the signals to settle
+				uint32_t lockRequest = ++m_lockRequests;
+				bool active = (m_lockingControl->getLockSettings().state == LOCKSTATE::ACTIVE);
+				if (type == IPC_MESSAGE::LOCK && !run) {
+					if (active) {
+						m_lockingControl->startStopLocking();
+					}
+					return;
+				}
+				bool started{ false };
+				if (m_lockingControl->getAcquireLockingRunning() != run) {
+					m_lockingControl->startStopAcquireLocking();
+					started = run;
+				}
+				if (type != IPC_MESSAGE::LOCK || !m_lockingControl->getAcquireLockingRunning() || active) {
+					return;
+				}
+				if (!started) {
+					m_lockingControl->startStopLocking();
+					return;
+				}
+				// like the headless control, the acquisition runs for a while before the lock is engaged
+				QTimer::singleShot(m_lockSettleTime, m_lockingControl, [this, lockRequest]() {
+					if (lockRequest == m_lockRequests && m_lockingControl->getAcquireLockingRunning()
+						&& m_lockingControl->getLockSettings().state != LOCKSTATE::ACTIVE) {
+						m_lockingControl->startStopLocking();
+					}
+				});
+			}, Qt::QueuedConnection);
+			reply(client, header.tag, IPC_OK);
+			return;
+
+		case IPC_MESSAGE::SET_LOCK_PARAMETER:
+		case IPC_MESSAGE::SET_SCAN_PARAMETER: {
+			payload >> parameter >> value;
+			bool lock = (type == IPC_MESSAGE::SET_LOCK_PARAMETER);
+			int last = lock ? (int)LOCKPARAMETERS::DESATURATIONRATE : (int)SCANPARAMETERS::INTERVAL;
+			if (payload.status() != QDataStream::Ok || parameter > last || !std::isfinite(value)) {
+				reply(client, header.tag, IPC_INVALID_ARGUMENT);
+				return;
+			}
+			// the lock checks the range of the value, the reply is sent once it did
+			QMetaObject::invokeMethod(m_lockingControl, [this, socket = QPointer<QLocalSocket>(client.socket), tag = header.tag, lock, parameter, value]() {
+				bool accepted;
+				if (lock) {
+					accepted = m_lockingControl->setLockParameters((LOCKPARAMETERS)parameter, value);
+				} else {
+					accepted = m_lockingControl->setScanParameters((SCANPARAMETERS)parameter, value);
+				}
+				QMetaObject::invokeMethod(this, [this, socket, tag, accepted]() {
+					// the client may have disconnected meanwhile
+					auto client = m_clients.find(socket.data());
+					if (socket && client != m_clients.end()) {
+						reply(*client, tag, accepted ? IPC_OK : IPC_INVALID_ARGUMENT);
+					}
+				}, Qt::QueuedConnection);
+			}, Qt::QueuedConnection);
+			return;
+		}
+
+		case IPC_MESSAGE::SET_TEMPERATURE:
+			payload >> value;
+			if (payload.status() != QDataStream::Ok || !std::isfinite(value)) {
+				reply(client, header.tag, IPC_INVALID_ARGUMENT);
+				return;
+			}
+			if (!m_laserConnected) {
+				reply(client, header.tag, IPC_NOT_CONNECTED);
+				return;
+			}
+			m_laserControl->post(LQT_COMMAND::SETTEMPERATURE, value, LQT_PRIORITY::USER);
+			reply(client, header.tag, IPC_OK);
+			return;
+
+		default:
+			reply(client, header.tag, IPC_UNKNOWN_REQUEST);
+			return;
+	}
+}
+
+void IpcServer::reply(IPC_CLIENT &client, uint16_t tag, IPC_STATUS status) {
+	ipc::startFrame(m_frame, IPC_MESSAGE::REPLY, tag);
+	{
+		QDataStream stream(&m_frame, QIODevice::WriteOnly | QIODevice::Append);
+		ipc::prepareStream(stream);
+		stream << (quint16)status;
+	}
+	ipc::finishFrame(m_frame);
+	// replies are never dropped, a client which does not read them is closed
+	if (client.socket->bytesToWrite() > 4 * m_maxPendingBytes) {
+		qWarning("IPC client does not read its replies, closing the connection.");
+		client.socket->abort();
+		return;
+	}
+	client.socket->write(m_frame);
+}
+
+void IpcServer::sendState(IPC_CLIENT &client) {
+	ipc::startFrame(m_frame, IPC_MESSAGE::STATE, 0);
+	{
+		QDataStream stream(&m_frame, QIODevice::WriteOnly | QIODevice::Append);
+		ipc::prepareStream(stream);
+		stream << (quint8)m_laserConnected << (quint8)m_daqConnected << (quint8)m_scanRunning
+			<< (quint8)m_acquireLockingRunning << (quint8)m_lockState;
+	}
+	ipc::finishFrame(m_frame);
+	client.socket->write(m_frame);
+}
+
+bool IpcServer::isCongested(IPC_CLIENT &client, uint32_t &dropped) {
+	bool congested = (client.socket->bytesToWrite() > m_maxPendingBytes);
+	if (congested) {
+		if (!client.congested) {
+			qWarning("IPC client does not keep up, dropping its notifications.");
+		}
+		dropped++;
+	}
+	client.congested = congested;
+	return congested;
+}
+
+bool IpcServer::hasSubscribers(IPC_TOPICS topic) {
+	for (const auto &client : m_clients) {
+		if (client.topics & topic) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// The DAQ only keeps the last block of the live acquisition while a client subscribed to it.
+void IpcServer::liveSubscriptionsChanged() {
+	if (*m_dataAcquisition) {
+		(*m_dataAcquisition)->setLatestBlockRequested(hasSubscribers(TOPIC_LIVE));
+	}
+}
+
+void IpcServer::stateChanged() {
+	for (auto &client : m_clients) {
+		if (client.topics & TOPIC_STATE) {
+			sendState(client);
+		}
+	}
+}
+
+// Sends the updates of the lock since the last call. The lock data is read while the lock
+// may write the next update, like the lock view does.
+void IpcServer::lockUpdated() {
+	const auto &lockData = m_lockingControl->lockData;
+	if (lockData.storageSize == 0) {
+		return;
+	}
+	gsl::index next = lockData.nextIndex;
+	if (next == 0 && !lockData.wrapped) {
+		return;
+	}
+	if (m_lockIndex < 0 || m_lockIndex >= lockData.storageSize) {
+		m_lockIndex = generalmath::indexWrapped((int)next - 1, lockData.storageSize);
+	}
+	// the events of a burst of updates arrive after all of them were written
+	bool subscribed = hasSubscribers(TOPIC_LOCK);
+	while (m_lockIndex != next) {
+		gsl::index index = m_lockIndex;
+		m_lockIndex = generalmath::indexWrapped((int)m_lockIndex + 1, lockData.storageSize);
+		m_lockTick++;
+		if (!subscribed) {
+			continue;
+		}
+		for (auto &client : m_clients) {
+			if (!(client.topics & TOPIC_LOCK) || isCongested(client, client.droppedTicks)) {
+				continue;
+			}
+			ipc::startFrame(m_frame, IPC_MESSAGE::LOCK_TICK, 0);
+			{
+				QDataStream stream(&m_frame, QIODevice::WriteOnly | QIODevice::Append);
+				ipc::prepareStream(stream);
+				stream << (quint64)m_lockTick << (quint32)client.droppedTicks
+					<< (qint64)std::chrono::duration_cast<std::chrono::microseconds>(lockData.time[index].time_since_epoch()).count()
+					<< lockData.tempOffset[index] << lockData.transmission[index] << lockData.error[index]
+					<< lockData.outputVoltage[index] << (double)lockData.absorption[index] << (double)lockData.reference[index];
+			}
+			ipc::finishFrame(m_frame);
+			client.socket->write(m_frame);
+			client.droppedTicks = 0;
+		}
+	}
+}
+
+void IpcServer::scanPassAcquired() {
+	const auto &scanData = m_lockingControl->scanData;
+	// the pass counter already points to the next step
+	gsl::index pass = scanData.pass - 1;
+	if (pass < 0 || pass >= (gsl::index)scanData.quotient.size()) {
+		return;
+	}
+	for (auto &client : m_clients) {
+		if (!(client.topics & TOPIC_SCAN) || isCongested(client, client.droppedPasses)) {
+			continue;
+		}
+		ipc::startFrame(m_frame, IPC_MESSAGE::SCAN_PASS, 0);
+		{
+			QDataStream stream(&m_frame, QIODevice::WriteOnly | QIODevice::Append);
+			ipc::prepareStream(stream);
+			stream << (quint32)client.droppedPasses << (qint32)pass << (qint32)scanData.nrSteps << scanData.temperatures[pass]
+				<< scanData.absorption[pass] << scanData.reference[pass] << scanData.quotient[pass];
+		}
+		ipc::finishFrame(m_frame);
+		client.socket->write(m_frame);
+		client.droppedPasses = 0;
+	}
+}
+
+void IpcServer::blockAcquired() {
+	if (!*m_dataAcquisition || !hasSubscribers(TOPIC_LIVE)) {
+		return;
+	}
+	auto parameters = (*m_dataAcquisition)->getAcquisitionParameters();
+	auto samplingRates = (*m_dataAcquisition)->getSamplingRates();
+	double samplingRate = (parameters.timebaseIndex < (int)samplingRates.size()) ? samplingRates[parameters.timebaseIndex] : 0;
+	for (auto &client : m_clients) {
+		// the block is not even copied for a congested client
+		if (!(client.topics & TOPIC_LIVE) || isCongested(client, client.droppedBlocks)) {
+			continue;
+		}
+		uint64_t block = (*m_dataAcquisition)->getLatestBlock(m_blockValues, client.decimation);
+		ipc::startFrame(m_frame, IPC_MESSAGE::LIVE_BLOCK, 0);
+		{
+			QDataStream stream(&m_frame, QIODevice::WriteOnly | QIODevice::Append);
+			ipc::prepareStream(stream);
+			stream << (quint64)block << (quint32)client.droppedBlocks << samplingRate / client.decimation << (quint32)m_blockValues.size();
+			for (const auto &values : m_blockValues) {
+				stream << (quint32)values.size();
+				for (const auto &value : values) {
+					stream << (qint32)value;
+				}
+			}
+		}
+		ipc::finishFrame(m_frame);
+		client.socket->write(m_frame);
+		client.droppedBlocks = 0;
+	}
+}
\ No newline at end of file
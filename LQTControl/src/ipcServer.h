@@ -0,0 +1,91 @@
+#ifndef IPCSERVER_H
+#define IPCSERVER_H
+
+#include <QtCore>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include "ipcProtocol.h"
+#include "locking.h"
+#include "Devices/daq.h"
+#include "Devices/LQT.h"
+
+typedef struct IPC_CLIENT {
+	QLocalSocket *socket{ nullptr };	//		connection of the client
+	QByteArray received;				//		received bytes which do not form a complete frame yet
+	uint32_t topics{ 0 };				//		subscribed IPC_TOPICS
+	uint32_t decimation{ 1 };			//		only every decimation-th sample of the live blocks is sent
+	uint32_t droppedTicks{ 0 };			//		lock ticks dropped since the last one sent
+	uint32_t droppedPasses{ 0 };		//		scan passes dropped since the last one sent
+	uint32_t droppedBlocks{ 0 };		//		live blocks dropped since the last one sent
+	bool congested{ false };			//		whether the last notification was dropped
+} IPC_CLIENT;
+
+/*
+ * Local control and data API for other programs on the same machine, on a Unix domain
+ * socket or a named pipe on Windows. See ipcProtocol.h for the framing and the messages.
+ *
+ * The server lives on the thread of its parent and only talks to the workers through queued
+ * calls and their signals. Notifications are dropped for a client which does not read them,
+ * so a slow client never holds up the lock or the acquisition.
+ */
+class IpcServer : public QObject {
+	Q_OBJECT
+
+public:
+	explicit IpcServer(QObject *parent, daq **dataAcquisition, Locking *lockingControl, LQT *laserControl);
+	~IpcServer();
+
+	// listens on the socket of the given name, e.g. lqtcontrol or /tmp/lqtcontrol
+	bool listen(const QString &name);
+	void close();
+	// has to be called whenever the DAQ was replaced
+	void acquisitionChanged();
+
+	int m_maxPendingBytes{ 1 << 20 };	// [B]	pending bytes of a client above which its notifications are dropped
+	int m_lockSettleTime{ 1000 };		// [ms]	time the acquisition started by a LOCK request runs before the lock is engaged
+
+private slots:
+	void newConnection();
+
+private:
+	QLocalServer m_server;
+	daq **m_dataAcquisition;
+	Locking *m_lockingControl;
+	LQT *m_laserControl;
+	QHash<QLocalSocket *, IPC_CLIENT> m_clients;
+	QMetaObject::Connection m_blockConnection;
+	QMetaObject::Connection m_daqConnection;
+
+	// the states as last reported by the workers
+	bool m_laserConnected{ false };
+	bool m_daqConnected{ false };
+	bool m_scanRunning{ false };
+	bool m_acquireLockingRunning{ false };
+	LOCKSTATE m_lockState{ LOCKSTATE::INACTIVE };
+
+	gsl::index m_lockIndex{ -1 };		//		index of the lock data to send next, -1 until the first update after starting the acquisition
+	uint64_t m_lockTick{ 0 };			//		number of lock updates seen
+	uint32_t m_lockRequests{ 0 };		//		number of LOCK and ACQUIRE requests, only used on the thread of the lock
+	QByteArray m_frame;					//		frame being built, kept so its buffer is reused
+	std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> m_blockValues;	// [mV]	decimated live block
+
+	void readRequests(IPC_CLIENT &client);
+	void handleRequest(IPC_CLIENT &client, const IPC_HEADER &header, QDataStream &payload);
+	void reply(IPC_CLIENT &client, uint16_t tag, IPC_STATUS status);
+	void sendState(IPC_CLIENT &client);
+	// whether the client has too many pending bytes for another notification, which is then counted as dropped
+	bool isCongested(IPC_CLIENT &client, uint32_t &dropped);
+	bool hasSubscribers(IPC_TOPICS topic);
+	void liveSubscriptionsChanged();
+
+	void stateChanged();
+	void lockUpdated();
+	void scanPassAcquired();
+	void blockAcquired();
+};
+
+#endif // IPCSERVER_H
\ No newline at end of file
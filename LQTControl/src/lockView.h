@@ -0,0 +1,84 @@
+#ifndef LOCKVIEW_H
+#define LOCKVIEW_H
+
+#include <QPointF>
+#include <QVector>
+#include <QtCharts/QLineSeries>
+#include <vector>
+#include <chrono>
+#include <gsl/gsl>
+
+#include "generalmath.h"
+#include "locking.h"
+
+/*
+ * Builds the points of the lock view from the stored lock data.
+ */
+class lockView {
+public:
+	// [s]	time of the stored value passed since the start of the measurement
+	static double passedTime(const LOCK_DATA &lockData, gsl::index index) {
+		return std::chrono::duration_cast<std::chrono::milliseconds>(
+			lockData.time[index] - lockData.startTime
+		).count() / 1e3;
+	}
+
+	// the stored values in the order they were acquired, over the time passed since the start of the measurement
+	// A QVector stores the points in one block, a QList would allocate every point on its own.
+	static QVector<QPointF> orderedPoints(const LOCK_DATA &lockData, const std::vector<double> &values) {
+		auto points = QVector<QPointF>{};
+		auto size = lockData.wrapped ? lockData.storageSize : lockData.nextIndex;
+		points.reserve(size);
+		if (lockData.wrapped) {
+			for (gsl::index i{ lockData.nextIndex }; i < lockData.storageSize; i++) {
+				points.append(QPointF(passedTime(lockData, i), values[i]));
+			}
+		}
+		for (gsl::index i{ 0 }; i < lockData.nextIndex; i++) {
+			points.append(QPointF(passedTime(lockData, i), values[i]));
+		}
+		return points;
+	}
+
+	// Appends the values stored since the last call to the series of the lock view and replaces the transmission.
+	// The lock may store several values between two calls, nextIndex is the index of the next value the view
+	// appends and is advanced to the next index of the lock. The series keep as many points as the lock stores,
+	// the mean and standard deviation of the error run over nrMeanValues.
+	static void appendLatest(const LOCK_DATA &lockData, gsl::index nrMeanValues, QVector<QtCharts::QLineSeries *> &plots, gsl::index &nextIndex) {
+		// the storage was reset since the last call
+		if (nextIndex >= lockData.storageSize || (!lockData.wrapped && nextIndex > lockData.nextIndex)) {
+			nextIndex = 0;
+		}
+		for (; nextIndex != lockData.nextIndex; nextIndex = generalmath::indexWrapped((int)nextIndex + 1, lockData.storageSize)) {
+			auto passed = passedTime(lockData, nextIndex);
+
+			plots[static_cast<int>(lockViewPlotTypes::ABSORPTION)]->append(QPointF(passed, lockData.absorption[nextIndex]));
+			plots[static_cast<int>(lockViewPlotTypes::REFERENCE)]->append(QPointF(passed, lockData.reference[nextIndex]));
+			plots[static_cast<int>(lockViewPlotTypes::ERRORSIGNAL)]->append(QPointF(passed, lockData.error[nextIndex]));
+			plots[static_cast<int>(lockViewPlotTypes::TEMPERATUREOFFSET)]->append(QPointF(passed, lockData.tempOffset[nextIndex]));
+
+			// the floating statistics end with the appended value
+			auto offset = lockData.storageSize - (nextIndex + 1);
+			plots[static_cast<int>(lockViewPlotTypes::ERRORSIGNALMEAN)]->append(
+				QPointF(passed, generalmath::floatingMean(lockData.error, nrMeanValues, offset))
+			);
+			plots[static_cast<int>(lockViewPlotTypes::ERRORSIGNALSTD)]->append(
+				QPointF(passed, generalmath::floatingStandardDeviation(lockData.error, nrMeanValues, offset))
+			);
+		}
+
+		// Replace the transmission array in the correct order
+		plots[static_cast<int>(lockViewPlotTypes::TRANSMISSION)]->replace(orderedPoints(lockData, lockData.transmission));
+
+		// If there are more points than desired, remove the oldest ones.
+		// Removing all of them and not only one keeps the series bounded when the storage shrinks.
+		for (auto series : plots) {
+			auto excess = series->count() - lockData.storageSize;
+			if (excess > 0) {
+				series->removePoints(0, excess);
+			}
+		}
+	}
+};
+
+#endif // LOCKVIEW_H
\ No newline at end of file
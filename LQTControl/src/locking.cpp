@@ -1,20 +1,63 @@
 #include "locking.h"
-#include <QtWidgets>
-#include <QtWidgets/QApplication>
-#include <QtWidgets/QMainWindow>
 
 Locking::Locking(QObject *parent, daq **dataAcquisition, LQT *laserControl) :
 	QObject(parent), m_dataAcquisition(dataAcquisition), m_laserControl(laserControl) {
 
-	// Calculate the maximum storage size and resize the arrays accordingly
-	lockData.storageSize = (int)((1000 * lockData.storageDuration) / lockSettings.lockingTimeout);
+	// The views read the storage from other threads, so it must never be reallocated.
+	// Reserving the maximum size once lets resizeStorage() change the size in place.
+	lockData.time.reserve(LOCK_MAX_STORAGE_SIZE);
+	lockData.absorption.reserve(LOCK_MAX_STORAGE_SIZE);
+	lockData.reference.reserve(LOCK_MAX_STORAGE_SIZE);
+	lockData.quotient.reserve(LOCK_MAX_STORAGE_SIZE);
+	lockData.transmission.reserve(LOCK_MAX_STORAGE_SIZE);
+	lockData.tempOffset.reserve(LOCK_MAX_STORAGE_SIZE);
+	lockData.error.reserve(LOCK_MAX_STORAGE_SIZE);
+	lockData.outputVoltage.reserve(LOCK_MAX_STORAGE_SIZE);
+	scanData.temperatures.reserve(SCAN_MAX_STEPS);
+	scanData.reference.reserve(SCAN_MAX_STEPS);
+	scanData.absorption.reserve(SCAN_MAX_STEPS);
+	scanData.quotient.reserve(SCAN_MAX_STEPS);
+	scanData.transmission.reserve(SCAN_MAX_STEPS);
+	resizeStorage();
+	lockData.startTime = Clock::get()->now();
+}
+
+void Locking::resizeStorage() {
+	// Calculate the maximum storage size and resize the arrays accordingly.
+	// With an adaptive timeout the ticks can be as close as the minimum timeout,
+	// when paced by the sample clock they are as close as the samples per update take.
+	double timeout = lockSettings.adaptive ? lockSettings.minLockingTimeout : lockSettings.lockingTimeout;
+	if (m_timebase == LOCKTIMEBASE::SAMPLECLOCK && m_sampleClockRate > 0) {
+		timeout = 1e3 * lockSettings.samplesPerUpdate / m_sampleClockRate;
+	}
+	double size = (1000 * lockData.storageDuration) / timeout;
+	int storageSize = LOCK_MAX_STORAGE_SIZE;
+	if (size < 1) {
+		// the updates are stored in a ring, which needs at least one slot
+		qWarning("The storage duration of %d s holds no update, one is stored.", lockData.storageDuration);
+		storageSize = 1;
+	} else if (size < LOCK_MAX_STORAGE_SIZE) {
+		storageSize = (int)size;
+	} else {
+		qWarning("The lock can store at most %d updates, the older ones are overwritten earlier.", LOCK_MAX_STORAGE_SIZE);
+	}
+	if (storageSize == lockData.storageSize) {
+		return;
+	}
+	lockData.storageSize = storageSize;
 	lockData.time.resize(lockData.storageSize);
 	lockData.absorption.resize(lockData.storageSize);
 	lockData.reference.resize(lockData.storageSize);
 	lockData.quotient.resize(lockData.storageSize);
 	lockData.tempOffset.resize(lockData.storageSize);
 	lockData.error.resize(lockData.storageSize);
-	lockData.startTime = std::chrono::system_clock::now();
+	lockData.outputVoltage.resize(lockData.storageSize);
+	lockData.transmission.resize(lockData.storageSize);
+	// the stored data is not in order anymore after resizing
+	std::fill(lockData.quotient.begin(), lockData.quotient.end(), 0.0);
+	lockData.quotient_max = 0;
+	lockData.nextIndex = 0;
+	lockData.wrapped = false;
 }
 
 void Locking::startStopAcquireLocking() {
@@ -22,25 +65,73 @@ void Locking::startStopAcquireLocking() {
 		setLockState(LOCKSTATE::INACTIVE);
 		m_isAcquireLockingRunning = false;
 		lockingTimer->stop();
+		m_engaging = false;
+		(*m_dataAcquisition)->stopStreaming();
+		// don't leave a started capture behind, it would be outdated when read
+		(*m_dataAcquisition)->discardBlockData();
 	} else {
 		m_isAcquireLockingRunning = true;
-		lockingTimer->start(lockSettings.lockingTimeout);
+		m_timebase = lockSettings.timebase;
+		m_lockingTimeout = lockSettings.adaptive ? lockSettings.minLockingTimeout : lockSettings.lockingTimeout;
+		m_stableTicks = 0;
+		m_firstUpdate = true;
+		if (m_timebase == LOCKTIMEBASE::SAMPLECLOCK) {
+			// the timer only polls for new samples, the updates are paced by the device
+			if (!(*m_dataAcquisition)->startStreaming()) {
+				qWarning("Could not start streaming, locking is not started.");
+				m_isAcquireLockingRunning = false;
+				emit(s_acquireLockingRunning(m_isAcquireLockingRunning));
+				return;
+			}
+			m_sampleClockStart = Clock::get()->now();
+			m_sampleClockRate = (*m_dataAcquisition)->getStreamingSamplingRate();
+			m_sampleClockSamples = 0;
+			m_lockingTimeout = lockSettings.pollingTimeout;
+		}
+		resizeStorage();
+		lockingTimerMonitor.setPeriod(m_lockingTimeout);
+		lockingTimerMonitor.reset();
+		lockingTimer->start(m_lockingTimeout);
 	}
 	emit(s_acquireLockingRunning(m_isAcquireLockingRunning));
 }
 
+// The lock starts from the current temperature offset of the laser. The laser lives on the serial thread,
+// so we do not wait for its answer here. The first update after the answer arrived engages the lock.
 void Locking::startStopLocking() {
-	if (lockSettings.state != LOCKSTATE::ACTIVE) {
-		// set integral error to zero before starting to lock
-		lockData.iError = 0;
-		// set current temperature offset to actual offset
-		lockData.currentTempOffset = m_laserControl->getTemperature();
-		setLockState(LOCKSTATE::ACTIVE);
+	if (lockSettings.state != LOCKSTATE::ACTIVE && !m_engaging) {
+		if (lockSettings.actuator == LOCKACTUATOR::ANALOG) {
+			// the analog output starts centred
+			engage(0);
+		} else {
+			m_engaging = true;
+			m_engageReady = false;
+			m_laserControl->getTemperatureAsync(LQT_PRIORITY::USER, [this](double temperature) {
+				m_engageTemperature = temperature;
+				m_engageReady = true;
+			});
+		}
 	} else {
+		m_engaging = false;
 		setLockState(LOCKSTATE::INACTIVE);
 	}
 }
 
+void Locking::engage(double temperature) {
+	// set integral error to zero before starting to lock
+	lockData.iError = 0;
+	lockData.currentTempOffset = temperature;
+	if (lockSettings.actuator == LOCKACTUATOR::ANALOG) {
+		setAnalogOutput(lockData.currentTempOffset);
+	}
+	if (lockSettings.actuator == LOCKACTUATOR::DUAL) {
+		lockData.fastOffset = 0;
+		lockData.offsetMean = lockData.currentTempOffset;
+		setAnalogOutput(lockData.fastOffset);
+	}
+	setLockState(LOCKSTATE::ACTIVE);
+}
+
 void Locking::setLockState(LOCKSTATE lockstate) {
 	lockSettings.state = lockstate;
 	emit(lockStateChanged(lockSettings.state));
@@ -50,7 +141,8 @@ SCAN_SETTINGS Locking::getScanSettings() {
 	return scanSettings;
 }
 
-void Locking::setScanParameters(SCANPARAMETERS type, double value) {
+// Returns false if the value was rejected, the setting is unchanged then.
+bool Locking::setScanParameters(SCANPARAMETERS type, double value) {
 	switch (type) {
 		case SCANPARAMETERS::LOW:
 			scanSettings.low = value;
@@ -59,15 +151,26 @@ void Locking::setScanParameters(SCANPARAMETERS type, double value) {
 			scanSettings.high = value;
 			break;
 		case SCANPARAMETERS::STEPS:
+			// the scan data is reserved for the maximum, so it is never reallocated
+			if (value < 1 || value > SCAN_MAX_STEPS) {
+				qWarning("A scan needs between 1 and %d steps.", SCAN_MAX_STEPS);
+				return false;
+			}
 			scanSettings.nrSteps = value;
 			break;
 		case SCANPARAMETERS::INTERVAL:
+			if (value <= 0) {
+				qWarning("The scan interval has to be positive.");
+				return false;
+			}
 			scanSettings.interval = value;
 			break;
 	}
+	return true;
 }
 
-void Locking::setLockParameters(LOCKPARAMETERS type, double value) {
+// Returns false if the value was rejected, the setting is unchanged then.
+bool Locking::setLockParameters(LOCKPARAMETERS type, double value) {
 	switch (type) {
 		case LOCKPARAMETERS::P:
 			lockSettings.proportional = value;
@@ -81,7 +184,117 @@ void Locking::setLockParameters(LOCKPARAMETERS type, double value) {
 		case LOCKPARAMETERS::SETPOINT:
 			lockSettings.transmissionSetpoint = value;
 			break;
+		case LOCKPARAMETERS::PIPELINED:
+			lockSettings.pipelined = (bool)value;
+			break;
+		case LOCKPARAMETERS::ADAPTIVE:
+			lockSettings.adaptive = (bool)value;
+			break;
+		case LOCKPARAMETERS::MINTIMEOUT:
+			// the adaptive range has to contain the locking timeout it starts from
+			if (value <= 0 || value > lockSettings.lockingTimeout) {
+				qWarning("The minimum locking timeout has to be positive and at most %d ms.", lockSettings.lockingTimeout);
+				return false;
+			}
+			lockSettings.minLockingTimeout = (int)value;
+			break;
+		case LOCKPARAMETERS::MAXTIMEOUT:
+			if (value < lockSettings.lockingTimeout) {
+				qWarning("The maximum locking timeout has to be at least %d ms.", lockSettings.lockingTimeout);
+				return false;
+			}
+			lockSettings.maxLockingTimeout = (int)value;
+			break;
+		case LOCKPARAMETERS::FASTERROR:
+			if (value < 0) {
+				qWarning("The fast error threshold must not be negative.");
+				return false;
+			}
+			lockSettings.fastErrorThreshold = value;
+			break;
+		case LOCKPARAMETERS::FASTERRORRATE:
+			if (value < 0) {
+				qWarning("The fast error rate threshold must not be negative.");
+				return false;
+			}
+			lockSettings.fastErrorRateThreshold = value;
+			break;
+		case LOCKPARAMETERS::STABLEERROR:
+			if (value < 0) {
+				qWarning("The stable error threshold must not be negative.");
+				return false;
+			}
+			lockSettings.stableErrorThreshold = value;
+			break;
+		case LOCKPARAMETERS::TIMEBASE:
+			if (value != LOCKTIMEBASE::HOSTTIMER && value != LOCKTIMEBASE::SAMPLECLOCK) {
+				qWarning("Unknown timebase %f.", value);
+				return false;
+			}
+			lockSettings.timebase = (LOCKTIMEBASE)(int)value;
+			break;
+		case LOCKPARAMETERS::SAMPLESPERUPDATE:
+			// every update needs samples, the storage is sized by the time they take
+			if (value < 1) {
+				qWarning("An update has to process at least one sample.");
+				return false;
+			}
+			lockSettings.samplesPerUpdate = (uint32_t)value;
+			break;
+		case LOCKPARAMETERS::ACTUATOR:
+			if (value != LOCKACTUATOR::TEMPERATURE && value != LOCKACTUATOR::ANALOG && value != LOCKACTUATOR::DUAL) {
+				qWarning("Unknown actuator %f.", value);
+				return false;
+			}
+			lockSettings.actuator = (LOCKACTUATOR)(int)value;
+			break;
+		case LOCKPARAMETERS::ANALOGSCALING:
+			lockSettings.analogScaling = value;
+			break;
+		case LOCKPARAMETERS::ANALOGOFFSET:
+			lockSettings.analogOffset = value;
+			break;
+		case LOCKPARAMETERS::ANALOGMIN:
+			if (value >= lockSettings.analogMaxVoltage) {
+				qWarning("The minimum output voltage has to be below the maximum of %f V.", lockSettings.analogMaxVoltage);
+				return false;
+			}
+			lockSettings.analogMinVoltage = value;
+			break;
+		case LOCKPARAMETERS::ANALOGMAX:
+			if (value <= lockSettings.analogMinVoltage) {
+				qWarning("The maximum output voltage has to be above the minimum of %f V.", lockSettings.analogMinVoltage);
+				return false;
+			}
+			lockSettings.analogMaxVoltage = value;
+			break;
+		case LOCKPARAMETERS::CROSSOVER:
+			if (value <= 0) {
+				qWarning("The crossover frequency has to be positive.");
+				return false;
+			}
+			lockSettings.crossoverFrequency = value;
+			break;
+		case LOCKPARAMETERS::DESATURATIONRATE:
+			if (value < 0) {
+				qWarning("The desaturation rate must not be negative.");
+				return false;
+			}
+			lockSettings.desaturationRate = value;
+			break;
+	}
+	return true;
+}
+
+// Returns false if the range is empty, the limits are unchanged then.
+bool Locking::setAnalogRange(double minVoltage, double maxVoltage) {
+	if (minVoltage >= maxVoltage) {
+		qWarning("The minimum output voltage of %f V has to be below the maximum of %f V.", minVoltage, maxVoltage);
+		return false;
 	}
+	lockSettings.analogMinVoltage = minVoltage;
+	lockSettings.analogMaxVoltage = maxVoltage;
+	return true;
 }
 
 void Locking::startScan() {
@@ -90,9 +303,10 @@ void Locking::startScan() {
 		scanTimer->stop();
 		emit s_scanRunning(scanData.m_running);
 	} else {
-		// prepare data arrays
+		// prepare data arrays, in place since the views read them
 		scanData.nrSteps = scanSettings.nrSteps;
-		scanData.temperatures = generalmath::linspace<double>(scanSettings.low, scanSettings.high, scanSettings.nrSteps);
+		scanData.temperatures.resize(scanSettings.nrSteps);
+		generalmath::linspace(scanSettings.low, scanSettings.high, scanData.temperatures);
 
 		scanData.reference.resize(scanSettings.nrSteps);
 		scanData.absorption.resize(scanSettings.nrSteps);
@@ -109,14 +323,17 @@ void Locking::startScan() {
 		scanData.m_running = true;
 		scanData.m_abort = false;
 		// set laser temperature to start value
-		m_laserControl->setTemperatureForce(scanData.temperatures[scanData.pass]);
-		passTimer.start();
+		m_laserControl->setTemperatureAsync(scanData.temperatures[scanData.pass], LQT_PRIORITY::SCAN);
+		passStart = Clock::get()->now();
+		scanTimerMonitor.reset();
 		scanTimer->start(1000);
 		emit s_scanRunning(scanData.m_running);
 	}
 }
 
 void Locking::scan() {
+	scanTimerMonitor.tickStarted();
+
 	// abort scan if wanted
 	if (scanData.m_abort) {
 		scanData.m_running = false;
@@ -124,21 +341,27 @@ void Locking::scan() {
 		emit s_scanRunning(scanData.m_running);
 	}
 
+	auto passElapsed = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::get()->now() - passStart).count();
+
 	// wait for one minute for first value to let temperature settle
-	if (scanData.pass == 0 && passTimer.elapsed() < 6e1) {
+	if (scanData.pass == 0 && passElapsed < 6e1) {
 		return;
 	}
 
 	// acquire new datapoint when interval has passed
-	if (passTimer.elapsed() < (scanSettings.interval*1e3)) {
+	if (passElapsed < (scanSettings.interval*1e3)) {
 		return;
 	}
 
 	// reset timer when enough time has passed
-	passTimer.start();
+	passStart = Clock::get()->now();
 
 	// acquire detector and reference signal, store and process it
 	std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> values = (*m_dataAcquisition)->collectBlockData();
+	// the device captures no blocks while the lock streams, we try again after the next interval
+	if (values[0].empty() || values[1].empty()) {
+		return;
+	}
 
 	double absorption_mean = generalmath::mean(values[0]) / 1e3;
 	double reference_mean = generalmath::mean(values[1]) / 1e3;
@@ -150,30 +373,161 @@ void Locking::scan() {
 
 	double quotient_max = generalmath::max(scanData.quotient);
 
-	scanData.transmission = scanData.quotient;
-	std::for_each(scanData.transmission.begin(), scanData.transmission.end(), [quotient_max](double &el) {el /= quotient_max; });
+	std::transform(scanData.quotient.begin(), scanData.quotient.end(), scanData.transmission.begin(), [quotient_max](double el) {return el / quotient_max; });
 
 	++scanData.pass;
 	emit s_scanPassAcquired();
 	// if scan is not done, set temperature to new value, else annouce finished scan
 	if (scanData.pass < scanData.nrSteps) {
-		m_laserControl->setTemperatureForce(scanData.temperatures[scanData.pass]);
+		m_laserControl->setTemperatureAsync(scanData.temperatures[scanData.pass], LQT_PRIORITY::SCAN);
 	} else {
 		scanData.m_running = false;
 		scanTimer->stop();
 		emit s_scanRunning(scanData.m_running);
 	}
+
+	scanTimerMonitor.tickFinished();
+	emit timingStatisticsChanged(scanTimerMonitor.getStatistics());
 }
 
 LOCK_SETTINGS Locking::getLockSettings() {
 	return lockSettings;
 }
 
+int Locking::getLockingTimeout() {
+	return m_lockingTimeout;
+}
+
+bool Locking::getAcquireLockingRunning() {
+	return m_isAcquireLockingRunning;
+}
+
+void Locking::setSharedRing(SharedRingWriter *ring) {
+	m_sharedRing = ring;
+}
+
+// Returns the number of stored samples acquired during the last duration [s].
+// Since the ticks are not equally spaced, this has to be used instead of a fixed number of samples.
+gsl::index Locking::getNumberOfSamples(double duration) {
+	auto count = lockData.wrapped ? lockData.storageSize : lockData.nextIndex;
+	if (count == 0) {
+		return 0;
+	}
+	auto lastIndex = generalmath::indexWrapped((int)lockData.nextIndex - 1, lockData.storageSize);
+	auto start = lockData.time[lastIndex] - std::chrono::microseconds((int64_t)(duration * 1e6));
+	gsl::index number{ 0 };
+	while (number < count && lockData.time[generalmath::indexWrapped((int)(lastIndex - number), lockData.storageSize)] > start) {
+		number++;
+	}
+	return number;
+}
+
 void Locking::lock() {
-	std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> values = (*m_dataAcquisition)->collectBlockData();
+	lockingTimerMonitor.tickStarted();
+	bool updated{ false };
+
+	if (m_engaging && m_engageReady) {
+		m_engaging = false;
+		double temperature = m_engageTemperature;
+		if (isnan(temperature)) {
+			qWarning("The laser did not report its temperature offset, locking is not started.");
+			setLockState(LOCKSTATE::INACTIVE);
+		} else {
+			engage(temperature);
+		}
+	}
+
+	if (m_timebase == LOCKTIMEBASE::SAMPLECLOCK) {
+		// Run one update for every complete set of samples the device streamed since the last run.
+		// The time is derived from the number of samples, so the updates are equally spaced.
+		while ((*m_dataAcquisition)->collectStreamingBlock(lockSettings.samplesPerUpdate, m_blockValues)) {
+			m_sampleClockSamples += lockSettings.samplesPerUpdate;
+			auto passed = std::chrono::duration<double>(m_sampleClockSamples / m_sampleClockRate);
+			auto now = m_sampleClockStart + std::chrono::duration_cast<std::chrono::system_clock::duration>(passed);
+			updateLock(m_blockValues, now);
+			updated = true;
+		}
+	} else {
+		(*m_dataAcquisition)->collectBlockData(m_blockValues);
+
+		std::chrono::time_point<std::chrono::system_clock> now;
+		if (lockSettings.pipelined) {
+			// The block was captured when it was started, not when we read it
+			now = (*m_dataAcquisition)->getBlockStartTime();
+			// Start the capture of the next block, so it runs while
+			// we process this block and set the laser temperature
+			(*m_dataAcquisition)->startCollectingBlockData();
+		} else {
+			now = Clock::get()->now();
+		}
+		updateLock(m_blockValues, now);
+		updated = true;
+	}
+
+	lockingTimerMonitor.tickFinished();
+	// Notifying the views allocates the queued events, so it is not part of the tick.
+	if (updated) {
+		emit locked();
+	}
+	emit timingStatisticsChanged(lockingTimerMonitor.getStatistics());
+}
+
+/*
+ * Sets the output of the DAQ to the voltage corresponding to the controller output.
+ * The voltage is clamped to the configured limits. When clamped, the controller output
+ * is set back to the limit as well and the integral stops integrating into the limit,
+ * so neither winds up. The DAQ may live on another thread, the call is queued then.
+ */
+double Locking::setAnalogOutput(double &output) {
+	double voltage = lockSettings.analogOffset + lockSettings.analogScaling * output;
+	bool saturated{ false };
+	if (voltage > lockSettings.analogMaxVoltage) {
+		voltage = lockSettings.analogMaxVoltage;
+		saturated = true;
+	} else if (voltage < lockSettings.analogMinVoltage) {
+		voltage = lockSettings.analogMinVoltage;
+		saturated = true;
+	}
+	m_outputSaturation = 0;
+	if (saturated && lockSettings.analogScaling != 0) {
+		double limit = (voltage - lockSettings.analogOffset) / lockSettings.analogScaling;
+		m_outputSaturation = (output > limit) ? 1 : -1;
+		output = limit;
+	}
+	daq *acquisition = *m_dataAcquisition;
+	if (acquisition) {
+		QMetaObject::invokeMethod(acquisition, [acquisition, voltage]() {
+			acquisition->setOutputVoltage(voltage);
+		}, Qt::AutoConnection);
+	}
+	m_outputVoltage = voltage;
+	return voltage;
+}
 
-	std::chrono::time_point<std::chrono::system_clock> now = std::chrono::system_clock::now();
+/*
+ * Splits the total offset complementarily at the crossover frequency: the temperature
+ * follows the low-pass filtered total offset and the analog output takes the high-pass
+ * remainder, so it stays centred within its narrow range. The temperature moves at no
+ * more than the desaturation rate, the analog output takes the lag. The split keeps the
+ * sum of both offsets constant.
+ */
+void Locking::desaturate(double dt) {
+	if (dt <= 0) {
+		return;
+	}
+	double total = lockData.currentTempOffset + lockData.fastOffset;
+	lockData.offsetMean = generalmath::lowpass(lockData.offsetMean, total, lockSettings.crossoverFrequency, dt);
+
+	double maxTransfer = lockSettings.desaturationRate * dt;
+	double transfer = lockData.offsetMean - lockData.currentTempOffset;
+	transfer = (transfer > maxTransfer) ? maxTransfer : transfer;
+	transfer = (transfer < -maxTransfer) ? -maxTransfer : transfer;
 
+	lockData.currentTempOffset += transfer;
+	lockData.fastOffset = total - lockData.currentTempOffset;
+}
+
+void Locking::updateLock(std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> &values, std::chrono::time_point<std::chrono::system_clock> now) {
 	double absorption_mean = generalmath::mean(values[0]) / 1e3;
 	double reference_mean = generalmath::mean(values[1]) / 1e3;
 	double quotient_mean = abs(absorption_mean / reference_mean);
@@ -185,33 +539,86 @@ void Locking::lock() {
 		lockData.quotient_max = quotient_max;
 	}
 
-	lockData.transmission = lockData.quotient;
-	std::for_each(lockData.transmission.begin(), lockData.transmission.end(), [this](double &el) {el /= lockData.quotient_max; });
+	// the transmission is written in place, it has the size of the quotient
+	std::transform(lockData.quotient.begin(), lockData.quotient.end(), lockData.transmission.begin(), [this](double el) {return el / lockData.quotient_max; });
 
 	double error = lockData.transmission[lockData.nextIndex] - lockSettings.transmissionSetpoint;
 
+	// The ticks are not equally spaced, so we always use the actual time step
+	auto prevIndex = generalmath::indexWrapped((int)lockData.nextIndex - 1, lockData.storageSize);
+	double dt{ 0 };
+	double dError{ 0 };
+	// the time since the last run before (re)starting is no valid time step
+	if (!m_firstUpdate && (lockData.nextIndex > 0 || lockData.wrapped)) {
+		dt = std::chrono::duration_cast<std::chrono::microseconds>(now - lockData.time[prevIndex]).count() / 1e6;
+		if (dt > 0) {
+			dError = (error - lockData.error[prevIndex]) / dt;
+		}
+	}
+
 	// write data to struct for storage
 	double actualTempOffset;
 	if (lockSettings.state == LOCKSTATE::ACTIVE) {
-		double dError = 0;
-		if (lockData.error.size() > 0) {
-			auto prevIndex = generalmath::indexWrapped((int)lockData.nextIndex - 1, lockData.storageSize);
-			double dt = std::chrono::duration_cast<std::chrono::milliseconds>(now - lockData.time[prevIndex]).count() / 1e3;
-			lockData.iError += lockSettings.integral / 10 * ( lockData.error.back() + error ) * (dt) / 2;
-			dError = (error - lockData.error[prevIndex]) / dt;
+		if (dt > 0) {
+			double dIError = lockSettings.integral / 10 * (lockData.error.back() + error) * dt / 2;
+			// conditional integration, the integral does not grow while the analog output is clamped in its direction
+			bool windup = (m_outputSaturation > 0 && dIError > 0) || (m_outputSaturation < 0 && dIError < 0);
+			if (lockSettings.actuator == LOCKACTUATOR::TEMPERATURE || !windup) {
+				lockData.iError += dIError;
+			}
 		}
-		lockData.currentTempOffset = lockData.currentTempOffset + (lockSettings.proportional / 10 * error + lockData.iError + lockSettings.derivative * dError);
-
-		// abort locking if current absolute value of the temperature offset is above 5.0
-		if (abs(lockData.currentTempOffset) > 5.0) {
-			setLockState(LOCKSTATE::FAILURE);
+		double correction = lockSettings.proportional / 10 * error + lockData.iError + lockSettings.derivative * dError;
+
+		if (lockSettings.actuator == LOCKACTUATOR::DUAL) {
+			// the analog output takes the full correction, the temperature only follows its mean
+			lockData.fastOffset += correction;
+			desaturate(dt);
+			setAnalogOutput(lockData.fastOffset);
+
+			// abort locking if current absolute value of the temperature offset is above 5.0
+			if (abs(lockData.currentTempOffset) > 5.0) {
+				setLockState(LOCKSTATE::FAILURE);
+			}
+
+			// the temperature changes slowly, so we only write setpoints the laser resolves, or any
+			// setpoint while the temperature is unknown, e.g. after a reconnect without status polling
+			double lastTemperature = m_laserControl->getLastTemperature();
+			if (std::isnan(lastTemperature) || abs(lockData.currentTempOffset - lastTemperature) >= 0.001) {
+				m_laserControl->post(LQT_COMMAND::SETTEMPERATURE, lockData.currentTempOffset, LQT_PRIORITY::CONTROL);
+			}
+		} else if (lockSettings.actuator == LOCKACTUATOR::ANALOG) {
+			lockData.currentTempOffset += correction;
+			// the output is applied within this tick, so the loop does not wait for the serial line
+			setAnalogOutput(lockData.currentTempOffset);
+
+			// abort locking if current absolute value of the controller output is above 5.0
+			if (abs(lockData.currentTempOffset) > 5.0) {
+				setLockState(LOCKSTATE::FAILURE);
+			}
+			m_laserControl->refreshTemperature(LQT_PRIORITY::STATUS);
+		} else {
+			lockData.currentTempOffset += correction;
+
+			// abort locking if current absolute value of the temperature offset is above 5.0
+			if (abs(lockData.currentTempOffset) > 5.0) {
+				setLockState(LOCKSTATE::FAILURE);
+			}
+
+			// set laser temperature, the request is queued and a pending older setpoint is replaced
+			m_laserControl->post(LQT_COMMAND::SETTEMPERATURE, lockData.currentTempOffset, LQT_PRIORITY::CONTROL);
 		}
-
-		// set laser temperature
-		actualTempOffset = m_laserControl->setTemperatureForce(lockData.currentTempOffset);
 	} else {
-		actualTempOffset = m_laserControl->getTemperature();
+		m_laserControl->refreshTemperature(LQT_PRIORITY::STATUS);
+	}
+	// Never wait for the serial line, store the last temperature offset the laser reported.
+	// A temperature which arrived since the previous update answers the request of that update,
+	// so it replaces the value stored with it.
+	std::chrono::steady_clock::time_point temperatureUpdated;
+	actualTempOffset = m_laserControl->getLastTemperature(temperatureUpdated);
+	if (!m_firstUpdate && (lockData.nextIndex > 0 || lockData.wrapped) && temperatureUpdated > m_temperatureRequested) {
+		lockData.tempOffset[prevIndex] = actualTempOffset;
 	}
+	m_temperatureRequested = std::chrono::steady_clock::now();
 
 	// write data to struct for storage
 	lockData.time[lockData.nextIndex] = now;
@@ -219,7 +626,22 @@ void Locking::lock() {
 	lockData.absorption[lockData.nextIndex] = absorption_mean;
 	lockData.reference[lockData.nextIndex] = reference_mean;
 	lockData.tempOffset[lockData.nextIndex] = actualTempOffset;
+	lockData.outputVoltage[lockData.nextIndex] = m_outputVoltage;
+	if (m_sharedRing) {
+		auto record = static_cast<SHARED_LOCK_RECORD *>(m_sharedRing->beginWrite());
+		record->time = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
+		record->tempOffset = actualTempOffset;
+		record->transmission = lockData.transmission[lockData.nextIndex];
+		record->error = error;
+		record->outputVoltage = m_outputVoltage;
+		record->absorption = absorption_mean;
+		record->reference = reference_mean;
+		record->quotient = quotient_mean;
+		record->state = lockSettings.state;
+		m_sharedRing->endWrite();
+	}
 	lockData.nextIndex++;
+	m_firstUpdate = false;
 
 	// If the next index to write to is outside of the array, we wrap around to the start
 	if (lockData.nextIndex >= lockData.storageSize) {
@@ -227,7 +649,36 @@ void Locking::lock() {
 		lockData.wrapped = true;
 	}
 
-	emit locked();
+	// the timer only polls the device when the updates are paced by the sample clock
+	if (lockSettings.adaptive && m_timebase == LOCKTIMEBASE::HOSTTIMER) {
+		adaptLockingTimeout(error, dError);
+	}
+}
+
+// Speeds the lock loop up as soon as the error or its rate of change is large
+// and slows it down again after the error was small for a while.
+void Locking::adaptLockingTimeout(double error, double dError) {
+	int timeout = m_lockingTimeout;
+	if (abs(error) > lockSettings.fastErrorThreshold || abs(dError) > lockSettings.fastErrorRateThreshold) {
+		m_stableTicks = 0;
+		timeout = (int)(timeout / lockSettings.adaptiveFactor);
+	} else if (abs(error) < lockSettings.stableErrorThreshold) {
+		if (++m_stableTicks >= lockSettings.stableTicks) {
+			m_stableTicks = 0;
+			timeout = (int)(timeout * lockSettings.adaptiveFactor);
+		}
+	} else {
+		m_stableTicks = 0;
+	}
+	timeout = (timeout < lockSettings.minLockingTimeout) ? lockSettings.minLockingTimeout : timeout;
+	timeout = (timeout > lockSettings.maxLockingTimeout) ? lockSettings.maxLockingTimeout : timeout;
+
+	if (timeout != m_lockingTimeout) {
+		m_lockingTimeout = timeout;
+		lockingTimer->setInterval(m_lockingTimeout);
+		lockingTimerMonitor.setPeriod(m_lockingTimeout);
+		emit lockingTimeoutChanged(m_lockingTimeout);
+	}
 }
 
 void Locking::init() {
@@ -235,13 +686,13 @@ void Locking::init() {
 	// after moving locking to another thread
 	lockingTimer = new QTimer();
 	scanTimer = new QTimer();
-	QMetaObject::Connection connection = QWidget::connect(
+	QMetaObject::Connection connection = QObject::connect(
 		lockingTimer,
 		&QTimer::timeout,
 		this,
 		&Locking::lock
 	);
-	connection = QWidget::connect(
+	connection = QObject::connect(
 		scanTimer,
 		&QTimer::timeout,
 		this,
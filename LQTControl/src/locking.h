@@ -1,17 +1,22 @@
 #ifndef LOCKING_H
 #define LOCKING_H
 
-#include <QMainWindow>
-#include <QtCore/QObject>
-#include <QtWidgets>
+#include <QtCore>
 #include <vector>
 #include <array>
 #include <chrono>
 #include <ctime>
+#include <atomic>
 
-#include "Devices\daq.h"
-#include "Devices\LQT.h"
+#include "Devices/daq.h"
+#include "Devices/LQT.h"
 #include "generalmath.h"
+#include "timerMonitor.h"
+#include "clock.h"
+#include "sharedRingWriter.h"
+
+#define LOCK_MAX_STORAGE_SIZE	288000	// maximum number of stored lock updates, e.g. four hours at 50 ms
+#define SCAN_MAX_STEPS			10000	// maximum number of steps of a scan
 
 typedef struct SCAN_SETTINGS {
 	double low{ -5 };		// [K] offset start
@@ -38,6 +43,17 @@ typedef enum enLockState {
 	FAILURE
 } LOCKSTATE;
 
+typedef enum enLockTimebase {
+	HOSTTIMER,		// a timer on the host triggers the updates
+	SAMPLECLOCK		// every update processes a fixed number of samples streamed by the device
+} LOCKTIMEBASE;
+
+typedef enum enLockActuator {
+	TEMPERATURE,	// the temperature offset of the laser is set over the serial line
+	ANALOG,			// the output of the DAQ drives a modulation input of the laser
+	DUAL			// the analog output corrects fast errors, the temperature follows its mean
+} LOCKACTUATOR;
+
 typedef struct LOCK_SETTINGS {
 	double proportional{ 0.007 };			//		control parameter of the proportional part
 	double integral{ 0.000 };				//		control parameter of the integral part
@@ -45,6 +61,25 @@ typedef struct LOCK_SETTINGS {
 	int lockingTimeout{ 100 };				// [ms]	time until next locking run
 	LOCKSTATE state{ LOCKSTATE::INACTIVE };	//		locking enabled?
 	double transmissionSetpoint{ 0.5 };		//	[1]	target transmission setpoint
+	bool pipelined{ false };				//		start the next capture before the current block is processed
+	bool adaptive{ false };					//		adapt the locking timeout to the error signal
+	int minLockingTimeout{ 50 };			// [ms]	minimum time until next locking run in adaptive mode
+	int maxLockingTimeout{ 1000 };			// [ms]	maximum time until next locking run in adaptive mode
+	double fastErrorThreshold{ 0.05 };		// [1]	absolute error above which the locking is sped up
+	double fastErrorRateThreshold{ 0.2 };	// [1/s]	absolute rate of change of the error above which the locking is sped up
+	double stableErrorThreshold{ 0.01 };	// [1]	absolute error below which the locking is slowed down
+	int stableTicks{ 20 };					//		number of stable runs before the locking is slowed down
+	double adaptiveFactor{ 2 };				// [1]	factor by which the locking timeout is changed
+	LOCKTIMEBASE timebase{ LOCKTIMEBASE::HOSTTIMER };	//	what paces the updates
+	uint32_t samplesPerUpdate{ 10000 };		//		number of samples processed per update when paced by the sample clock
+	int pollingTimeout{ 5 };				// [ms]	time until the device is polled for new samples when paced by the sample clock
+	LOCKACTUATOR actuator{ LOCKACTUATOR::TEMPERATURE };	//	what the controller output drives
+	double analogScaling{ 1.0 };			// [V/K]	output voltage per controller output
+	double analogOffset{ 0.0 };				// [V]	output voltage for a controller output of zero
+	double analogMinVoltage{ -2.0 };		// [V]	minimum output voltage
+	double analogMaxVoltage{ 2.0 };			// [V]	maximum output voltage
+	double crossoverFrequency{ 0.1 };		// [Hz]	frequency below which the temperature takes over from the analog output
+	double desaturationRate{ 0.01 };		// [K/s]	maximum rate at which the mean of the analog output is moved to the temperature
 } LOCK_SETTINGS;
 
 typedef struct LOCK_DATA {
@@ -56,11 +91,14 @@ typedef struct LOCK_DATA {
 	std::vector<double> quotient;		// [1]	quotient of absorption and reference
 	std::vector<double> transmission;	// [1]	transmission behind cell, i.e. the quotient normalized to maximum quotient
 	std::vector<double> error;			// [1]	PDH error signal
+	std::vector<double> outputVoltage;	// [V]	output voltage of the DAQ when locking with the analog actuator
 	double quotient_max{ 0 };			// [1]	the maximum measured quotient
 	double iError{ 0 };					// [1]	integral value of the error signal
 	double currentTempOffset{ 0 };		// [K] current temperature offset
+	double fastOffset{ 0 };				// [K]	offset applied by the analog output in dual actuator mode
+	double offsetMean{ 0 };				// [K]	low-pass filtered sum of the temperature and the analog offset in dual actuator mode
 	int storageDuration{ 4 * 3600 };	// [s]	maximum time to store data for (after this time, data from the start will be overwritten)
-	int storageSize;					//		size of the storage array (depends on storageDuration and lockSettings.lockingTimeout)
+	int storageSize{ 0 };				//		size of the storage array (depends on storageDuration and the (minimum) locking timeout, at most LOCK_MAX_STORAGE_SIZE)
 	gsl::index nextIndex{ 0 };			//		the index to write to next
 	bool wrapped{ false };				//		Whether we already wrapped once (and now use the full vector)
 	std::chrono::time_point<std::chrono::system_clock> startTime;
@@ -100,7 +138,23 @@ typedef enum enLockParameters {
 	P,
 	I,
 	D,
-	SETPOINT
+	SETPOINT,
+	PIPELINED,
+	ADAPTIVE,
+	MINTIMEOUT,
+	MAXTIMEOUT,
+	FASTERROR,
+	FASTERRORRATE,
+	STABLEERROR,
+	TIMEBASE,
+	SAMPLESPERUPDATE,
+	ACTUATOR,
+	ANALOGSCALING,
+	ANALOGOFFSET,
+	ANALOGMIN,
+	ANALOGMAX,
+	CROSSOVER,
+	DESATURATIONRATE
 } LOCKPARAMETERS;
 
 class Locking : public QObject {
@@ -109,11 +163,18 @@ class Locking : public QObject {
 	public:
 		explicit Locking(QObject *parent, daq **dataAcquisition, LQT *laserControl);
 		void setLockState(LOCKSTATE lockstate = LOCKSTATE::INACTIVE);
-		void setScanParameters(SCANPARAMETERS type, double value);
-		void setLockParameters(LOCKPARAMETERS type, double value);
+		bool setScanParameters(SCANPARAMETERS type, double value);
+		bool setLockParameters(LOCKPARAMETERS type, double value);
+		// sets both limits of the output voltage, so a new range need not overlap the old one
+		bool setAnalogRange(double minVoltage, double maxVoltage);
 		SCAN_SETTINGS getScanSettings();
 		SCAN_DATA scanData;
 		LOCK_SETTINGS getLockSettings();
+		int getLockingTimeout();
+		bool getAcquireLockingRunning();
+		// every update is also written to this ring, has to be set before the lock is moved to its thread
+		void setSharedRing(SharedRingWriter *ring);
+		gsl::index getNumberOfSamples(double duration);
 
 		LOCK_DATA lockData;
 
@@ -130,9 +191,32 @@ class Locking : public QObject {
 		bool m_isAcquireLockingRunning{ false };
 		QTimer* lockingTimer{ nullptr };
 		QTimer* scanTimer{ nullptr };
-		QElapsedTimer passTimer;
+		std::chrono::time_point<std::chrono::system_clock> passStart;	// time the current scan step was started
 		SCAN_SETTINGS scanSettings;
 		LOCK_SETTINGS lockSettings;
+		int m_lockingTimeout{ lockSettings.lockingTimeout };	// [ms]	currently used locking timeout
+		int m_stableTicks{ 0 };		//		number of consecutive runs with a small error
+		LOCKTIMEBASE m_timebase{ LOCKTIMEBASE::HOSTTIMER };	//	what paces the currently running updates
+		std::chrono::time_point<std::chrono::system_clock> m_sampleClockStart;	// time the streaming was started
+		double m_sampleClockRate{ 0 };			// [Hz]	sampling rate used for streaming
+		uint64_t m_sampleClockSamples{ 0 };		//		number of samples processed since the streaming was started
+		bool m_firstUpdate{ true };				//		whether this is the first update after starting the locking
+		bool m_engaging{ false };				//		whether the lock waits for the temperature offset to start from
+		std::atomic<bool> m_engageReady{ false };		//		whether the laser reported the temperature offset to start from
+		std::atomic<double> m_engageTemperature{ NAN };	// [K]	temperature offset to start from, set on the serial thread
+		std::chrono::steady_clock::time_point m_temperatureRequested;	// time the previous update asked the laser for its temperature
+		double m_outputVoltage{ 0 };			// [V]	output voltage of the analog actuator
+		int m_outputSaturation{ 0 };			//		direction the analog output is clamped to, +1 above the range, -1 below it, 0 not clamped
+		std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> m_blockValues;	// [mV]	samples of the current update, kept so their buffers are reused
+		SharedRingWriter *m_sharedRing{ nullptr };
+		void engage(double temperature);
+		double setAnalogOutput(double &output);
+		void desaturate(double dt);
+		void resizeStorage();
+		void adaptLockingTimeout(double error, double dError);
+		void updateLock(std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> &values, std::chrono::time_point<std::chrono::system_clock> now);
+		TimerMonitor lockingTimerMonitor{ TIMERS::LOCKINGTIMER, lockSettings.lockingTimeout };
+		TimerMonitor scanTimerMonitor{ TIMERS::SCANTIMER, 1000 };
 
 	private slots:
 		void lock();
@@ -144,6 +228,8 @@ class Locking : public QObject {
 		void s_acquireLockingRunning(bool);
 		void locked();
 		void lockStateChanged(LOCKSTATE);
+		void timingStatisticsChanged(TIMER_STATISTICS);
+		void lockingTimeoutChanged(int);
 };
 
 #endif // LOCKING_H
\ No newline at end of file
@@ -14,6 +14,7 @@
 #include <QtCharts/QLegendMarker>
 #include <QtCharts/QXYLegendMarker>
 #include "version.h"
+#include "lockView.h"
 
 MainWindow::MainWindow(QWidget *parent) noexcept :
 	QMainWindow(parent), ui(new Ui::MainWindow) {
@@ -32,6 +33,11 @@ MainWindow::MainWindow(QWidget *parent) noexcept :
 	qRegisterMetaType<ACQUISITION_PARAMETERS>("ACQUISITION_PARAMETERS");
 	qRegisterMetaType<LOCKSTATE>("LOCKSTATE");
 	qRegisterMetaType<LQT_SETTINGS>("LQT_SETTINGS");
+	qRegisterMetaType<TIMER_STATISTICS>("TIMER_STATISTICS");
+	qRegisterMetaType<THREAD_SETTINGS>("THREAD_SETTINGS");
+	qRegisterMetaType<COMMAND_STATISTICS>("COMMAND_STATISTICS");
+	qRegisterMetaType<PRIORITY_STATISTICS>("PRIORITY_STATISTICS");
+	qRegisterMetaType<VERIFICATION_STATISTICS>("VERIFICATION_STATISTICS");
 
 	// slot laser connection
 	static QMetaObject::Connection connection = QWidget::connect(
@@ -84,6 +90,13 @@ MainWindow::MainWindow(QWidget *parent) noexcept :
 		this,
 		&MainWindow::updateLockState
 	);
+
+	connection = QWidget::connect(
+		m_lockingControl,
+		&Locking::timingStatisticsChanged,
+		this,
+		&MainWindow::updateTimingStatistics
+	);
 	
 	// set up live view plots
 	liveViewPlots.resize(static_cast<int>(liveViewPlotTypes::COUNT));
@@ -238,6 +251,13 @@ MainWindow::MainWindow(QWidget *parent) noexcept :
 	statusInfo->setAlignment(Qt::AlignVCenter | Qt::AlignLeft);
 	ui->statusBar->addPermanentWidget(statusInfo, 1);
 
+	// Timing info, only shown if a timer cannot keep its rate
+	timingInfo = new QLabel("");
+	timingInfo->setAlignment(Qt::AlignVCenter | Qt::AlignRight);
+	timingInfo->setStyleSheet(QString("QLabel { color: rgb(246, 12, 0); }"));
+	timingInfo->hide();
+	ui->statusBar->addPermanentWidget(timingInfo, 0);
+
 	// Locking info
 	lockInfo = new QLabel("Locking Inactive");
 	lockInfo->setAlignment(Qt::AlignVCenter | Qt::AlignRight);
@@ -257,12 +277,51 @@ MainWindow::MainWindow(QWidget *parent) noexcept :
 	ui->floatingViewLabel->hide();
 	ui->floatingViewCheckBox->hide();
 
+	// e.g. LQTCONTROL_SHARED_RING=lqtcontrol exports the live blocks to lqtcontrol-live and the lock updates to lqtcontrol-lock
+	if (qEnvironmentVariableIsSet("LQTCONTROL_SHARED_RING")) {
+		auto name = qEnvironmentVariable("LQTCONTROL_SHARED_RING").toStdString();
+		if (!m_liveRing.openLive(name + "-live", 64, DAQ_MAX_CHANNELS, DAQ_BUFFER_SIZE)) {
+			qWarning() << "Could not create the shared live ring:" << QString::fromStdString(m_liveRing.errorString());
+		}
+		if (m_lockRing.openLock(name + "-lock", 65536)) {
+			m_lockingControl->setSharedRing(&m_lockRing);
+		} else {
+			qWarning() << "Could not create the shared lock ring:" << QString::fromStdString(m_lockRing.errorString());
+		}
+	}
+
+	// connected before initDAQ() starts the thread, so its first report is not lost
+	connection = QWidget::connect(
+		&m_acquisitionThread,
+		&Thread::settingsApplied,
+		this,
+		&MainWindow::threadSettingsApplied
+	);
+
+	connection = QWidget::connect(
+		&m_serialThread,
+		&Thread::settingsApplied,
+		this,
+		&MainWindow::threadSettingsApplied
+	);
+
 	initDAQ();
 	initSettingsDialog();
 
-	// start acquisition thread
+	// start acquisition and serial thread
 	m_acquisitionThread.startWorker(m_lockingControl);
-	m_acquisitionThread.startWorker(m_laserControl);
+	m_serialThread.startWorker(m_laserControl);
+
+	// The GUI thread renders the plots and should not compete with the lock loop. It is only
+	// lowered once the workers started, a new thread inherits the nice value of its creator
+	// and an unprivileged process cannot raise the priority of a thread again.
+	threadSettingsApplied(applyThreadSettings(getDefaultThreadSettings(THREAD_ROLE::RENDER)));
+
+	// e.g. LQTCONTROL_IPC_SERVER=lqtcontrol lets other programs control the lock and subscribe to its data
+	if (qEnvironmentVariableIsSet("LQTCONTROL_IPC_SERVER")) {
+		m_ipcServer = new IpcServer(this, &m_dataAcquisition, m_lockingControl, m_laserControl);
+		m_ipcServer->listen(qEnvironmentVariable("LQTCONTROL_IPC_SERVER"));
+	}
 
 	QMetaObject::invokeMethod(m_laserControl, &LQT::connect, Qt::AutoConnection);
 }
@@ -274,6 +333,8 @@ MainWindow::~MainWindow() {
 	}
 	m_acquisitionThread.exit();
 	m_acquisitionThread.wait();
+	m_serialThread.exit();
+	m_serialThread.wait();
 	delete ui;
 }
 
@@ -296,10 +357,16 @@ void MainWindow::initDAQ() {
 	case PS_TYPES::MODEL_PS2000A:
 		m_dataAcquisition = new daq_PS2000A(nullptr);
 		break;
+	case PS_TYPES::MODEL_SYNTHETIC:
+		m_dataAcquisition = new daq_Synthetic(nullptr);
+		break;
 	default:
 		m_dataAcquisition = new daq_PS2000(nullptr);
 		break;
 	}
+	if (m_liveRing.isOpen()) {
+		m_dataAcquisition->setSharedRing(&m_liveRing);
+	}
 
 	m_acquisitionThread.startWorker(m_dataAcquisition);
 
@@ -333,8 +400,19 @@ void MainWindow::initDAQ() {
 		&MainWindow::updateAcquisitionParameters
 	);
 
+	connection = QWidget::connect(
+		m_dataAcquisition,
+		&daq::timingStatisticsChanged,
+		this,
+		&MainWindow::updateTimingStatistics
+	);
+
 	updateSamplingRates();
 
+	if (m_ipcServer) {
+		m_ipcServer->acquisitionChanged();
+	}
+
 	QMetaObject::invokeMethod(m_dataAcquisition, &daq::connect, Qt::AutoConnection);
 }
 
@@ -393,13 +471,64 @@ void MainWindow::on_actionAbout_triggered() {
 
 void MainWindow::on_actionSettings_triggered() {
 	m_daqDropdown->setCurrentIndex((int)m_daqType);
+	LOCK_SETTINGS lockSettings = m_lockingControl->getLockSettings();
+	m_pipelinedCheckbox->setChecked(lockSettings.pipelined);
+	m_adaptiveCheckbox->setChecked(lockSettings.adaptive);
+	// the adaptive range has to contain the locking timeout it starts from
+	m_minTimeoutSpinBox->setRange(1, lockSettings.lockingTimeout);
+	m_maxTimeoutSpinBox->setRange(lockSettings.lockingTimeout, 10000);
+	m_minTimeoutSpinBox->setValue(lockSettings.minLockingTimeout);
+	m_maxTimeoutSpinBox->setValue(lockSettings.maxLockingTimeout);
+	m_fastErrorSpinBox->setValue(lockSettings.fastErrorThreshold);
+	m_fastErrorRateSpinBox->setValue(lockSettings.fastErrorRateThreshold);
+	m_stableErrorSpinBox->setValue(lockSettings.stableErrorThreshold);
+	m_timebaseDropdown->setCurrentIndex((int)lockSettings.timebase);
+	m_samplesPerUpdateSpinBox->setValue(lockSettings.samplesPerUpdate);
+	m_actuatorDropdown->setCurrentIndex((int)lockSettings.actuator);
+	m_analogScalingSpinBox->setValue(lockSettings.analogScaling);
+	m_analogOffsetSpinBox->setValue(lockSettings.analogOffset);
+	m_analogMinSpinBox->setValue(lockSettings.analogMinVoltage);
+	m_analogMaxSpinBox->setValue(lockSettings.analogMaxVoltage);
+	m_crossoverSpinBox->setValue(lockSettings.crossoverFrequency);
+	m_desaturationRateSpinBox->setValue(lockSettings.desaturationRate);
+	THREAD_SETTINGS threadSettings = m_acquisitionThread.getSettings();
+	m_controlCPUSpinBox->setValue(threadSettings.cpu);
+	m_realtimeCheckbox->setChecked(threadSettings.realtime);
+	m_lockMemoryCheckbox->setChecked(threadSettings.lockMemory);
 	settingsDialog->show();
 }
 
 void MainWindow::saveSettings() {
-	m_daqType = m_daqTypeTemporary;
+	m_lockingControl->setLockParameters(LOCKPARAMETERS::PIPELINED, m_pipelinedCheckbox->isChecked());
+	m_lockingControl->setLockParameters(LOCKPARAMETERS::ADAPTIVE, m_adaptiveCheckbox->isChecked());
+	m_lockingControl->setLockParameters(LOCKPARAMETERS::MINTIMEOUT, m_minTimeoutSpinBox->value());
+	m_lockingControl->setLockParameters(LOCKPARAMETERS::MAXTIMEOUT, m_maxTimeoutSpinBox->value());
+	m_lockingControl->setLockParameters(LOCKPARAMETERS::FASTERROR, m_fastErrorSpinBox->value());
+	m_lockingControl->setLockParameters(LOCKPARAMETERS::FASTERRORRATE, m_fastErrorRateSpinBox->value());
+	m_lockingControl->setLockParameters(LOCKPARAMETERS::STABLEERROR, m_stableErrorSpinBox->value());
+	m_lockingControl->setLockParameters(LOCKPARAMETERS::TIMEBASE, m_timebaseDropdown->currentIndex());
+	m_lockingControl->setLockParameters(LOCKPARAMETERS::SAMPLESPERUPDATE, m_samplesPerUpdateSpinBox->value());
+	m_lockingControl->setLockParameters(LOCKPARAMETERS::ACTUATOR, m_actuatorDropdown->currentIndex());
+	m_lockingControl->setLockParameters(LOCKPARAMETERS::ANALOGSCALING, m_analogScalingSpinBox->value());
+	m_lockingControl->setLockParameters(LOCKPARAMETERS::ANALOGOFFSET, m_analogOffsetSpinBox->value());
+	if (!m_lockingControl->setAnalogRange(m_analogMinSpinBox->value(), m_analogMaxSpinBox->value())) {
+		LOCK_SETTINGS lockSettings = m_lockingControl->getLockSettings();
+		QMessageBox::warning(this, tr("Settings"), tr("The minimum output voltage has to be below the maximum, "
+			"the range stays at %1 V to %2 V.").arg(lockSettings.analogMinVoltage).arg(lockSettings.analogMaxVoltage));
+	}
+	m_lockingControl->setLockParameters(LOCKPARAMETERS::CROSSOVER, m_crossoverSpinBox->value());
+	m_lockingControl->setLockParameters(LOCKPARAMETERS::DESATURATIONRATE, m_desaturationRateSpinBox->value());
+	THREAD_SETTINGS threadSettings = m_acquisitionThread.getSettings();
+	threadSettings.cpu = m_controlCPUSpinBox->value();
+	threadSettings.realtime = m_realtimeCheckbox->isChecked();
+	threadSettings.lockMemory = m_lockMemoryCheckbox->isChecked();
+	m_acquisitionThread.setSettings(threadSettings);
 	settingsDialog->hide();
-	initDAQ();
+	// only reinitialize the DAQ if another device was selected
+	if (m_daqType != m_daqTypeTemporary) {
+		m_daqType = m_daqTypeTemporary;
+		initDAQ();
+	}
 }
 
 void MainWindow::cancelSettings() {
@@ -446,6 +575,169 @@ void MainWindow::initSettingsDialog() {
 		&MainWindow::selectDAQ
 	);
 
+	QGroupBox *lockBox = new QGroupBox();
+	lockBox->setTitle("Locking");
+	lockBox->setMinimumWidth(400);
+
+	vLayout->addWidget(lockBox);
+
+	QVBoxLayout *lockLayout = new QVBoxLayout(lockBox);
+
+	m_pipelinedCheckbox = new QCheckBox("Capture the next block while processing the current one");
+	lockLayout->addWidget(m_pipelinedCheckbox);
+
+	m_adaptiveCheckbox = new QCheckBox("Adapt the locking rate to the error signal");
+	lockLayout->addWidget(m_adaptiveCheckbox);
+
+	QHBoxLayout *timeoutLayout = new QHBoxLayout();
+	lockLayout->addLayout(timeoutLayout);
+
+	QLabel *timeoutLabel = new QLabel("Locking timeout range [ms]");
+	timeoutLayout->addWidget(timeoutLabel);
+
+	// the ranges are set from the locking timeout whenever the dialog is shown
+	m_minTimeoutSpinBox = new QSpinBox();
+	timeoutLayout->addWidget(m_minTimeoutSpinBox);
+
+	m_maxTimeoutSpinBox = new QSpinBox();
+	timeoutLayout->addWidget(m_maxTimeoutSpinBox);
+
+	QHBoxLayout *thresholdLayout = new QHBoxLayout();
+	lockLayout->addLayout(thresholdLayout);
+
+	QLabel *fastErrorLabel = new QLabel("Speed up above error");
+	thresholdLayout->addWidget(fastErrorLabel);
+
+	m_fastErrorSpinBox = new QDoubleSpinBox();
+	m_fastErrorSpinBox->setRange(0, 1);
+	m_fastErrorSpinBox->setDecimals(3);
+	m_fastErrorSpinBox->setSingleStep(0.01);
+	thresholdLayout->addWidget(m_fastErrorSpinBox);
+
+	QLabel *fastErrorRateLabel = new QLabel("or rate [1/s]");
+	thresholdLayout->addWidget(fastErrorRateLabel);
+
+	m_fastErrorRateSpinBox = new QDoubleSpinBox();
+	m_fastErrorRateSpinBox->setRange(0, 100);
+	m_fastErrorRateSpinBox->setDecimals(3);
+	m_fastErrorRateSpinBox->setSingleStep(0.1);
+	thresholdLayout->addWidget(m_fastErrorRateSpinBox);
+
+	QLabel *stableErrorLabel = new QLabel("Slow down below error");
+	thresholdLayout->addWidget(stableErrorLabel);
+
+	m_stableErrorSpinBox = new QDoubleSpinBox();
+	m_stableErrorSpinBox->setRange(0, 1);
+	m_stableErrorSpinBox->setDecimals(3);
+	m_stableErrorSpinBox->setSingleStep(0.01);
+	thresholdLayout->addWidget(m_stableErrorSpinBox);
+
+	QHBoxLayout *timebaseLayout = new QHBoxLayout();
+	lockLayout->addLayout(timebaseLayout);
+
+	QLabel *timebaseLabel = new QLabel("Updates paced by");
+	timebaseLayout->addWidget(timebaseLabel);
+
+	m_timebaseDropdown = new QComboBox();
+	m_timebaseDropdown->insertItem((int)LOCKTIMEBASE::HOSTTIMER, "Host timer");
+	m_timebaseDropdown->insertItem((int)LOCKTIMEBASE::SAMPLECLOCK, "Sample clock");
+	timebaseLayout->addWidget(m_timebaseDropdown);
+
+	QLabel *samplesLabel = new QLabel("Samples per update");
+	timebaseLayout->addWidget(samplesLabel);
+
+	m_samplesPerUpdateSpinBox = new QSpinBox();
+	m_samplesPerUpdateSpinBox->setRange(1, 1000000);
+	timebaseLayout->addWidget(m_samplesPerUpdateSpinBox);
+
+	QHBoxLayout *actuatorLayout = new QHBoxLayout();
+	lockLayout->addLayout(actuatorLayout);
+
+	QLabel *actuatorLabel = new QLabel("Actuator");
+	actuatorLayout->addWidget(actuatorLabel);
+
+	m_actuatorDropdown = new QComboBox();
+	m_actuatorDropdown->insertItem((int)LOCKACTUATOR::TEMPERATURE, "Laser temperature");
+	m_actuatorDropdown->insertItem((int)LOCKACTUATOR::ANALOG, "DAQ analog output");
+	m_actuatorDropdown->insertItem((int)LOCKACTUATOR::DUAL, "Analog output and temperature");
+	actuatorLayout->addWidget(m_actuatorDropdown);
+
+	QLabel *scalingLabel = new QLabel("Scaling [V/K]");
+	actuatorLayout->addWidget(scalingLabel);
+
+	m_analogScalingSpinBox = new QDoubleSpinBox();
+	m_analogScalingSpinBox->setRange(-100, 100);
+	m_analogScalingSpinBox->setDecimals(3);
+	actuatorLayout->addWidget(m_analogScalingSpinBox);
+
+	QHBoxLayout *voltageLayout = new QHBoxLayout();
+	lockLayout->addLayout(voltageLayout);
+
+	QLabel *offsetLabel = new QLabel("Output offset [V]");
+	voltageLayout->addWidget(offsetLabel);
+
+	m_analogOffsetSpinBox = new QDoubleSpinBox();
+	m_analogOffsetSpinBox->setRange(-2, 2);
+	m_analogOffsetSpinBox->setDecimals(3);
+	voltageLayout->addWidget(m_analogOffsetSpinBox);
+
+	QLabel *limitsLabel = new QLabel("Output range [V]");
+	voltageLayout->addWidget(limitsLabel);
+
+	m_analogMinSpinBox = new QDoubleSpinBox();
+	m_analogMinSpinBox->setRange(-2, 2);
+	m_analogMinSpinBox->setDecimals(3);
+	voltageLayout->addWidget(m_analogMinSpinBox);
+
+	m_analogMaxSpinBox = new QDoubleSpinBox();
+	m_analogMaxSpinBox->setRange(-2, 2);
+	m_analogMaxSpinBox->setDecimals(3);
+	voltageLayout->addWidget(m_analogMaxSpinBox);
+
+	QHBoxLayout *dualLayout = new QHBoxLayout();
+	lockLayout->addLayout(dualLayout);
+
+	QLabel *crossoverLabel = new QLabel("Crossover [Hz]");
+	dualLayout->addWidget(crossoverLabel);
+
+	m_crossoverSpinBox = new QDoubleSpinBox();
+	m_crossoverSpinBox->setRange(0.001, 10);
+	m_crossoverSpinBox->setDecimals(3);
+	dualLayout->addWidget(m_crossoverSpinBox);
+
+	QLabel *desaturationLabel = new QLabel("Desaturation rate [K/s]");
+	dualLayout->addWidget(desaturationLabel);
+
+	m_desaturationRateSpinBox = new QDoubleSpinBox();
+	m_desaturationRateSpinBox->setRange(0, 1);
+	m_desaturationRateSpinBox->setDecimals(3);
+	dualLayout->addWidget(m_desaturationRateSpinBox);
+
+	QGroupBox *threadBox = new QGroupBox();
+	threadBox->setTitle("Control thread");
+	threadBox->setMinimumWidth(400);
+
+	vLayout->addWidget(threadBox);
+
+	QVBoxLayout *threadLayout = new QVBoxLayout(threadBox);
+
+	QHBoxLayout *cpuLayout = new QHBoxLayout();
+	threadLayout->addLayout(cpuLayout);
+
+	QLabel *cpuLabel = new QLabel("Pin to CPU core");
+	cpuLayout->addWidget(cpuLabel);
+
+	m_controlCPUSpinBox = new QSpinBox();
+	m_controlCPUSpinBox->setRange(-1, QThread::idealThreadCount() - 1);
+	m_controlCPUSpinBox->setSpecialValueText("Any");
+	cpuLayout->addWidget(m_controlCPUSpinBox);
+
+	m_realtimeCheckbox = new QCheckBox("Use real-time scheduling priority");
+	threadLayout->addWidget(m_realtimeCheckbox);
+
+	m_lockMemoryCheckbox = new QCheckBox("Lock memory to prevent paging");
+	threadLayout->addWidget(m_lockMemoryCheckbox);
+
 	QWidget *buttonWidget = new QWidget();
 	vLayout->addWidget(buttonWidget);
 
@@ -692,7 +984,7 @@ void MainWindow::on_transmission_valueChanged(const double value) {
 }
 
 void MainWindow::on_temperatureOffset_valueChanged(const double offset) {
-	QMetaObject::invokeMethod(m_laserControl, [&m_laserControl = m_laserControl, offset]() { m_laserControl->setTemperatureForce(offset); }, Qt::AutoConnection);
+	m_laserControl->setTemperatureAsync(offset, LQT_PRIORITY::USER);
 }
 
 void MainWindow::updateLiveView() {
@@ -756,66 +1048,8 @@ void MainWindow::updateScanView() {
 void MainWindow::updateLockView() {
 	if (m_selectedView == VIEWS::LOCK) {
 
-		auto prevIndex = generalmath::indexWrapped((int)m_lockingControl->lockData.nextIndex - 1, m_lockingControl->lockData.storageSize);
-		auto passed = std::chrono::duration_cast<std::chrono::milliseconds>(
-			m_lockingControl->lockData.time[prevIndex] - m_lockingControl->lockData.startTime
-			).count() / 1e3;
-
-
-		lockViewPlots[static_cast<int>(lockViewPlotTypes::ABSORPTION)]->append(
-			QPointF(passed, m_lockingControl->lockData.absorption[prevIndex])
-		);
-		lockViewPlots[static_cast<int>(lockViewPlotTypes::REFERENCE)]->append(
-			QPointF(passed, m_lockingControl->lockData.reference[prevIndex])
-		);
-
-		// Replace the transmission array in the correct order
-		auto transmission = QList<QPointF>{};
-		auto size{ 0 };
-		if (m_lockingControl->lockData.wrapped) {
-			size = m_lockingControl->lockData.storageSize;
-		} else {
-			size = m_lockingControl->lockData.nextIndex;
-		}
-		transmission.reserve(size);
-		if (m_lockingControl->lockData.wrapped) {
-			for (gsl::index i{ m_lockingControl->lockData.nextIndex }; i < m_lockingControl->lockData.storageSize; i++) {
-				auto time = std::chrono::duration_cast<std::chrono::milliseconds>(
-					m_lockingControl->lockData.time[i] - m_lockingControl->lockData.startTime
-				).count() / 1e3;
-				transmission.append(QPointF(time, m_lockingControl->lockData.transmission[i]));
-			}
-		}
-		for (gsl::index i{ 0 }; i < m_lockingControl->lockData.nextIndex; i++) {
-			auto time = std::chrono::duration_cast<std::chrono::milliseconds>(
-				m_lockingControl->lockData.time[i] - m_lockingControl->lockData.startTime
-			).count() / 1e3;
-			transmission.append(QPointF(time, m_lockingControl->lockData.transmission[i]));
-		}
-		lockViewPlots[static_cast<int>(lockViewPlotTypes::TRANSMISSION)]->replace(transmission);
-
-
-		lockViewPlots[static_cast<int>(lockViewPlotTypes::ERRORSIGNAL)]->append(
-			QPointF(passed, m_lockingControl->lockData.error[prevIndex])
-		);
-		lockViewPlots[static_cast<int>(lockViewPlotTypes::TEMPERATUREOFFSET)]->append(
-			QPointF(passed, m_lockingControl->lockData.tempOffset[prevIndex])
-		);
-
-		auto offset = m_lockingControl->lockData.storageSize - m_lockingControl->lockData.nextIndex;
-		lockViewPlots[static_cast<int>(lockViewPlotTypes::ERRORSIGNALMEAN)]->append(
-			QPointF(passed, generalmath::floatingMean(m_lockingControl->lockData.error, 50, offset))
-		);
-		lockViewPlots[static_cast<int>(lockViewPlotTypes::ERRORSIGNALSTD)]->append(
-			QPointF(passed, generalmath::floatingStandardDeviation(m_lockingControl->lockData.error, 50, offset))
-		);
-
-		// If there are more points than desired, remove the first one
-		foreach(QtCharts::QLineSeries *series, lockViewPlots) {
-			if (series->count() >= m_lockingControl->lockData.storageSize) {
-				series->remove(0);
-			}
-		}
+		// average over the last five seconds, the number of samples depends on the locking timeout
+		lockView::appendLatest(m_lockingControl->lockData, m_lockingControl->getNumberOfSamples(5.0), lockViewPlots, m_lockViewNextIndex);
 
 		auto minX = lockViewPlots[0]->at(0).x();
 		auto maxX = lockViewPlots[0]->at(lockViewPlots[0]->count() - 1).x();
@@ -844,6 +1078,8 @@ void MainWindow::updateAcquisitionParameters(ACQUISITION_PARAMETERS acquisitionP
 }
 
 void MainWindow::updateLaserSettings(LQT_SETTINGS settings) {
+	// the settings are polled periodically, showing them must not write them back to the laser
+	const QSignalBlocker blocker(ui->temperatureOffset);
 	ui->temperatureOffset->setValue(settings.temperature);
 	if (!settings.lock && !settings.lockEnabled && !settings.modEnabled) {
 		ui->enableTemperatureControlCheckbox->setChecked(true);
@@ -852,6 +1088,50 @@ void MainWindow::updateLaserSettings(LQT_SETTINGS settings) {
 	}
 }
 
+void MainWindow::updateTimingStatistics(TIMER_STATISTICS statistics) {
+	// Log every change of a timer's state, but only warn visibly for the lock loop
+	if (statistics.rateKept != m_timerRateKept[statistics.timer]) {
+		m_timerRateKept[statistics.timer] = statistics.rateKept;
+		if (!statistics.rateKept) {
+			qWarning("Timer %d cannot keep its period of %d ms: mean interval %.1f ms, jitter %.1f ms, last tick took %.1f ms.",
+				statistics.timer, statistics.period, statistics.meanInterval, statistics.jitter, statistics.lastDuration);
+		}
+	}
+	if (statistics.timer != TIMERS::LOCKINGTIMER) {
+		return;
+	}
+	// the lock loop should not allocate once it runs, report the first tick which does
+	if (statistics.allocatingTicks > 0 && m_lockingAllocatingTicks == 0) {
+		qWarning("The lock loop allocated %llu times on tick %llu.",
+			(unsigned long long)statistics.lastAllocations, (unsigned long long)statistics.ticks);
+	}
+	m_lockingAllocatingTicks = statistics.allocatingTicks;
+	if (statistics.rateKept) {
+		timingInfo->hide();
+		return;
+	}
+	timingInfo->setText(QString("Lock loop too slow: %1 ms instead of %2 ms (jitter %3 ms)")
+		.arg(statistics.meanInterval, 0, 'f', 0)
+		.arg(statistics.period)
+		.arg(statistics.jitter, 0, 'f', 1)
+	);
+	timingInfo->show();
+}
+
+void MainWindow::threadSettingsApplied(THREAD_SETTINGS settings) {
+	// Report what the thread actually got, the system may deny pinning or priorities
+	qInfo("Thread %d runs on CPU %d with %s priority %d (nice %d), memory %s.",
+		settings.role, settings.cpu, settings.realtime ? "real-time" : "normal", settings.priority,
+		settings.niceness, settings.lockMemory ? "locked" : "not locked");
+	if (settings.role == THREAD_ROLE::CONTROL) {
+		THREAD_SETTINGS requested = m_acquisitionThread.getSettings();
+		if ((requested.cpu >= 0 && requested.cpu != settings.cpu) || (requested.realtime && !settings.realtime)
+			|| (requested.lockMemory && !settings.lockMemory)) {
+			qWarning("The control thread did not get all requested settings, missing permissions?");
+		}
+	}
+}
+
 void MainWindow::on_scanButton_clicked() {
 	if (!m_lockingControl->scanData.m_running) {
 		QMetaObject::invokeMethod(m_lockingControl, &Locking::startScan, Qt::AutoConnection);
@@ -971,5 +1251,5 @@ void MainWindow::laserConnectionChanged(bool connected) {
 }
 
 void MainWindow::on_enableTemperatureControlCheckbox_clicked(const bool checked) {
-	QMetaObject::invokeMethod(m_laserControl, [&m_laserControl = m_laserControl, checked]() { m_laserControl->enableTemperatureControl(checked); }, Qt::AutoConnection);
+	m_laserControl->request(LQT_COMMAND::TEMPERATURECONTROL, checked, LQT_PRIORITY::USER);
 }
\ No newline at end of file
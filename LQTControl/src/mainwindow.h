@@ -8,8 +8,11 @@
 
 #include "Devices/DAQ_PS2000.h"
 #include "Devices/DAQ_PS2000A.h"
+#include "Devices/DAQ_Synthetic.h"
 #include "Devices/LQT.h"
+#include "ipcServer.h"
 #include "locking.h"
+#include "sharedRingWriter.h"
 #include "thread.h"
 
 namespace Ui {
@@ -84,6 +87,11 @@ typedef enum enViews {
 Q_DECLARE_METATYPE(ACQUISITION_PARAMETERS);
 Q_DECLARE_METATYPE(LOCKSTATE);
 Q_DECLARE_METATYPE(LQT_SETTINGS);
+Q_DECLARE_METATYPE(TIMER_STATISTICS);
+Q_DECLARE_METATYPE(THREAD_SETTINGS);
+Q_DECLARE_METATYPE(COMMAND_STATISTICS);
+Q_DECLARE_METATYPE(PRIORITY_STATISTICS);
+Q_DECLARE_METATYPE(VERIFICATION_STATISTICS);
 
 class MainWindow : public QMainWindow {
 	Q_OBJECT
@@ -151,6 +159,10 @@ private slots:
 
 	void updateLaserSettings(LQT_SETTINGS);
 
+	void updateTimingStatistics(TIMER_STATISTICS statistics);
+
+	void threadSettingsApplied(THREAD_SETTINGS settings);
+
 	void on_actionAbout_triggered();
 
 	void on_actionSettings_triggered();
@@ -172,6 +184,25 @@ private:
 	PS_TYPES m_daqTypeTemporary = m_daqType;
 	void initDAQ();
 	QComboBox *m_daqDropdown;
+	QCheckBox *m_pipelinedCheckbox;
+	QCheckBox *m_adaptiveCheckbox;
+	QSpinBox *m_minTimeoutSpinBox;
+	QSpinBox *m_maxTimeoutSpinBox;
+	QDoubleSpinBox *m_fastErrorSpinBox;
+	QDoubleSpinBox *m_fastErrorRateSpinBox;
+	QDoubleSpinBox *m_stableErrorSpinBox;
+	QComboBox *m_timebaseDropdown;
+	QSpinBox *m_samplesPerUpdateSpinBox;
+	QComboBox *m_actuatorDropdown;
+	QDoubleSpinBox *m_analogScalingSpinBox;
+	QDoubleSpinBox *m_analogOffsetSpinBox;
+	QDoubleSpinBox *m_analogMinSpinBox;
+	QDoubleSpinBox *m_analogMaxSpinBox;
+	QDoubleSpinBox *m_crossoverSpinBox;
+	QDoubleSpinBox *m_desaturationRateSpinBox;
+	QSpinBox *m_controlCPUSpinBox;
+	QCheckBox *m_realtimeCheckbox;
+	QCheckBox *m_lockMemoryCheckbox;
 
 	void updateSamplingRates();
 	std::string getSamplingRateString(double samplingRate);
@@ -180,20 +211,29 @@ private:
 	bool m_isLaserConnected = false;
 
     Ui::MainWindow *ui;
-	Thread m_acquisitionThread;
+	Thread m_acquisitionThread{ THREAD_ROLE::CONTROL };	// hosts the lock loop and the acquisition
+	Thread m_serialThread{ THREAD_ROLE::SERIAL };		// hosts the serial communication with the laser
 	QtCharts::QChart *liveViewChart;
 	QtCharts::QChart *lockViewChart;
 	QtCharts::QChart *scanViewChart;
 	QVector<QtCharts::QLineSeries *> liveViewPlots;
 	QVector<QtCharts::QLineSeries *> lockViewPlots;
+	gsl::index m_lockViewNextIndex{ 0 };	// index of the next lock value appended to the lock view
 	QVector<QtCharts::QLineSeries *> scanViewPlots;
+	// written from the acquisition thread, so they have to outlive it
+	SharedRingWriter m_liveRing;		// live blocks, only opened if LQTCONTROL_SHARED_RING is set
+	SharedRingWriter m_lockRing;		// lock updates, only opened if LQTCONTROL_SHARED_RING is set
 	LQT *m_laserControl = new LQT();
 	daq *m_dataAcquisition = nullptr;
 	Locking *m_lockingControl = new Locking(nullptr, &m_dataAcquisition, m_laserControl);;
+	IpcServer *m_ipcServer{ nullptr };	// local API for other programs, only created if LQTCONTROL_IPC_SERVER is set
 	VIEWS m_selectedView = VIEWS::LIVE;	// selection of the view
 	IndicatorWidget *lockIndicator;
 	QLabel *lockInfo;
 	QLabel *statusInfo;
+	QLabel *timingInfo;
+	bool m_timerRateKept[3]{ true, true, true };
+	uint64_t m_lockingAllocatingTicks{ 0 };
 	VIEW_SETTINGS viewSettings;
 };
 
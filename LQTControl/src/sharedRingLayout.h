@@ -0,0 +1,119 @@
+#ifndef SHAREDRINGLAYOUT_H
+#define SHAREDRINGLAYOUT_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Layout of the shared memory rings LQTControl exports its live blocks and lock updates to.
+ * It only depends on the standard library, so consumers can include it without Qt.
+ *
+ * A ring is a shared memory object (POSIX shm_open, a named file mapping on Windows) of
+ *
+ *   SHARED_RING_HEADER	at offset 0
+ *   slotCount slots		at offset dataOffset, each slotSize bytes
+ *
+ * A slot is a SHARED_RING_SLOT followed by the record, SHARED_LIVE_RECORD and its values
+ * or SHARED_LOCK_RECORD. Record n, counted from 0 since the writer opened the ring, is written
+ * to slot n % slotCount.
+ *
+ * There is a single writer and any number of readers, neither takes a lock:
+ *   - the writer sets the sequence of the slot to 2n + 1, writes the record, sets the sequence
+ *     to 2n + 2 and then sets published of the header to n + 1
+ *   - a reader loads published, reads the sequence of the slot of the record it wants, reads
+ *     the record in place and reads the sequence again. The record is valid if the sequence
+ *     was 2n + 2 both times, otherwise it was overwritten and has to be skipped.
+ * The sequences and published are 64 bit atomics, the rest is plain data in the byte order of
+ * the machine.
+ */
+
+#define SHARED_RING_MAGIC 0x5254514C	// "LQTR"
+#define SHARED_RING_VERSION 1
+#define SHARED_RING_ALIGNMENT 64
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "the rings need lock-free 64 bit atomics");
+
+typedef enum enSharedRingKind : uint32_t {
+	SHARED_RING_LIVE = 1,	// blocks of the live acquisition, or the streamed blocks while the lock is paced by the sample clock
+	SHARED_RING_LOCK = 2	// updates of the lock
+} SHARED_RING_KIND;
+
+typedef struct SHARED_RING_HEADER {
+	std::atomic<uint32_t> magic;		//		SHARED_RING_MAGIC once the header is complete
+	uint32_t version;					//		SHARED_RING_VERSION
+	uint32_t kind;						//		SHARED_RING_KIND
+	uint32_t slotCount;					//		number of slots
+	uint64_t slotSize;					// [B]	size of a slot including its SHARED_RING_SLOT
+	uint64_t dataOffset;				// [B]	offset of the first slot
+	uint32_t channels;					//		live ring: number of channels a slot holds
+	uint32_t maxSamples;				//		live ring: number of samples per channel a slot holds
+	std::atomic<uint64_t> published;	//		number of records written, the newest one is published - 1
+	uint8_t reserved[SHARED_RING_ALIGNMENT - 48];
+} SHARED_RING_HEADER;
+
+typedef struct SHARED_RING_SLOT {
+	std::atomic<uint64_t> sequence;		//		2n + 1 while record n is written, 2n + 2 once it is complete
+	uint64_t reserved;
+} SHARED_RING_SLOT;
+
+typedef struct SHARED_LIVE_RECORD {
+	int64_t time;						// [us]	start of the capture since the epoch
+	double samplingRate;				// [Hz]	sampling rate of the block
+	uint32_t channels;					//		number of channels, at most the channels of the ring
+	uint32_t samples;					//		number of values per channel, at most maxSamples
+	uint32_t enabled;					//		bit mask of the channels with values, the values of the others are undefined
+	uint32_t reserved;
+	// followed by channels * maxSamples int32 [mV] values, channel by channel
+} SHARED_LIVE_RECORD;
+
+typedef struct SHARED_LOCK_RECORD {
+	int64_t time;						// [us]	time of the update since the epoch
+	double tempOffset;					// [K]	temperature offset the laser reported
+	double transmission;				// [1]	transmission behind the cell
+	double error;						// [1]	error signal
+	double outputVoltage;				// [V]	output voltage of the analog actuator
+	double absorption;					//		mean of the absorption signal
+	double reference;					//		mean of the reference signal
+	double quotient;					// [1]	quotient of absorption and reference
+	uint32_t state;						//		LOCKSTATE
+	uint32_t reserved;
+} SHARED_LOCK_RECORD;
+
+static_assert(sizeof(SHARED_RING_HEADER) == SHARED_RING_ALIGNMENT, "the header has to fill its cache line");
+static_assert(sizeof(SHARED_RING_SLOT) == 16, "the slot header is 16 bytes");
+
+namespace sharedRing {
+	// size of a slot holding the given record, rounded up to the alignment
+	inline uint64_t slotSize(uint64_t recordSize) {
+		uint64_t size = sizeof(SHARED_RING_SLOT) + recordSize;
+		return (size + SHARED_RING_ALIGNMENT - 1) / SHARED_RING_ALIGNMENT * SHARED_RING_ALIGNMENT;
+	}
+
+	inline uint64_t liveRecordSize(uint32_t channels, uint32_t maxSamples) {
+		return sizeof(SHARED_LIVE_RECORD) + sizeof(int32_t) * (uint64_t)channels * maxSamples;
+	}
+
+	inline uint64_t mappingSize(const SHARED_RING_HEADER &header) {
+		return header.dataOffset + header.slotSize * header.slotCount;
+	}
+
+	inline SHARED_RING_SLOT *slot(void *mapping, const SHARED_RING_HEADER &header, uint64_t n) {
+		return reinterpret_cast<SHARED_RING_SLOT *>(static_cast<uint8_t *>(mapping) + header.dataOffset + (n % header.slotCount) * header.slotSize);
+	}
+
+	inline const SHARED_RING_SLOT *slot(const void *mapping, const SHARED_RING_HEADER &header, uint64_t n) {
+		return reinterpret_cast<const SHARED_RING_SLOT *>(static_cast<const uint8_t *>(mapping) + header.dataOffset + (n % header.slotCount) * header.slotSize);
+	}
+
+	// values of a channel of a live record
+	inline int32_t *liveValues(SHARED_LIVE_RECORD *record, uint32_t maxSamples, uint32_t channel) {
+		return reinterpret_cast<int32_t *>(record + 1) + (uint64_t)channel * maxSamples;
+	}
+
+	inline const int32_t *liveValues(const SHARED_LIVE_RECORD *record, uint32_t maxSamples, uint32_t channel) {
+		return reinterpret_cast<const int32_t *>(record + 1) + (uint64_t)channel * maxSamples;
+	}
+}
+
+#endif // SHAREDRINGLAYOUT_H
\ No newline at end of file
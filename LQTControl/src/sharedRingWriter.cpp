@@ -0,0 +1,151 @@
+#include "sharedRingWriter.h"
+
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+SharedRingWriter::SharedRingWriter() noexcept {}
+
+SharedRingWriter::~SharedRingWriter() {
+	close();
+}
+
+bool SharedRingWriter::openLive(const std::string &name, uint32_t slotCount, uint32_t channels, uint32_t maxSamples) {
+	return open(name, SHARED_RING_LIVE, slotCount, sharedRing::liveRecordSize(channels, maxSamples), channels, maxSamples);
+}
+
+bool SharedRingWriter::openLock(const std::string &name, uint32_t slotCount) {
+	return open(name, SHARED_RING_LOCK, slotCount, sizeof(SHARED_LOCK_RECORD), 0, 0);
+}
+
+bool SharedRingWriter::open(const std::string &name, SHARED_RING_KIND kind, uint32_t slotCount, uint64_t recordSize, uint32_t channels, uint32_t maxSamples) {
+	close();
+	if (slotCount < 1) {
+		m_errorString = "a ring needs at least one slot";
+		return false;
+	}
+	uint64_t slotSize = sharedRing::slotSize(recordSize);
+	m_size = sizeof(SHARED_RING_HEADER) + slotSize * slotCount;
+
+#ifdef _WIN32
+	m_name = "Local\\" + name;
+	m_handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, (DWORD)(m_size >> 32), (DWORD)(m_size & 0xFFFFFFFF), m_name.c_str());
+	if (!m_handle) {
+		m_errorString = "CreateFileMapping failed with error " + std::to_string(GetLastError());
+		return false;
+	}
+	// the mapping only vanishes once every reader closed it
+	if (GetLastError() == ERROR_ALREADY_EXISTS) {
+		m_errorString = "the ring is still mapped by a reader of a previous writer";
+		CloseHandle(m_handle);
+		m_handle = nullptr;
+		return false;
+	}
+	m_mapping = MapViewOfFile(m_handle, FILE_MAP_ALL_ACCESS, 0, 0, m_size);
+	if (!m_mapping) {
+		m_errorString = "MapViewOfFile failed with error " + std::to_string(GetLastError());
+		CloseHandle(m_handle);
+		m_handle = nullptr;
+		return false;
+	}
+#else
+	m_name = (name.size() > 0 && name[0] == '/') ? name : "/" + name;
+	// a writer which crashed leaves its ring behind, the readers of it keep their mapping
+	shm_unlink(m_name.c_str());
+	// only the user running LQTControl may read it
+	int fd = shm_open(m_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+	if (fd < 0) {
+		m_errorString = "shm_open failed: " + std::string(strerror(errno));
+		return false;
+	}
+	if (ftruncate(fd, (off_t)m_size) != 0) {
+		m_errorString = "ftruncate failed: " + std::string(strerror(errno));
+		::close(fd);
+		shm_unlink(m_name.c_str());
+		return false;
+	}
+	m_mapping = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (m_mapping == MAP_FAILED) {
+		m_errorString = "mmap failed: " + std::string(strerror(errno));
+		m_mapping = nullptr;
+		shm_unlink(m_name.c_str());
+		return false;
+	}
+#endif
+
+	// the mapping is zeroed, the atomics are constructed in place
+	m_header = new (m_mapping) SHARED_RING_HEADER;
+	m_header->magic.store(0, std::memory_order_relaxed);
+	m_header->version = SHARED_RING_VERSION;
+	m_header->kind = kind;
+	m_header->slotCount = slotCount;
+	m_header->slotSize = slotSize;
+	m_header->dataOffset = sizeof(SHARED_RING_HEADER);
+	m_header->channels = channels;
+	m_header->maxSamples = maxSamples;
+	m_header->published.store(0, std::memory_order_relaxed);
+	for (uint64_t n{ 0 }; n < slotCount; n++) {
+		new (sharedRing::slot(m_mapping, *m_header, n)) SHARED_RING_SLOT{ { 0 }, 0 };
+	}
+	m_next = 0;
+	// readers only use the ring once the magic is set
+	m_header->magic.store(SHARED_RING_MAGIC, std::memory_order_release);
+	m_errorString.clear();
+	return true;
+}
+
+void SharedRingWriter::close() {
+	if (!m_mapping) {
+		return;
+	}
+#ifdef _WIN32
+	UnmapViewOfFile(m_mapping);
+	CloseHandle(m_handle);
+	m_handle = nullptr;
+#else
+	munmap(m_mapping, m_size);
+	shm_unlink(m_name.c_str());
+#endif
+	m_mapping = nullptr;
+	m_header = nullptr;
+	m_slot = nullptr;
+}
+
+bool SharedRingWriter::isOpen() {
+	return m_mapping != nullptr;
+}
+
+std::string SharedRingWriter::errorString() {
+	return m_errorString;
+}
+
+uint32_t SharedRingWriter::getChannels() {
+	return m_header ? m_header->channels : 0;
+}
+
+uint32_t SharedRingWriter::getMaxSamples() {
+	return m_header ? m_header->maxSamples : 0;
+}
+
+void *SharedRingWriter::beginWrite() {
+	m_slot = sharedRing::slot(m_mapping, *m_header, m_next);
+	m_slot->sequence.store(2 * m_next + 1, std::memory_order_relaxed);
+	// the odd sequence has to be visible before any byte of the record changes
+	std::atomic_thread_fence(std::memory_order_release);
+	return m_slot + 1;
+}
+
+void SharedRingWriter::endWrite() {
+	m_slot->sequence.store(2 * m_next + 2, std::memory_order_release);
+	m_header->published.store(m_next + 1, std::memory_order_release);
+	m_next++;
+}
\ No newline at end of file
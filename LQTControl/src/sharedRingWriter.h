@@ -0,0 +1,52 @@
+#ifndef SHAREDRINGWRITER_H
+#define SHAREDRINGWRITER_H
+
+#include <string>
+
+#include "sharedRingLayout.h"
+
+/*
+ * Single writer of a shared memory ring, see sharedRingLayout.h for the layout and the protocol.
+ * Writing a record neither locks nor allocates, so it can be called from the lock loop and the
+ * acquisition. The ring is removed when the writer is closed, readers keep their mapping.
+ *
+ * On Windows a named mapping only vanishes once every handle to it is closed, so opening a ring
+ * fails while a reader still maps the ring of a previous writer of the same name. The readers
+ * have to close it first, e.g. when they see no new records for a while.
+ */
+class SharedRingWriter {
+
+public:
+	SharedRingWriter() noexcept;
+	~SharedRingWriter();
+
+	// creates the ring, a name without a leading slash gets one on POSIX
+	bool openLive(const std::string &name, uint32_t slotCount, uint32_t channels, uint32_t maxSamples);
+	bool openLock(const std::string &name, uint32_t slotCount);
+	void close();
+	bool isOpen();
+	std::string errorString();
+
+	uint32_t getChannels();
+	uint32_t getMaxSamples();
+
+	// returns the record of the next slot, which is published by endWrite()
+	void *beginWrite();
+	void endWrite();
+
+private:
+	bool open(const std::string &name, SHARED_RING_KIND kind, uint32_t slotCount, uint64_t recordSize, uint32_t channels, uint32_t maxSamples);
+
+	std::string m_name;
+	std::string m_errorString;
+	void *m_mapping{ nullptr };
+	uint64_t m_size{ 0 };
+	SHARED_RING_HEADER *m_header{ nullptr };
+	SHARED_RING_SLOT *m_slot{ nullptr };	// slot being written
+	uint64_t m_next{ 0 };					// number of the next record
+#ifdef _WIN32
+	void *m_handle{ nullptr };
+#endif
+};
+
+#endif // SHAREDRINGWRITER_H
\ No newline at end of file
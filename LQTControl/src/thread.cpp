@@ -0,0 +1,212 @@
+#include "thread.h"
+#include <cerrno>
+
+#if defined(Q_OS_LINUX)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(Q_OS_WIN)
+#include <Windows.h>
+#endif
+
+#if defined(Q_OS_LINUX)
+namespace {
+	// The memory is locked for the whole process, so it stays locked as long as any thread asks for it.
+	QMutex memoryLockMutex;
+	QSet<Qt::HANDLE> memoryLockThreads;
+	bool memoryLocked{ false };
+
+	bool setMemoryLock(bool lock) {
+		QMutexLocker locker(&memoryLockMutex);
+		Qt::HANDLE thread = QThread::currentThreadId();
+		if (lock) {
+			memoryLockThreads.insert(thread);
+		} else {
+			memoryLockThreads.remove(thread);
+		}
+		if (!memoryLockThreads.isEmpty() && !memoryLocked) {
+			memoryLocked = (mlockall(MCL_CURRENT | MCL_FUTURE) == 0);
+		} else if (memoryLockThreads.isEmpty() && memoryLocked) {
+			memoryLocked = (munlockall() != 0);
+		}
+		return lock && memoryLocked;
+	}
+}
+#endif
+
+THREAD_SETTINGS getDefaultThreadSettings(THREAD_ROLE role) {
+	THREAD_SETTINGS settings;
+	settings.role = role;
+	switch (role) {
+		case THREAD_ROLE::CONTROL:
+			settings.priority = 80;
+			settings.niceness = -10;
+			break;
+		case THREAD_ROLE::ACQUISITION:
+			settings.priority = 70;
+			settings.niceness = -5;
+			break;
+		case THREAD_ROLE::SERIAL:
+			settings.priority = 60;
+			settings.niceness = -5;
+			break;
+		case THREAD_ROLE::RENDER:
+			// rendering must never preempt the control loop
+			settings.niceness = 5;
+			break;
+	}
+	return settings;
+}
+
+THREAD_SETTINGS applyThreadSettings(const THREAD_SETTINGS &settings) {
+	THREAD_SETTINGS applied = settings;
+	applied.cpu = -1;
+	applied.realtime = false;
+	applied.priority = 0;
+	applied.niceness = 0;
+	applied.lockMemory = false;
+
+#if defined(Q_OS_LINUX)
+	pthread_t thread = pthread_self();
+
+	// pin the thread to a single core, or let it run on all of them again
+	int nrCPUs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	if (settings.cpu < nrCPUs) {
+		cpu_set_t cpuSet;
+		CPU_ZERO(&cpuSet);
+		if (settings.cpu >= 0) {
+			CPU_SET(settings.cpu, &cpuSet);
+		} else {
+			for (int cpu{ 0 }; cpu < nrCPUs && cpu < CPU_SETSIZE; cpu++) {
+				CPU_SET(cpu, &cpuSet);
+			}
+		}
+		pthread_setaffinity_np(thread, sizeof(cpuSet), &cpuSet);
+	}
+	cpu_set_t cpuSet;
+	CPU_ZERO(&cpuSet);
+	if (pthread_getaffinity_np(thread, sizeof(cpuSet), &cpuSet) == 0 && CPU_COUNT(&cpuSet) == 1) {
+		for (int cpu{ 0 }; cpu < CPU_SETSIZE; cpu++) {
+			if (CPU_ISSET(cpu, &cpuSet)) {
+				applied.cpu = cpu;
+				break;
+			}
+		}
+	}
+
+	// the real-time scheduler requires CAP_SYS_NICE or an rtprio limit, fall back to the nice value otherwise
+	struct sched_param param {};
+	if (settings.realtime) {
+		int minPriority = sched_get_priority_min(SCHED_FIFO);
+		int maxPriority = sched_get_priority_max(SCHED_FIFO);
+		param.sched_priority = (settings.priority < minPriority) ? minPriority : (settings.priority > maxPriority) ? maxPriority : settings.priority;
+		pthread_setschedparam(thread, SCHED_FIFO, &param);
+	} else {
+		// leaving the real-time scheduler needs no privileges
+		param.sched_priority = 0;
+		pthread_setschedparam(thread, SCHED_OTHER, &param);
+	}
+	int policy{ SCHED_OTHER };
+	if (pthread_getschedparam(thread, &policy, &param) == 0 && policy == SCHED_FIFO) {
+		applied.realtime = true;
+		applied.priority = param.sched_priority;
+	} else {
+		// on Linux the nice value is a per-thread attribute
+		pid_t tid = (pid_t)syscall(SYS_gettid);
+		setpriority(PRIO_PROCESS, tid, settings.niceness);
+		errno = 0;
+		int niceness = getpriority(PRIO_PROCESS, tid);
+		if (errno == 0) {
+			applied.niceness = niceness;
+		}
+	}
+
+	// memory locking is process wide, so a page fault in any thread cannot stall the control loop
+	applied.lockMemory = setMemoryLock(settings.lockMemory);
+#elif defined(Q_OS_WIN)
+	HANDLE thread = GetCurrentThread();
+
+	if (settings.cpu >= 0 && settings.cpu < (int)(8 * sizeof(DWORD_PTR))) {
+		if (SetThreadAffinityMask(thread, (DWORD_PTR)1 << settings.cpu)) {
+			applied.cpu = settings.cpu;
+		}
+	} else if (settings.cpu < 0) {
+		// the thread may run on all cores the process may run on
+		DWORD_PTR processMask{ 0 };
+		DWORD_PTR systemMask{ 0 };
+		if (GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask)) {
+			SetThreadAffinityMask(thread, processMask);
+		}
+	}
+
+	int priority{ THREAD_PRIORITY_NORMAL };
+	if (settings.realtime) {
+		priority = THREAD_PRIORITY_TIME_CRITICAL;
+	} else if (settings.niceness < 0) {
+		priority = THREAD_PRIORITY_ABOVE_NORMAL;
+	} else if (settings.niceness > 0) {
+		priority = THREAD_PRIORITY_BELOW_NORMAL;
+	}
+	SetThreadPriority(thread, priority);
+	priority = GetThreadPriority(thread);
+	applied.realtime = (priority == THREAD_PRIORITY_TIME_CRITICAL);
+	applied.priority = priority;
+	applied.niceness = (priority > THREAD_PRIORITY_NORMAL) ? -1 : (priority < THREAD_PRIORITY_NORMAL) ? 1 : 0;
+	// locking the whole process memory is not supported on Windows
+#endif
+
+	return applied;
+}
+
+Thread::Thread(THREAD_ROLE role) noexcept {
+	m_settings = getDefaultThreadSettings(role);
+	m_appliedSettings.role = role;
+}
+
+void Thread::setSettings(THREAD_SETTINGS settings) {
+	{
+		QMutexLocker locker(&m_mutex);
+		settings.role = m_settings.role;
+		m_settings = settings;
+	}
+	// a running thread has to apply the settings itself
+	QObject *context = m_context.loadAcquire();
+	if (context) {
+		QMetaObject::invokeMethod(context, [this]() { apply(); }, Qt::QueuedConnection);
+	}
+}
+
+THREAD_SETTINGS Thread::getSettings() {
+	QMutexLocker locker(&m_mutex);
+	return m_settings;
+}
+
+THREAD_SETTINGS Thread::getAppliedSettings() {
+	QMutexLocker locker(&m_mutex);
+	return m_appliedSettings;
+}
+
+void Thread::run() {
+	QObject context;
+	m_context.storeRelease(&context);
+	apply();
+	exec();
+	m_context.storeRelease(nullptr);
+	// the memory stays locked only as long as a running thread asks for it
+	THREAD_SETTINGS settings = getSettings();
+	settings.lockMemory = false;
+	applyThreadSettings(settings);
+}
+
+void Thread::apply() {
+	THREAD_SETTINGS settings = getSettings();
+	THREAD_SETTINGS applied = applyThreadSettings(settings);
+	{
+		QMutexLocker locker(&m_mutex);
+		m_appliedSettings = applied;
+	}
+	emit(settingsApplied(applied));
+}
\ No newline at end of file
@@ -3,10 +3,38 @@
 
 #include <QtCore>
 
+typedef enum enThreadRoles {
+	CONTROL,		// lock loop
+	ACQUISITION,	// data acquisition, the programs run it on the CONTROL thread since the lock reads the DAQ directly
+	SERIAL,			// serial communication with the laser
+	RENDER			// GUI and analysis
+} THREAD_ROLE;
+
+typedef struct THREAD_SETTINGS {
+	THREAD_ROLE role{ THREAD_ROLE::CONTROL };	//		role of the thread
+	int cpu{ -1 };								//		CPU core the thread is pinned to, -1 for no pinning
+	bool realtime{ false };						//		use the real-time scheduler (SCHED_FIFO on Linux, time critical on Windows)
+	int priority{ 50 };							//		real-time priority, 1 to 99
+	int niceness{ 0 };							//		nice value used without real-time scheduling, -20 to 19
+	bool lockMemory{ false };					//		lock the process memory to prevent paging
+} THREAD_SETTINGS;
+
+THREAD_SETTINGS getDefaultThreadSettings(THREAD_ROLE role);
+
+/*
+ * Applies the settings to the calling thread as far as permitted and
+ * returns the settings the thread actually got. Every setting can be reverted:
+ * a cpu of -1 unpins the thread, disabling realtime restores the normal scheduler
+ * and the memory is unlocked once no thread asks for it to be locked anymore.
+ */
+THREAD_SETTINGS applyThreadSettings(const THREAD_SETTINGS &settings);
+
 class Thread :public QThread {
 	Q_OBJECT
 
 public:
+	explicit Thread(THREAD_ROLE role = THREAD_ROLE::CONTROL) noexcept;
+
 	void startWorker(QObject *worker) {
 		worker->moveToThread(this);
 		if (!this->isRunning()) {
@@ -15,6 +43,24 @@ public:
 
 		QMetaObject::invokeMethod(worker, "init", Qt::AutoConnection);
 	}
+
+	void setSettings(THREAD_SETTINGS settings);
+	THREAD_SETTINGS getSettings();
+	THREAD_SETTINGS getAppliedSettings();
+
+signals:
+	void settingsApplied(THREAD_SETTINGS);
+
+protected:
+	void run() override;
+
+private:
+	void apply();
+
+	QMutex m_mutex;
+	THREAD_SETTINGS m_settings;
+	THREAD_SETTINGS m_appliedSettings;
+	QAtomicPointer<QObject> m_context{ nullptr };	// lives in the thread, used to apply changed settings from within the thread
 };
 
-#endif // THREAD_H
+#endif // THREAD_H
\ No newline at end of file
@@ -0,0 +1,161 @@
+#ifndef TIMERMONITOR_H
+#define TIMERMONITOR_H
+
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <gsl/gsl>
+#include "allocationCounter.h"
+
+typedef enum enTimers {
+	LOCKINGTIMER,
+	SCANTIMER,
+	ACQUISITIONTIMER
+} TIMERS;
+
+typedef struct TIMER_STATISTICS {
+	TIMERS timer{ TIMERS::LOCKINGTIMER };	//		the timer these statistics belong to
+	int period{ 0 };						// [ms]	configured timer period
+	uint64_t ticks{ 0 };					//		number of ticks since the last reset
+	uint64_t overruns{ 0 };					//		number of ticks which took longer than the period
+	uint64_t missedDeadlines{ 0 };			//		number of ticks which started more than half a period too late
+	double lastInterval{ 0 };				// [ms]	interval between the last two ticks
+	double lastDuration{ 0 };				// [ms]	duration of the last tick
+	double meanInterval{ 0 };				// [ms]	mean interval over the rolling window
+	double jitter{ 0 };						// [ms]	standard deviation of the interval over the rolling window
+	double maxInterval{ 0 };				// [ms]	maximum interval over the rolling window
+	double lateRatio{ 0 };					// [1]	ratio of overrun or late ticks in the rolling window
+	bool rateKept{ true };					//		whether the timer currently keeps its configured rate
+	uint64_t lastAllocations{ 0 };			//		heap allocations of the last tick, only counted with LQTCONTROL_COUNT_ALLOCATIONS
+	uint64_t allocatingTicks{ 0 };			//		number of ticks which allocated, the first tick after a reset is not counted
+} TIMER_STATISTICS;
+
+/*
+ * Records the actual inter-tick intervals and tick durations of a QTimer driven slot.
+ * tickStarted() has to be called at the beginning and tickFinished() at the end of the slot.
+ * The heap allocations the thread made in between are counted as well, the first tick may allocate the buffers.
+ */
+class TimerMonitor {
+
+public:
+	explicit TimerMonitor(TIMERS timer, int period = 0, int windowSize = 100) noexcept;
+
+	void setPeriod(int period);
+	void reset();
+
+	void tickStarted();
+	void tickFinished();
+
+	TIMER_STATISTICS getStatistics();
+
+	double m_maxLateRatio{ 0.1 };	// [1]	maximum ratio of late ticks in the window before the rate counts as not kept
+
+private:
+	typedef std::chrono::steady_clock clock;
+
+	TIMER_STATISTICS m_statistics;
+	std::vector<double> m_intervals;	// [ms]	rolling window of the inter-tick intervals
+	std::vector<bool> m_late;			//		rolling window of overrun or late ticks
+	int m_windowSize;
+	gsl::index m_nextIndex{ 0 };
+	bool m_wrapped{ false };
+	bool m_running{ false };
+	bool m_overran{ false };			//		whether the last tick took longer than the period
+	clock::time_point m_lastStart;
+	uint64_t m_startAllocations{ 0 };
+};
+
+inline TimerMonitor::TimerMonitor(TIMERS timer, int period, int windowSize) noexcept : m_windowSize(windowSize) {
+	m_statistics.timer = timer;
+	m_statistics.period = period;
+	m_intervals.resize(m_windowSize);
+	m_late.resize(m_windowSize);
+}
+
+inline void TimerMonitor::setPeriod(int period) {
+	m_statistics.period = period;
+}
+
+// Has to be called whenever the timer is (re)started, otherwise the pause counts as a missed deadline
+inline void TimerMonitor::reset() {
+	auto timer = m_statistics.timer;
+	auto period = m_statistics.period;
+	m_statistics = TIMER_STATISTICS{};
+	m_statistics.timer = timer;
+	m_statistics.period = period;
+	std::fill(m_intervals.begin(), m_intervals.end(), 0.0);
+	std::fill(m_late.begin(), m_late.end(), false);
+	m_nextIndex = 0;
+	m_wrapped = false;
+	m_running = false;
+	m_overran = false;
+}
+
+inline void TimerMonitor::tickStarted() {
+	auto now = clock::now();
+	if (m_running) {
+		double interval = std::chrono::duration_cast<std::chrono::microseconds>(now - m_lastStart).count() / 1e3;
+		bool late = (interval > 1.5 * m_statistics.period);
+		if (late) {
+			m_statistics.missedDeadlines++;
+		}
+		m_statistics.lastInterval = interval;
+		m_intervals[m_nextIndex] = interval;
+		// the interval starts with the previous tick, an overrun of that tick makes it late as well
+		m_late[m_nextIndex] = late || m_overran;
+		m_nextIndex++;
+		if (m_nextIndex >= m_windowSize) {
+			m_nextIndex = 0;
+			m_wrapped = true;
+		}
+	}
+	m_running = true;
+	m_overran = false;
+	m_lastStart = now;
+	m_statistics.ticks++;
+	m_startAllocations = allocationCounter::thread();
+}
+
+inline void TimerMonitor::tickFinished() {
+	m_statistics.lastAllocations = allocationCounter::thread() - m_startAllocations;
+	if (m_statistics.lastAllocations > 0 && m_statistics.ticks > 1) {
+		m_statistics.allocatingTicks++;
+	}
+	auto duration = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - m_lastStart).count() / 1e3;
+	m_statistics.lastDuration = duration;
+	m_overran = (duration > m_statistics.period);
+	if (m_overran) {
+		m_statistics.overruns++;
+	}
+}
+
+inline TIMER_STATISTICS TimerMonitor::getStatistics() {
+	auto count = m_wrapped ? m_windowSize : m_nextIndex;
+	if (count == 0) {
+		return m_statistics;
+	}
+
+	double sum{ 0 };
+	double max{ 0 };
+	int late{ 0 };
+	for (gsl::index i{ 0 }; i < count; i++) {
+		sum += m_intervals[i];
+		max = (m_intervals[i] > max) ? m_intervals[i] : max;
+		late += m_late[i];
+	}
+	double mean = sum / count;
+	double accum{ 0 };
+	for (gsl::index i{ 0 }; i < count; i++) {
+		accum += (m_intervals[i] - mean) * (m_intervals[i] - mean);
+	}
+
+	m_statistics.meanInterval = mean;
+	m_statistics.jitter = (count > 1) ? sqrt(accum / (count - 1)) : 0;
+	m_statistics.maxInterval = max;
+	m_statistics.lateRatio = (double)late / count;
+	m_statistics.rateKept = (m_statistics.lateRatio <= m_maxLateRatio);
+	return m_statistics;
+}
+
+#endif // TIMERMONITOR_H
@@ -0,0 +1,49 @@
+# ----------------------------------------------------
+# Micro-benchmarks of the numeric and data-path hot
+# spots, writes Google Benchmark compatible JSON.
+# ----------------------------------------------------
+
+TEMPLATE = app
+TARGET = LQTControlBenchmark
+QT += core widgets serialport charts
+CONFIG += console c++14 release
+CONFIG -= app_bundle
+DEFINES += LQTCONTROL_COUNT_ALLOCATIONS
+INCLUDEPATH += ./src \
+    ../LQTControl/src \
+    ../LQTSimulation/src \
+    ../LQTEmulator/src \
+    ../LQTControl/external/gsl/include \
+    ../LQTControl/external/fmt/include
+HEADERS += ./src/benchmark.h \
+    ../LQTControl/src/allocationCounter.h \
+    ../LQTSimulation/src/laserTwin.h \
+    ../LQTSimulation/src/twinTransport.h \
+    ../LQTControl/src/clock.h \
+    ../LQTControl/src/circularBuffer.h \
+    ../LQTControl/src/generalmath.h \
+    ../LQTControl/src/lockView.h \
+    ../LQTControl/src/locking.h \
+    ../LQTControl/src/sharedRingLayout.h \
+    ../LQTControl/src/sharedRingWriter.h \
+    ../LQTControl/src/thread.h \
+    ../LQTControl/src/Devices/daq.h \
+    ../LQTControl/src/Devices/DAQ_Synthetic.h \
+    ../LQTControl/src/Devices/LQT.h
+SOURCES += ./src/main.cpp \
+    ./src/benchmark.cpp \
+    ../LQTControl/src/allocationCounter.cpp \
+    ../LQTSimulation/src/laserTwin.cpp \
+    ../LQTSimulation/src/twinTransport.cpp \
+    ../LQTEmulator/src/lqtEmulator.cpp \
+    ../LQTControl/src/clock.cpp \
+    ../LQTControl/src/locking.cpp \
+    ../LQTControl/src/sharedRingWriter.cpp \
+    ../LQTControl/src/thread.cpp \
+    ../LQTControl/src/Devices/daq.cpp \
+    ../LQTControl/src/Devices/DAQ_Synthetic.cpp \
+    ../LQTControl/src/Devices/LQT.cpp \
+    ../LQTControl/src/Devices/serialTransport.cpp \
+    ../LQTControl/src/Devices/traceTransport.cpp \
+    ../LQTControl/external/fmt/src/format.cc
+unix:!macx:LIBS += -lrt
\ No newline at end of file
@@ -0,0 +1,134 @@
+#include "benchmark.h"
+#include "allocationCounter.h"
+
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <thread>
+
+BenchmarkState::BenchmarkState(uint64_t iterations, int64_t argument) noexcept :
+	m_iterations(iterations), m_remaining(iterations), m_argument(argument) {
+}
+
+// Starts the timers on the first call and stops them once all iterations ran
+bool BenchmarkState::keepRunning() {
+	if (!m_started) {
+		m_started = true;
+		m_allocationsStart = allocationCounter::thread();
+		m_cpuStart = std::clock();
+		m_realStart = std::chrono::steady_clock::now();
+	}
+	if (m_remaining > 0) {
+		m_remaining--;
+		return true;
+	}
+	m_realTime = std::chrono::steady_clock::now() - m_realStart;
+	m_cpuTime = std::clock() - m_cpuStart;
+	m_allocations = allocationCounter::thread() - m_allocationsStart;
+	return false;
+}
+
+int64_t BenchmarkState::argument() const {
+	return m_argument;
+}
+
+void BenchmarkState::setItemsProcessed(uint64_t items) {
+	m_items = items;
+}
+
+uint64_t BenchmarkState::iterations() const {
+	return m_iterations;
+}
+
+uint64_t BenchmarkState::itemsProcessed() const {
+	return m_items;
+}
+
+std::chrono::steady_clock::duration BenchmarkState::realTime() const {
+	return m_realTime;
+}
+
+std::clock_t BenchmarkState::cpuTime() const {
+	return m_cpuTime;
+}
+
+uint64_t BenchmarkState::allocations() const {
+	return m_allocations;
+}
+
+void benchmark::add(std::string name, std::function<void(BenchmarkState &)> function, std::vector<int64_t> arguments) {
+	cases().push_back({ name, function, arguments });
+}
+
+std::vector<BENCHMARK_CASE> &benchmark::cases() {
+	static std::vector<BENCHMARK_CASE> cases;
+	return cases;
+}
+
+BENCHMARK_RESULT benchmark::run(const BENCHMARK_CASE &benchmarkCase, int64_t argument, bool hasArgument, double minTime) {
+	BENCHMARK_RESULT result;
+	result.name = hasArgument ? benchmarkCase.name + "/" + std::to_string(argument) : benchmarkCase.name;
+	result.argument = argument;
+
+	uint64_t iterations{ 1 };
+	while (true) {
+		BenchmarkState state(iterations, argument);
+		benchmarkCase.function(state);
+		double realTime = std::chrono::duration<double>(state.realTime()).count();
+		// stop when the run was long enough or the number of iterations gets absurd
+		if (realTime >= minTime || iterations >= 1000000000) {
+			result.iterations = iterations;
+			result.realTime = 1e9 * realTime / iterations;
+			result.cpuTime = 1e9 * state.cpuTime() / CLOCKS_PER_SEC / iterations;
+			result.itemsPerSecond = (realTime > 0) ? state.itemsProcessed() / realTime : 0;
+			result.allocationsPerIteration = (double)state.allocations() / iterations;
+			return result;
+		}
+		// aim a bit beyond the minimum time, but grow by at most a factor of ten, as the short runs are imprecise
+		double factor = (realTime > 0) ? 1.4 * minTime / realTime : 10;
+		factor = (factor > 10) ? 10 : factor;
+		auto next = (uint64_t)(iterations * factor);
+		iterations = (next > iterations) ? next : iterations + 1;
+	}
+}
+
+QJsonDocument benchmark::toJson(const std::vector<BENCHMARK_RESULT> &results, std::string executable) {
+	QJsonObject context;
+	context["date"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+	context["host_name"] = QSysInfo::machineHostName();
+	context["executable"] = QString::fromStdString(executable);
+	context["num_cpus"] = (int)std::thread::hardware_concurrency();
+	context["cpu_architecture"] = QSysInfo::currentCpuArchitecture();
+	context["os"] = QSysInfo::prettyProductName();
+#if defined(QT_DEBUG)
+	context["library_build_type"] = "debug";
+#else
+	context["library_build_type"] = "release";
+#endif
+
+	QJsonArray benchmarks;
+	for (const auto &result : results) {
+		QJsonObject entry;
+		entry["name"] = QString::fromStdString(result.name);
+		entry["run_name"] = QString::fromStdString(result.name);
+		entry["run_type"] = "iteration";
+		entry["iterations"] = (double)result.iterations;
+		entry["real_time"] = result.realTime;
+		entry["cpu_time"] = result.cpuTime;
+		entry["time_unit"] = "ns";
+		if (result.itemsPerSecond > 0) {
+			entry["items_per_second"] = result.itemsPerSecond;
+		}
+		// a user counter, so compare.py reports changes of it as well
+		if (allocationCounter::enabled()) {
+			entry["allocations_per_iteration"] = result.allocationsPerIteration;
+		}
+		benchmarks.append(entry);
+	}
+
+	QJsonObject root;
+	root["context"] = context;
+	root["benchmarks"] = benchmarks;
+	return QJsonDocument(root);
+}
\ No newline at end of file
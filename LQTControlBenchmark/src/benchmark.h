@@ -0,0 +1,91 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <chrono>
+#include <ctime>
+#include <functional>
+#include <string>
+#include <vector>
+#include <QJsonDocument>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+typedef struct BENCHMARK_RESULT {
+	std::string name;				//		name of the case and its argument, e.g. "generalmath/mean/144000"
+	int64_t argument{ 0 };			//		argument the case ran with, e.g. the number of values
+	uint64_t iterations{ 0 };		//		number of iterations of the measured run
+	double realTime{ 0 };			// [ns]	wall time per iteration
+	double cpuTime{ 0 };			// [ns]	processor time of the process per iteration
+	double itemsPerSecond{ 0 };		// [1/s]	items processed per second of wall time, 0 if the case does not count items
+	double allocationsPerIteration{ 0 };	//		heap allocations of the measuring thread per iteration
+} BENCHMARK_RESULT;
+
+/*
+ * Passed to a benchmark case. The case does its setup, then runs the measured code while keepRunning() returns true:
+ *
+ *	while (state.keepRunning()) {
+ *		benchmark::doNotOptimize(generalmath::mean(values));
+ *	}
+ *
+ * Only the loop is timed.
+ */
+class BenchmarkState {
+public:
+	BenchmarkState(uint64_t iterations, int64_t argument) noexcept;
+
+	bool keepRunning();
+	int64_t argument() const;
+	void setItemsProcessed(uint64_t items);
+
+	uint64_t iterations() const;
+	uint64_t itemsProcessed() const;
+	std::chrono::steady_clock::duration realTime() const;
+	std::clock_t cpuTime() const;
+	uint64_t allocations() const;
+
+private:
+	uint64_t m_iterations{ 0 };
+	uint64_t m_remaining{ 0 };
+	int64_t m_argument{ 0 };
+	uint64_t m_items{ 0 };
+	bool m_started{ false };
+	std::chrono::steady_clock::time_point m_realStart;
+	std::chrono::steady_clock::duration m_realTime{ 0 };
+	std::clock_t m_cpuStart{ 0 };
+	std::clock_t m_cpuTime{ 0 };
+	uint64_t m_allocationsStart{ 0 };
+	uint64_t m_allocations{ 0 };
+};
+
+typedef struct BENCHMARK_CASE {
+	std::string name;								//		name of the case
+	std::function<void(BenchmarkState &)> function;	//		the case itself
+	std::vector<int64_t> arguments;					//		arguments to run the case with, the case runs once without arguments
+} BENCHMARK_CASE;
+
+class benchmark {
+public:
+	// Keeps the compiler from optimizing away a result which is not used otherwise
+	template <typename T>
+	static void doNotOptimize(T const &value) {
+#if defined(_MSC_VER)
+		static const void * volatile sink;
+		sink = &value;
+		_ReadWriteBarrier();
+#else
+		asm volatile("" : : "g"(&value) : "memory");
+#endif
+	}
+
+	static void add(std::string name, std::function<void(BenchmarkState &)> function, std::vector<int64_t> arguments = {});
+	static std::vector<BENCHMARK_CASE> &cases();
+
+	// Runs a case with more and more iterations until a run takes at least the given time [s], the last run is the result
+	static BENCHMARK_RESULT run(const BENCHMARK_CASE &benchmarkCase, int64_t argument, bool hasArgument, double minTime);
+
+	// The results in the JSON format of Google Benchmark, so its compare tools can compare two runs
+	static QJsonDocument toJson(const std::vector<BENCHMARK_RESULT> &results, std::string executable);
+};
+
+#endif // BENCHMARK_H
\ No newline at end of file
@@ -0,0 +1,402 @@
+/*
+ * Micro-benchmarks of the numeric and data-path hot spots of LQTControl:
+ *
+ *   LQTControlBenchmark --filter generalmath --out results.json
+ *
+ * The results are written in the JSON format of Google Benchmark, so two runs
+ * can be compared with its compare.py, e.g. before and after a change.
+ */
+#include "benchmark.h"
+
+#include "clock.h"
+#include "circularBuffer.h"
+#include "generalmath.h"
+#include "locking.h"
+#include "lockView.h"
+#include "thread.h"
+#include "Devices/LQT.h"
+#include "Devices/DAQ_Synthetic.h"
+#include "laserTwin.h"
+#include "twinTransport.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QRegularExpression>
+#include <cstdio>
+#include <random>
+#include <thread>
+
+namespace {
+	// the lock stores 4 h of data, at the default locking timeout of 100 ms that are 144000 values
+	const std::vector<int64_t> historySizes{ 1000, 10000, 144000 };
+	// the default and the maximum number of samples per block
+	const std::vector<int64_t> blockSizes{ 1000, 8000 };
+
+	std::vector<double> randomValues(int64_t size) {
+		std::mt19937 generator(1);
+		std::normal_distribution<double> distribution(0.5, 0.1);
+		std::vector<double> values(size);
+		for (auto &value : values) {
+			value = distribution(generator);
+		}
+		return values;
+	}
+
+	std::vector<int32_t> randomCounts(int64_t size) {
+		std::mt19937 generator(1);
+		std::uniform_int_distribution<int32_t> distribution(-32767, 32767);
+		std::vector<int32_t> values(size);
+		for (auto &value : values) {
+			value = distribution(generator);
+		}
+		return values;
+	}
+
+	// A synthetic DAQ which lets the benchmarks call the conversion the device backends use
+	class daq_Benchmark : public daq_Synthetic {
+	public:
+		explicit daq_Benchmark(QObject *parent) : daq_Synthetic(parent) {}
+		using daq::adc_to_mv;
+		using daq::m_unitOpened;
+	};
+
+	// Lock data with the given number of values, which wrapped around a third into the storage
+	LOCK_DATA wrappedLockData(int64_t size) {
+		LOCK_DATA lockData;
+		lockData.storageSize = (int)size;
+		lockData.time.resize(size);
+		lockData.transmission.resize(size);
+		lockData.startTime = std::chrono::system_clock::now();
+		lockData.nextIndex = size / 3;
+		lockData.wrapped = true;
+		auto values = randomValues(size);
+		for (gsl::index i{ 0 }; i < size; i++) {
+			gsl::index index = generalmath::indexWrapped((int)(lockData.nextIndex + i), (int)size);
+			lockData.time[index] = lockData.startTime + std::chrono::milliseconds(100 * i);
+			lockData.transmission[index] = values[i];
+		}
+		return lockData;
+	}
+
+	void addGeneralmathBenchmarks() {
+		benchmark::add("generalmath/mean<int>", [](BenchmarkState &state) {
+			auto values = randomCounts(state.argument());
+			std::vector<int> counts(values.begin(), values.end());
+			while (state.keepRunning()) {
+				benchmark::doNotOptimize(generalmath::mean(counts));
+			}
+			state.setItemsProcessed(state.iterations() * state.argument());
+		}, historySizes);
+		benchmark::add("generalmath/mean<double>", [](BenchmarkState &state) {
+			auto values = randomValues(state.argument());
+			while (state.keepRunning()) {
+				benchmark::doNotOptimize(generalmath::mean(values));
+			}
+			state.setItemsProcessed(state.iterations() * state.argument());
+		}, historySizes);
+		benchmark::add("generalmath/mean<complex>", [](BenchmarkState &state) {
+			auto real = randomValues(state.argument());
+			std::vector<std::complex<double>> values(real.begin(), real.end());
+			while (state.keepRunning()) {
+				benchmark::doNotOptimize(generalmath::mean(values));
+			}
+			state.setItemsProcessed(state.iterations() * state.argument());
+		}, historySizes);
+		benchmark::add("generalmath/max", [](BenchmarkState &state) {
+			auto values = randomValues(state.argument());
+			while (state.keepRunning()) {
+				benchmark::doNotOptimize(generalmath::max(values));
+			}
+			state.setItemsProcessed(state.iterations() * state.argument());
+		}, historySizes);
+		benchmark::add("generalmath/min", [](BenchmarkState &state) {
+			auto values = randomValues(state.argument());
+			while (state.keepRunning()) {
+				benchmark::doNotOptimize(generalmath::min(values));
+			}
+			state.setItemsProcessed(state.iterations() * state.argument());
+		}, historySizes);
+		benchmark::add("generalmath/absSum", [](BenchmarkState &state) {
+			auto values = randomValues(state.argument());
+			while (state.keepRunning()) {
+				benchmark::doNotOptimize(generalmath::absSum(values));
+			}
+			state.setItemsProcessed(state.iterations() * state.argument());
+		}, historySizes);
+		benchmark::add("generalmath/standardDeviation", [](BenchmarkState &state) {
+			auto values = randomValues(state.argument());
+			while (state.keepRunning()) {
+				benchmark::doNotOptimize(generalmath::standardDeviation(values));
+			}
+			state.setItemsProcessed(state.iterations() * state.argument());
+		}, historySizes);
+		// the floating functions run over the last 10 % of the values, wrapping around the end like the lock history does
+		benchmark::add("generalmath/floatingMean", [](BenchmarkState &state) {
+			auto values = randomValues(state.argument());
+			size_t window = state.argument() / 10;
+			while (state.keepRunning()) {
+				benchmark::doNotOptimize(generalmath::floatingMean(values, window, state.argument() - window / 2));
+			}
+			state.setItemsProcessed(state.iterations() * state.argument());
+		}, historySizes);
+		benchmark::add("generalmath/floatingStandardDeviation", [](BenchmarkState &state) {
+			auto values = randomValues(state.argument());
+			size_t window = state.argument() / 10;
+			while (state.keepRunning()) {
+				benchmark::doNotOptimize(generalmath::floatingStandardDeviation(values, window, state.argument() - window / 2));
+			}
+			state.setItemsProcessed(state.iterations() * state.argument());
+		}, historySizes);
+		benchmark::add("generalmath/floatingMax<double>", [](BenchmarkState &state) {
+			auto values = randomValues(state.argument());
+			while (state.keepRunning()) {
+				benchmark::doNotOptimize(generalmath::floatingMax(values, state.argument() / 10));
+			}
+			state.setItemsProcessed(state.iterations() * state.argument());
+		}, historySizes);
+		benchmark::add("generalmath/floatingMax<int32_t>", [](BenchmarkState &state) {
+			auto values = randomCounts(state.argument());
+			while (state.keepRunning()) {
+				benchmark::doNotOptimize(generalmath::floatingMax(values, state.argument() / 10));
+			}
+			state.setItemsProcessed(state.iterations() * state.argument());
+		}, historySizes);
+		benchmark::add("generalmath/linspace", [](BenchmarkState &state) {
+			while (state.keepRunning()) {
+				benchmark::doNotOptimize(generalmath::linspace<double>(0.0, 1.0, state.argument()));
+			}
+			state.setItemsProcessed(state.iterations() * state.argument());
+		}, historySizes);
+		benchmark::add("generalmath/indexWrapped", [](BenchmarkState &state) {
+			int size = (int)state.argument();
+			while (state.keepRunning()) {
+				for (int i{ -size }; i < size; i++) {
+					benchmark::doNotOptimize(generalmath::indexWrapped(i, size));
+				}
+			}
+			state.setItemsProcessed(state.iterations() * 2 * state.argument());
+		}, historySizes);
+	}
+
+	void addDaqBenchmarks() {
+		// the conversion loop of the device backends, for both channels of a block
+		benchmark::add("daq/adc_to_mv", [](BenchmarkState &state) {
+			daq_Benchmark acquisition(nullptr);
+			acquisition.init();
+			acquisition.connect();
+			auto raw = randomCounts(state.argument());
+			std::array<std::vector<int16_t>, DAQ_MAX_CHANNELS> counts;
+			for (auto &channel : counts) {
+				channel.assign(raw.begin(), raw.end());
+			}
+			while (state.keepRunning()) {
+				std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> values;
+				for (gsl::index i{ 0 }; i < state.argument(); i++) {
+					for (gsl::index ch{ 0 }; ch < 2; ch++) {
+						values[ch].push_back(acquisition.adc_to_mv(counts[ch][i], acquisition.m_unitOpened.channelSettings[ch].range));
+					}
+				}
+				benchmark::doNotOptimize(values);
+			}
+			state.setItemsProcessed(state.iterations() * 2 * state.argument());
+			acquisition.disconnect();
+		}, blockSizes);
+		// capture, generation and conversion of a block into the buffers the lock reuses, the capture time passes in virtual time
+		benchmark::add("daq/collectBlockData", [](BenchmarkState &state) {
+			VirtualClock clock;
+			Clock::set(&clock);
+			daq_Synthetic acquisition(nullptr);
+			acquisition.init();
+			acquisition.connect();
+			acquisition.setNumberSamples((int32_t)state.argument());
+			std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> values;
+			while (state.keepRunning()) {
+				acquisition.collectBlockData(values);
+				benchmark::doNotOptimize(values);
+			}
+			state.setItemsProcessed(state.iterations() * 2 * state.argument());
+			acquisition.disconnect();
+			Clock::set(nullptr);
+		}, blockSizes);
+	}
+
+	// The handoff of the live view, a block of both channels is written and read through the buffer
+	void handOff(CircularBuffer<int16_t> &buffer, const std::vector<int16_t> &values, bool write) {
+		if (write) {
+			buffer.m_freeBuffers->acquire();
+			auto buffers = buffer.getWriteBuffer();
+			for (gsl::index ch{ 0 }; ch < 2; ch++) {
+				std::copy(values.begin(), values.end(), buffers[ch]);
+			}
+			buffer.m_usedBuffers->release();
+		} else {
+			buffer.m_usedBuffers->acquire();
+			auto buffers = buffer.getReadBuffer();
+			benchmark::doNotOptimize(buffers[0][values.size() - 1]);
+			buffer.m_freeBuffers->release();
+		}
+	}
+
+	void addCircularBufferBenchmarks() {
+		benchmark::add("circularBuffer/handoff", [](BenchmarkState &state) {
+			CircularBuffer<int16_t> buffer(4, DAQ_MAX_CHANNELS, 8000);
+			std::vector<int16_t> values(state.argument(), 1);
+			while (state.keepRunning()) {
+				handOff(buffer, values, true);
+				handOff(buffer, values, false);
+			}
+			state.setItemsProcessed(state.iterations());
+		}, blockSizes);
+		// the acquisition writes on its thread while the GUI thread reads, like the live view
+		benchmark::add("circularBuffer/handoffThreaded", [](BenchmarkState &state) {
+			CircularBuffer<int16_t> buffer(4, DAQ_MAX_CHANNELS, 8000);
+			std::vector<int16_t> values(state.argument(), 1);
+			// the reader waits for the first block, so it can be started before the timing
+			std::thread reader([&buffer, &values, &state]() {
+				for (uint64_t i{ 0 }; i < state.iterations(); i++) {
+					handOff(buffer, values, false);
+				}
+			});
+			while (state.keepRunning()) {
+				handOff(buffer, values, true);
+			}
+			reader.join();
+			state.setItemsProcessed(state.iterations());
+		}, blockSizes);
+	}
+
+	// One step of the lock on synthetic data, including serving the laser requests of the step.
+	// The laser twin answers without delay and the capture time passes in virtual time.
+	void addLockingBenchmarks() {
+		benchmark::add("locking/lock", [](BenchmarkState &state) {
+			VirtualClock clock;
+			Clock::set(&clock);
+			LaserTwin twin(LASER_TWIN_SETTINGS{}, clock.now());
+
+			// the laser lives on its own thread like in the application, every step waits until it served the requests of the step
+			Thread serialThread{ THREAD_ROLE::SERIAL };
+			LQT laser;
+			laser.setTransport(new TwinTransport(&twin, EMULATOR_SETTINGS{}));
+			laser.setStatusPollingInterval(0);
+			serialThread.startWorker(&laser);
+			QMetaObject::invokeMethod(&laser, "connect", Qt::BlockingQueuedConnection);
+			// the marker is served last, since it has the lowest priority
+			auto waitForLaser = [&laser]() {
+				laser.request(LQT_COMMAND::OTHER, 0, LQT_PRIORITY::STATUS).wait();
+			};
+
+			daq_Synthetic acquisition(nullptr);
+			SYNTHETIC_SETTINGS acquisitionSettings = acquisition.getSyntheticSettings();
+			acquisitionSettings.linewidth *= LASER_TWIN_SETTINGS{}.tuning;
+			acquisition.setSyntheticSettings(acquisitionSettings);
+			acquisition.setDetuningModel([&twin](Clock::time_point time) {
+				return twin.getDetuning(time);
+			});
+			acquisition.init();
+			acquisition.connect();
+			acquisition.setNumberSamples((int32_t)state.argument());
+			daq *dataAcquisition = &acquisition;
+
+			Locking locking(nullptr, &dataAcquisition, &laser);
+			locking.init();
+			auto step = [&]() {
+				clock.advance(std::chrono::milliseconds(locking.getLockingTimeout()));
+				QMetaObject::invokeMethod(&locking, "lock", Qt::DirectConnection);
+				waitForLaser();
+			};
+			// acquire for a while before the lock is engaged, so the steps run the controller
+			locking.startStopAcquireLocking();
+			for (gsl::index i{ 0 }; i < 100; i++) {
+				step();
+			}
+			locking.startStopLocking();
+
+			while (state.keepRunning()) {
+				step();
+			}
+			state.setItemsProcessed(state.iterations());
+
+			locking.startStopAcquireLocking();
+			waitForLaser();
+			acquisition.disconnect();
+			QMetaObject::invokeMethod(&laser, "disconnect", Qt::BlockingQueuedConnection);
+			serialThread.quit();
+			serialThread.wait();
+			Clock::set(nullptr);
+		}, blockSizes);
+	}
+
+	void addLockViewBenchmarks() {
+		benchmark::add("lockView/orderedPoints", [](BenchmarkState &state) {
+			auto lockData = wrappedLockData(state.argument());
+			while (state.keepRunning()) {
+				benchmark::doNotOptimize(lockView::orderedPoints(lockData, lockData.transmission));
+			}
+			state.setItemsProcessed(state.iterations() * state.argument());
+		}, historySizes);
+	}
+}
+
+int main(int argc, char *argv[]) {
+	QCoreApplication application(argc, argv);
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Micro-benchmarks of the numeric and data-path hot spots of LQTControl.");
+	parser.addHelpOption();
+	parser.addOptions({
+		{ "filter", "run only the benchmarks whose name matches the regular expression", "regex", "." },
+		{ "out", "write the results as JSON to the file", "file" },
+		{ "min-time", "minimum time a benchmark runs in s (default 0.5)", "s", "0.5" },
+		{ "list", "list the benchmarks instead of running them" },
+	});
+	parser.process(application);
+
+	addGeneralmathBenchmarks();
+	addDaqBenchmarks();
+	addCircularBufferBenchmarks();
+	addLockingBenchmarks();
+	addLockViewBenchmarks();
+
+	QRegularExpression filter(parser.value("filter"));
+	if (!filter.isValid()) {
+		fprintf(stderr, "Invalid filter: %s\n", qPrintable(filter.errorString()));
+		return 1;
+	}
+	double minTime = parser.value("min-time").toDouble();
+
+	std::vector<BENCHMARK_RESULT> results;
+	if (!parser.isSet("list")) {
+		printf("%-48s %14s %14s %12s %12s\n", "Benchmark", "Time [ns]", "CPU [ns]", "Iterations", "Allocations");
+	}
+	for (const auto &benchmarkCase : benchmark::cases()) {
+		// a case without arguments runs once
+		auto arguments = benchmarkCase.arguments.size() ? benchmarkCase.arguments : std::vector<int64_t>{ 0 };
+		for (auto argument : arguments) {
+			bool hasArgument = benchmarkCase.arguments.size() > 0;
+			auto name = hasArgument ? benchmarkCase.name + "/" + std::to_string(argument) : benchmarkCase.name;
+			if (!filter.match(QString::fromStdString(name)).hasMatch()) {
+				continue;
+			}
+			if (parser.isSet("list")) {
+				printf("%s\n", name.c_str());
+				continue;
+			}
+			auto result = benchmark::run(benchmarkCase, argument, hasArgument, minTime);
+			printf("%-48s %14.1f %14.1f %12llu %12.1f\n", result.name.c_str(), result.realTime, result.cpuTime, (unsigned long long)result.iterations,
+				result.allocationsPerIteration);
+			fflush(stdout);
+			results.push_back(result);
+		}
+	}
+
+	if (parser.isSet("out")) {
+		QFile file(parser.value("out"));
+		if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+			fprintf(stderr, "Could not write %s\n", qPrintable(parser.value("out")));
+			return 1;
+		}
+		file.write(benchmark::toJson(results, argv[0]).toJson(QJsonDocument::Indented));
+	}
+	return 0;
+}
\ No newline at end of file
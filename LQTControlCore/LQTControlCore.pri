@@ -0,0 +1,63 @@
+# ----------------------------------------------------
+# Core of LQTControl: data acquisition, laser, lock,
+# math and the local API. Depends on QtCore,
+# QtNetwork and QtSerialPort only.
+# Included by the core library and the executables
+# which use it.
+# ----------------------------------------------------
+
+QT = core network serialport
+CONFIG += c++14
+
+# the PicoSDK, its installation on Windows and the emulation of its drivers elsewhere,
+# e.g. qmake PICOSDK_INCLUDE=/opt/picoscope/include PICOSDK_LIBS="-L/opt/picoscope/lib -lps2000 -lps2000a"
+win32 {
+    isEmpty(PICOSDK_INCLUDE): PICOSDK_INCLUDE = "$$(ProgramW6432)/Pico Technology/SDK/inc"
+    isEmpty(PICOSDK_LIBS): PICOSDK_LIBS = -L"$$(ProgramW6432)/Pico Technology/SDK/lib" -lps2000 -lps2000a
+} else {
+    isEmpty(PICOSDK_INCLUDE): PICOSDK_INCLUDE = $$PWD/../PicoEmulator/inc
+    isEmpty(PICOSDK_LIBS): PICOSDK_LIBS = -L$$OUT_PWD/../PicoEmulator -lps2000 -lps2000a
+}
+
+INCLUDEPATH += $$PWD/../LQTControl/src \
+    $$PWD/../LQTControl/external/gsl/include \
+    $$PWD/../LQTControl/external/fmt/include \
+    $$PICOSDK_INCLUDE
+LIBS += $$PICOSDK_LIBS
+# shm_open lives in librt on older glibc
+unix:!macx:LIBS += -lrt
+HEADERS += $$PWD/../LQTControl/src/allocationCounter.h \
+    $$PWD/../LQTControl/src/circularBuffer.h \
+    $$PWD/../LQTControl/src/clock.h \
+    $$PWD/../LQTControl/src/generalmath.h \
+    $$PWD/../LQTControl/src/ipcFrame.h \
+    $$PWD/../LQTControl/src/ipcProtocol.h \
+    $$PWD/../LQTControl/src/ipcServer.h \
+    $$PWD/../LQTControl/src/locking.h \
+    $$PWD/../LQTControl/src/sharedRingLayout.h \
+    $$PWD/../LQTControl/src/sharedRingWriter.h \
+    $$PWD/../LQTControl/src/thread.h \
+    $$PWD/../LQTControl/src/timerMonitor.h \
+    $$PWD/../LQTControl/src/Devices/daq.h \
+    $$PWD/../LQTControl/src/Devices/DAQ_PS2000.h \
+    $$PWD/../LQTControl/src/Devices/DAQ_PS2000A.h \
+    $$PWD/../LQTControl/src/Devices/DAQ_Synthetic.h \
+    $$PWD/../LQTControl/src/Devices/LQT.h \
+    $$PWD/../LQTControl/src/Devices/lqtResponse.h \
+    $$PWD/../LQTControl/src/Devices/requestQueue.h \
+    $$PWD/../LQTControl/src/Devices/serialTransport.h \
+    $$PWD/../LQTControl/src/Devices/traceTransport.h
+SOURCES += $$PWD/../LQTControl/src/allocationCounter.cpp \
+    $$PWD/../LQTControl/src/clock.cpp \
+    $$PWD/../LQTControl/src/ipcServer.cpp \
+    $$PWD/../LQTControl/src/locking.cpp \
+    $$PWD/../LQTControl/src/sharedRingWriter.cpp \
+    $$PWD/../LQTControl/src/thread.cpp \
+    $$PWD/../LQTControl/src/Devices/daq.cpp \
+    $$PWD/../LQTControl/src/Devices/DAQ_PS2000.cpp \
+    $$PWD/../LQTControl/src/Devices/DAQ_PS2000A.cpp \
+    $$PWD/../LQTControl/src/Devices/DAQ_Synthetic.cpp \
+    $$PWD/../LQTControl/src/Devices/LQT.cpp \
+    $$PWD/../LQTControl/src/Devices/serialTransport.cpp \
+    $$PWD/../LQTControl/src/Devices/traceTransport.cpp \
+    $$PWD/../LQTControl/external/fmt/src/format.cc
\ No newline at end of file
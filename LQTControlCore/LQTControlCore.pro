@@ -0,0 +1,9 @@
+# ----------------------------------------------------
+# Static library of the core of LQTControl, without
+# QtGui and QtWidgets.
+# ----------------------------------------------------
+
+TEMPLATE = lib
+TARGET = LQTControlCore
+CONFIG += staticlib
+include(LQTControlCore.pri)
\ No newline at end of file
@@ -0,0 +1,15 @@
+# ----------------------------------------------------
+# Runs the scan and the lock from a configuration file
+# without a user interface. Uses QtCore, QtNetwork
+# and QtSerialPort only.
+# ----------------------------------------------------
+
+TEMPLATE = app
+TARGET = LQTControlHeadless
+CONFIG += console
+CONFIG -= app_bundle
+include(../LQTControlCore/LQTControlCore.pri)
+INCLUDEPATH += ./src
+HEADERS += ./src/headlessControl.h
+SOURCES += ./src/main.cpp \
+    ./src/headlessControl.cpp
\ No newline at end of file
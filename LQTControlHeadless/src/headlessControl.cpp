@@ -0,0 +1,504 @@
+#include "headlessControl.h"
+#include "Devices/DAQ_PS2000.h"
+#include "Devices/DAQ_PS2000A.h"
+#include "Devices/DAQ_Synthetic.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <utility>
+#include <vector>
+
+namespace {
+	// the lock parameters which are plain numbers or switches, the key in the [lock] section and the parameter
+	const std::vector<std::pair<QString, LOCKPARAMETERS>> lockParameters{
+		{ "p", LOCKPARAMETERS::P },
+		{ "i", LOCKPARAMETERS::I },
+		{ "d", LOCKPARAMETERS::D },
+		{ "setpoint", LOCKPARAMETERS::SETPOINT },
+		{ "pipelined", LOCKPARAMETERS::PIPELINED },
+		{ "adaptive", LOCKPARAMETERS::ADAPTIVE },
+		{ "minTimeout", LOCKPARAMETERS::MINTIMEOUT },
+		{ "maxTimeout", LOCKPARAMETERS::MAXTIMEOUT },
+		{ "fastError", LOCKPARAMETERS::FASTERROR },
+		{ "fastErrorRate", LOCKPARAMETERS::FASTERRORRATE },
+		{ "stableError", LOCKPARAMETERS::STABLEERROR },
+		{ "samplesPerUpdate", LOCKPARAMETERS::SAMPLESPERUPDATE },
+		{ "analogScaling", LOCKPARAMETERS::ANALOGSCALING },
+		{ "analogOffset", LOCKPARAMETERS::ANALOGOFFSET },
+		{ "crossover", LOCKPARAMETERS::CROSSOVER },
+		{ "desaturationRate", LOCKPARAMETERS::DESATURATIONRATE }
+	};
+
+	const std::vector<std::pair<QString, SCANPARAMETERS>> scanParameters{
+		{ "low", SCANPARAMETERS::LOW },
+		{ "high", SCANPARAMETERS::HIGH },
+		{ "steps", SCANPARAMETERS::STEPS },
+		{ "interval", SCANPARAMETERS::INTERVAL }
+	};
+
+	// INI files only know strings, the switches are written as true and false
+	bool toNumber(const QVariant &value, double &number) {
+		auto string = value.toString().trimmed().toLower();
+		if (string == "true" || string == "false") {
+			number = (string == "true");
+			return true;
+		}
+		bool ok{ false };
+		number = string.toDouble(&ok);
+		return ok;
+	}
+}
+
+HeadlessControl::HeadlessControl(QObject *parent) noexcept :
+	QObject(parent) {
+	qRegisterMetaType<ACQUISITION_PARAMETERS>("ACQUISITION_PARAMETERS");
+	qRegisterMetaType<LOCKSTATE>("LOCKSTATE");
+	qRegisterMetaType<LQT_SETTINGS>("LQT_SETTINGS");
+	qRegisterMetaType<TIMER_STATISTICS>("TIMER_STATISTICS");
+	qRegisterMetaType<THREAD_SETTINGS>("THREAD_SETTINGS");
+	qRegisterMetaType<COMMAND_STATISTICS>("COMMAND_STATISTICS");
+	qRegisterMetaType<PRIORITY_STATISTICS>("PRIORITY_STATISTICS");
+	qRegisterMetaType<VERIFICATION_STATISTICS>("VERIFICATION_STATISTICS");
+
+	m_laserControl = new LQT();
+	m_lockingControl = new Locking(nullptr, &m_dataAcquisition, m_laserControl);
+}
+
+HeadlessControl::~HeadlessControl() {
+	stop();
+	// the threads are finished, so the workers can be deleted from here
+	delete m_lockingControl;
+	delete m_dataAcquisition;
+	delete m_laserControl;
+}
+
+bool HeadlessControl::configure(QSettings &config) {
+	m_settings.scan = false;
+	m_settings.lock = false;
+	for (auto part : config.value("run/mode", "lock").toString().split(",")) {
+		part = part.trimmed().toLower();
+		if (part == "scan") {
+			m_settings.scan = true;
+		} else if (part == "lock") {
+			m_settings.lock = true;
+		} else {
+			qCritical("Unknown mode %s, use scan, lock or scan,lock.", qPrintable(part));
+			return false;
+		}
+	}
+	m_settings.settle = config.value("run/settle", m_settings.settle).toDouble();
+	m_settings.duration = config.value("run/duration", m_settings.duration).toDouble();
+	m_settings.statusInterval = config.value("run/statusInterval", m_settings.statusInterval).toInt();
+	if (config.contains("lock/temperature")) {
+		m_settings.temperature = config.value("lock/temperature").toDouble();
+	}
+	m_settings.scanFile = config.value("scan/file", m_settings.scanFile).toString();
+
+	// data acquisition, the device is required, so a typo in the file does not run on synthetic data
+	if (!config.contains("daq/device")) {
+		qCritical("The configuration has to select the device with daq/device, use PS2000, PS2000A or Synthetic.");
+		return false;
+	}
+	auto device = config.value("daq/device").toString();
+	if (device.compare("PS2000", Qt::CaseInsensitive) == 0) {
+		m_settings.device = PS_TYPES::MODEL_PS2000;
+	} else if (device.compare("PS2000A", Qt::CaseInsensitive) == 0) {
+		m_settings.device = PS_TYPES::MODEL_PS2000A;
+	} else if (device.compare("Synthetic", Qt::CaseInsensitive) == 0) {
+		m_settings.device = PS_TYPES::MODEL_SYNTHETIC;
+	} else {
+		qCritical("Unknown device %s, use PS2000, PS2000A or Synthetic.", qPrintable(device));
+		return false;
+	}
+	m_settings.sampleRate = config.value("daq/sampleRate", m_settings.sampleRate).toInt();
+	m_settings.samples = config.value("daq/samples", m_settings.samples).toInt();
+	m_settings.ranges[0] = config.value("daq/rangeA", m_settings.ranges[0]).toInt();
+	m_settings.ranges[1] = config.value("daq/rangeB", m_settings.ranges[1]).toInt();
+	m_settings.ipcName = config.value("ipc/name", m_settings.ipcName).toString();
+	m_settings.ringName = config.value("shm/name", m_settings.ringName).toString();
+
+	// laser, the environment variables of LQT apply unless the file sets the port
+	if (config.contains("laser/port")) {
+		m_laserControl->setPort(config.value("laser/port").toString().toStdString(), config.value("laser/baudRate", 19200).toInt());
+	}
+	if (config.contains("laser/trace")) {
+		m_laserControl->setTraceFile(config.value("laser/trace").toString().toStdString());
+	}
+	m_laserControl->setStatusPollingInterval(config.value("laser/statusPollingInterval", 10000).toInt());
+
+	// lock and scan
+	for (const auto &parameter : lockParameters) {
+		auto key = "lock/" + parameter.first;
+		if (!config.contains(key)) {
+			continue;
+		}
+		double value;
+		if (!toNumber(config.value(key), value)) {
+			qCritical("Invalid value %s of %s.", qPrintable(config.value(key).toString()), qPrintable(key));
+			return false;
+		}
+		// the lock warns about a value out of range
+		if (!m_lockingControl->setLockParameters(parameter.second, value)) {
+			qCritical("Invalid value %s of %s.", qPrintable(config.value(key).toString()), qPrintable(key));
+			return false;
+		}
+	}
+	// the limits are set together, a new range need not overlap the default one
+	double analogRange[2]{ m_lockingControl->getLockSettings().analogMinVoltage, m_lockingControl->getLockSettings().analogMaxVoltage };
+	const char *analogKeys[2]{ "lock/analogMin", "lock/analogMax" };
+	for (int i{ 0 }; i < 2; i++) {
+		if (config.contains(analogKeys[i]) && !toNumber(config.value(analogKeys[i]), analogRange[i])) {
+			qCritical("Invalid value %s of %s.", qPrintable(config.value(analogKeys[i]).toString()), analogKeys[i]);
+			return false;
+		}
+	}
+	if (!m_lockingControl->setAnalogRange(analogRange[0], analogRange[1])) {
+		qCritical("Invalid range of lock/analogMin and lock/analogMax.");
+		return false;
+	}
+	auto timebase = config.value("lock/timebase", "host").toString().toLower();
+	if (timebase != "host" && timebase != "sampleclock") {
+		qCritical("Unknown timebase %s, use host or sampleclock.", qPrintable(timebase));
+		return false;
+	}
+	m_lockingControl->setLockParameters(LOCKPARAMETERS::TIMEBASE, (timebase == "sampleclock") ? LOCKTIMEBASE::SAMPLECLOCK : LOCKTIMEBASE::HOSTTIMER);
+	auto actuator = config.value("lock/actuator", "temperature").toString().toLower();
+	if (actuator != "temperature" && actuator != "analog" && actuator != "dual") {
+		qCritical("Unknown actuator %s, use temperature, analog or dual.", qPrintable(actuator));
+		return false;
+	}
+	m_lockingControl->setLockParameters(LOCKPARAMETERS::ACTUATOR, (actuator == "analog") ? LOCKACTUATOR::ANALOG
+		: ((actuator == "dual") ? LOCKACTUATOR::DUAL : LOCKACTUATOR::TEMPERATURE));
+	for (const auto &parameter : scanParameters) {
+		auto key = "scan/" + parameter.first;
+		if (!config.contains(key)) {
+			continue;
+		}
+		double value;
+		if (!toNumber(config.value(key), value)) {
+			qCritical("Invalid value %s of %s.", qPrintable(config.value(key).toString()), qPrintable(key));
+			return false;
+		}
+		// the lock warns about a value out of range
+		if (!m_lockingControl->setScanParameters(parameter.second, value)) {
+			qCritical("Invalid value %s of %s.", qPrintable(config.value(key).toString()), qPrintable(key));
+			return false;
+		}
+	}
+
+	m_controlThread.setSettings(readThreadSettings(config, THREAD_ROLE::CONTROL));
+	m_serialThread.setSettings(readThreadSettings(config, THREAD_ROLE::SERIAL));
+	return true;
+}
+
+// The settings of a thread role in the [control] or [serial] section, the defaults of the role otherwise
+THREAD_SETTINGS HeadlessControl::readThreadSettings(QSettings &config, THREAD_ROLE role) {
+	THREAD_SETTINGS settings = getDefaultThreadSettings(role);
+	config.beginGroup((role == THREAD_ROLE::CONTROL) ? "control" : "serial");
+	settings.cpu = config.value("cpu", settings.cpu).toInt();
+	settings.realtime = config.value("realtime", settings.realtime).toBool();
+	settings.priority = config.value("priority", settings.priority).toInt();
+	settings.niceness = config.value("niceness", settings.niceness).toInt();
+	settings.lockMemory = config.value("lockMemory", settings.lockMemory).toBool();
+	config.endGroup();
+	return settings;
+}
+
+void HeadlessControl::start() {
+	switch (m_settings.device) {
+		case PS_TYPES::MODEL_PS2000:
+			m_dataAcquisition = new daq_PS2000(nullptr);
+			break;
+		case PS_TYPES::MODEL_PS2000A:
+			m_dataAcquisition = new daq_PS2000A(nullptr);
+			break;
+		default:
+			m_dataAcquisition = new daq_Synthetic(nullptr);
+			break;
+	}
+
+	// the states are needed right after the blocking calls, so they are set on the threads which change them
+	QMetaObject::Connection connection = QObject::connect(m_laserControl, &LQT::connected, this, [this](bool connected) {
+		m_laserConnected = connected;
+	}, Qt::DirectConnection);
+	connection = QObject::connect(m_dataAcquisition, &daq::connected, this, [this](bool connected) {
+		m_daqConnected = connected;
+	}, Qt::DirectConnection);
+	connection = QObject::connect(m_lockingControl, &Locking::s_scanRunning, this, [this](bool running) {
+		m_scanRunning = running;
+	}, Qt::DirectConnection);
+	connection = QObject::connect(m_lockingControl, &Locking::s_acquireLockingRunning, this, [this](bool running) {
+		m_acquireLockingRunning = running;
+	}, Qt::DirectConnection);
+	connection = QObject::connect(m_lockingControl, &Locking::lockStateChanged, this, [this](LOCKSTATE state) {
+		m_lockState = state;
+	}, Qt::DirectConnection);
+
+	connection = QObject::connect(m_lockingControl, &Locking::s_scanRunning, this, [this](bool running) {
+		if (!running) {
+			finishScan();
+		}
+	});
+	connection = QObject::connect(m_lockingControl, &Locking::lockStateChanged, this, &HeadlessControl::lockStateChanged);
+	connection = QObject::connect(m_lockingControl, &Locking::timingStatisticsChanged, this, [this](TIMER_STATISTICS statistics) {
+		if (statistics.timer != TIMERS::LOCKINGTIMER) {
+			return;
+		}
+		if (statistics.rateKept != m_lockingStatistics.rateKept && !statistics.rateKept) {
+			qWarning("The lock loop cannot keep its period of %d ms: mean interval %.1f ms, jitter %.1f ms.",
+				statistics.period, statistics.meanInterval, statistics.jitter);
+		}
+		m_lockingStatistics = statistics;
+	});
+	for (auto thread : { &m_controlThread, &m_serialThread }) {
+		connection = QObject::connect(thread, &Thread::settingsApplied, this, [](THREAD_SETTINGS settings) {
+			qInfo("Thread %d runs on CPU %d with %s priority %d (nice %d), memory %s.",
+				(int)settings.role, settings.cpu, settings.realtime ? "real-time" : "normal", settings.priority,
+				settings.niceness, settings.lockMemory ? "locked" : "not locked");
+		});
+	}
+
+	if (m_settings.ringName.size() > 0) {
+		auto name = m_settings.ringName.toStdString();
+		if (m_liveRing.openLive(name + "-live", 64, DAQ_MAX_CHANNELS, DAQ_BUFFER_SIZE)) {
+			m_dataAcquisition->setSharedRing(&m_liveRing);
+		} else {
+			qWarning("Could not create the shared live ring: %s", m_liveRing.errorString().c_str());
+		}
+		if (m_lockRing.openLock(name + "-lock", 65536)) {
+			m_lockingControl->setSharedRing(&m_lockRing);
+		} else {
+			qWarning("Could not create the shared lock ring: %s", m_lockRing.errorString().c_str());
+		}
+	}
+
+	m_controlThread.startWorker(m_dataAcquisition);
+	m_controlThread.startWorker(m_lockingControl);
+	m_serialThread.startWorker(m_laserControl);
+
+	if (m_settings.ipcName.size() > 0) {
+		m_ipcServer = new IpcServer(this, &m_dataAcquisition, m_lockingControl, m_laserControl);
+		m_ipcServer->m_lockSettleTime = (int)(1000 * m_settings.settle);
+		m_ipcServer->listen(m_settings.ipcName);
+	}
+
+	QMetaObject::invokeMethod(m_laserControl, &LQT::connect, Qt::BlockingQueuedConnection);
+	if (!m_laserConnected) {
+		qCritical("Could not connect to the laser.");
+		stop(2);
+		return;
+	}
+	qInfo("Connected to the laser.");
+	QMetaObject::invokeMethod(m_dataAcquisition, &daq::connect, Qt::BlockingQueuedConnection);
+	if (!m_daqConnected) {
+		qCritical("Could not connect to the data acquisition.");
+		stop(2);
+		return;
+	}
+	configureAcquisition();
+
+	if (m_settings.statusInterval > 0) {
+		m_statusTimer = new QTimer(this);
+		connection = QObject::connect(m_statusTimer, &QTimer::timeout, this, &HeadlessControl::logStatus);
+		m_statusTimer->start(1000 * m_settings.statusInterval);
+	}
+
+	if (m_settings.scan) {
+		auto scanSettings = m_lockingControl->getScanSettings();
+		qInfo("Scanning from %.3f K to %.3f K in %d steps of %d s.", scanSettings.low, scanSettings.high, scanSettings.nrSteps, scanSettings.interval);
+		QMetaObject::invokeMethod(m_lockingControl, &Locking::startScan, Qt::QueuedConnection);
+	} else {
+		startLock();
+	}
+}
+
+// Applies the settings of the acquisition on its thread, the device has to be connected
+void HeadlessControl::configureAcquisition() {
+	QMetaObject::invokeMethod(m_dataAcquisition, [this]() {
+		auto nrSamplingRates = (int)m_dataAcquisition->getSamplingRates().size();
+		if (m_settings.sampleRate >= nrSamplingRates) {
+			qWarning("The device has %d sampling rates, the sampling rate %d is ignored.", nrSamplingRates, m_settings.sampleRate);
+		} else if (m_settings.sampleRate >= 0) {
+			m_dataAcquisition->setSampleRate(m_settings.sampleRate);
+		}
+		for (int ch{ 0 }; ch < 2; ch++) {
+			if (m_settings.ranges[ch] >= 0) {
+				m_dataAcquisition->setRange(m_settings.ranges[ch], ch);
+			}
+		}
+		if (m_settings.samples > 0) {
+			m_dataAcquisition->setNumberSamples(m_settings.samples);
+		}
+	}, Qt::BlockingQueuedConnection);
+	auto parameters = m_dataAcquisition->getAcquisitionParameters();
+	qInfo("Acquiring %u samples per block at %.0f S/s.", parameters.no_of_samples, m_dataAcquisition->getSamplingRates()[parameters.timebaseIndex]);
+}
+
+// Reports the minimum of the scan, writes it and picks the temperature the lock starts at
+void HeadlessControl::finishScan() {
+	if (m_stopping) {
+		return;
+	}
+	const auto &scanData = m_lockingControl->scanData;
+	gsl::index minimum{ -1 };
+	gsl::index closest{ -1 };
+	double setpoint = m_lockingControl->getLockSettings().transmissionSetpoint;
+	for (gsl::index i{ 0 }; i < (gsl::index)scanData.transmission.size(); i++) {
+		if (std::isnan(scanData.transmission[i])) {
+			continue;
+		}
+		if (minimum < 0 || scanData.transmission[i] < scanData.transmission[minimum]) {
+			minimum = i;
+		}
+		if (closest < 0 || std::abs(scanData.transmission[i] - setpoint) < std::abs(scanData.transmission[closest] - setpoint)) {
+			closest = i;
+		}
+	}
+	if (minimum < 0) {
+		qCritical("The scan acquired no data.");
+		stop(2);
+		return;
+	}
+	qInfo("Scan finished, minimum transmission %.4f at %.4f K.", scanData.transmission[minimum], scanData.temperatures[minimum]);
+
+	if (m_settings.scanFile.size() > 0) {
+		QFile file(m_settings.scanFile);
+		if (file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+			QTextStream stream(&file);
+			stream << "temperature,absorption,reference,quotient,transmission\n";
+			for (gsl::index i{ 0 }; i < scanData.nrSteps; i++) {
+				stream << scanData.temperatures[i] << "," << scanData.absorption[i] << "," << scanData.reference[i] << ","
+					<< scanData.quotient[i] << "," << scanData.transmission[i] << "\n";
+			}
+		} else {
+			qWarning("Could not write the scan to %s.", qPrintable(m_settings.scanFile));
+		}
+	}
+
+	if (!m_settings.lock) {
+		stop();
+		return;
+	}
+	// the lock starts on the slope, where the transmission is closest to the setpoint
+	if (std::isnan(m_settings.temperature)) {
+		m_settings.temperature = scanData.temperatures[closest];
+	}
+	startLock();
+}
+
+// Acquires for the settle time, then engages the lock
+void HeadlessControl::startLock() {
+	if (!std::isnan(m_settings.temperature)) {
+		qInfo("Setting the temperature offset to %.4f K.", m_settings.temperature);
+		m_laserControl->setTemperatureAsync(m_settings.temperature, LQT_PRIORITY::USER).wait();
+	}
+	if (!m_acquireLockingRunning) {
+		QMetaObject::invokeMethod(m_lockingControl, &Locking::startStopAcquireLocking, Qt::BlockingQueuedConnection);
+	}
+	if (!m_acquireLockingRunning) {
+		qCritical("Could not start the acquisition of the lock.");
+		stop(2);
+		return;
+	}
+	QTimer::singleShot((int)(1000 * m_settings.settle), this, [this]() {
+		if (m_stopping) {
+			return;
+		}
+		QMetaObject::invokeMethod(m_lockingControl, &Locking::startStopLocking, Qt::BlockingQueuedConnection);
+		if (m_settings.duration > 0) {
+			QTimer::singleShot((int)(1000 * m_settings.duration), this, [this]() {
+				qInfo("Locked for %.0f s.", m_settings.duration);
+				stop();
+			});
+		}
+	});
+}
+
+void HeadlessControl::lockStateChanged(LOCKSTATE state) {
+	switch (state) {
+		case LOCKSTATE::ACTIVE:
+			qInfo("Lock engaged.");
+			break;
+		case LOCKSTATE::INACTIVE:
+			qInfo("Lock released.");
+			break;
+		case LOCKSTATE::FAILURE:
+			qCritical("The lock failed, the temperature offset left the allowed range.");
+			stop(3);
+			break;
+	}
+}
+
+void HeadlessControl::logStatus() {
+	if (!m_scanRunning && !m_acquireLockingRunning) {
+		return;
+	}
+	// the scan and lock data are written on the control thread, so they are read there
+	int pass{ 0 };
+	int nrSteps{ 0 };
+	bool stored{ false };
+	double error{ 0 };
+	double transmission{ 0 };
+	double tempOffset{ 0 };
+	QMetaObject::invokeMethod(m_lockingControl, [this, &pass, &nrSteps, &stored, &error, &transmission, &tempOffset]() {
+		pass = m_lockingControl->scanData.pass;
+		nrSteps = m_lockingControl->scanData.nrSteps;
+		const auto &lockData = m_lockingControl->lockData;
+		if (lockData.storageSize == 0 || (lockData.nextIndex == 0 && !lockData.wrapped)) {
+			return;
+		}
+		auto index = generalmath::indexWrapped((int)lockData.nextIndex - 1, lockData.storageSize);
+		stored = true;
+		error = lockData.error[index];
+		transmission = lockData.transmission[index];
+		tempOffset = lockData.tempOffset[index];
+	}, Qt::BlockingQueuedConnection);
+	if (m_scanRunning) {
+		qInfo("Scan step %d of %d.", pass + 1, nrSteps);
+		return;
+	}
+	if (!stored) {
+		return;
+	}
+	qInfo("%s: error %.4f, transmission %.4f, temperature offset %.4f K, interval %.1f ms (jitter %.1f ms), %llu overruns, %llu allocating updates.",
+		(m_lockState == LOCKSTATE::ACTIVE) ? "Locked" : "Acquiring", error, transmission, tempOffset,
+		m_lockingStatistics.meanInterval, m_lockingStatistics.jitter, (unsigned long long)m_lockingStatistics.overruns,
+		(unsigned long long)m_lockingStatistics.allocatingTicks);
+}
+
+void HeadlessControl::stop(int exitCode) {
+	if (m_stopping) {
+		return;
+	}
+	m_stopping = true;
+	if (m_statusTimer) {
+		m_statusTimer->stop();
+	}
+	if (m_ipcServer) {
+		m_ipcServer->close();
+	}
+	// the slots toggle, so they are only called if the scan or the lock is running
+	if (m_controlThread.isRunning()) {
+		if (m_scanRunning) {
+			QMetaObject::invokeMethod(m_lockingControl, &Locking::startScan, Qt::BlockingQueuedConnection);
+		}
+		if (m_lockState == LOCKSTATE::ACTIVE) {
+			QMetaObject::invokeMethod(m_lockingControl, &Locking::startStopLocking, Qt::BlockingQueuedConnection);
+		}
+		if (m_acquireLockingRunning) {
+			QMetaObject::invokeMethod(m_lockingControl, &Locking::startStopAcquireLocking, Qt::BlockingQueuedConnection);
+		}
+		if (m_daqConnected) {
+			QMetaObject::invokeMethod(m_dataAcquisition, &daq::disconnect, Qt::BlockingQueuedConnection);
+		}
+	}
+	if (m_serialThread.isRunning() && m_laserConnected) {
+		QMetaObject::invokeMethod(m_laserControl, &LQT::disconnect, Qt::BlockingQueuedConnection);
+	}
+	m_controlThread.exit();
+	m_controlThread.wait();
+	m_serialThread.exit();
+	m_serialThread.wait();
+	qInfo("Stopped.");
+	emit finished(exitCode);
+}
\ No newline at end of file
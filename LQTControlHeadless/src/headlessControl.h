@@ -0,0 +1,84 @@
+#ifndef HEADLESSCONTROL_H
+#define HEADLESSCONTROL_H
+
+#include <QtCore>
+#include <atomic>
+#include <cmath>
+
+#include "Devices/daq.h"
+#include "Devices/LQT.h"
+#include "ipcServer.h"
+#include "locking.h"
+#include "sharedRingWriter.h"
+#include "thread.h"
+
+typedef struct HEADLESS_SETTINGS {
+	bool scan{ false };								//		run a scan first
+	bool lock{ true };								//		lock, after the scan if there is one
+	double settle{ 5 };								// [s]	time the acquisition runs before the lock is engaged
+	double duration{ 0 };							// [s]	time to lock, 0 to lock until a signal arrives
+	double temperature{ NAN };						// [K]	temperature offset the lock starts at, by default the one found by the scan or the current one
+	int statusInterval{ 10 };						// [s]	interval of the status log, 0 to disable it
+	QString scanFile{ "" };							//		writes the scan to this file as CSV if set
+	PS_TYPES device{ PS_TYPES::MODEL_SYNTHETIC };	//		data acquisition to use
+	int sampleRate{ -1 };							//		index of the sampling rate, -1 for the default of the device
+	int samples{ 0 };								//		number of samples per block, 0 for the default
+	int ranges[2]{ -1, -1 };						//		index of the input range of channel A and B as in the settings dialog, -1 for the default
+	QString ipcName{ "" };							//		name of the socket of the local API, not served if empty
+	QString ringName{ "" };							//		prefix of the shared memory rings, not exported if empty
+} HEADLESS_SETTINGS;
+
+/*
+ * Runs the scan and the lock without a user interface. The lock and the acquisition live on the
+ * control thread and the laser on the serial thread, like in LQTControl. The configuration is read
+ * from an INI file, see LQTControlHeadless/lqtcontrol.ini.
+ */
+class HeadlessControl : public QObject {
+	Q_OBJECT
+
+public:
+	explicit HeadlessControl(QObject *parent = nullptr) noexcept;
+	~HeadlessControl();
+
+	// returns false if the configuration is invalid
+	bool configure(QSettings &config);
+
+public slots:
+	void start();
+	// stops the scan and the lock and closes the devices, finished() is emitted afterwards
+	void stop(int exitCode = 0);
+
+signals:
+	void finished(int exitCode);
+
+private:
+	HEADLESS_SETTINGS m_settings;
+
+	Thread m_controlThread{ THREAD_ROLE::CONTROL };	// hosts the lock loop and the acquisition
+	Thread m_serialThread{ THREAD_ROLE::SERIAL };	// hosts the serial communication with the laser
+	LQT *m_laserControl{ nullptr };
+	daq *m_dataAcquisition{ nullptr };
+	Locking *m_lockingControl{ nullptr };
+	IpcServer *m_ipcServer{ nullptr };
+	SharedRingWriter m_liveRing;	// written from the control thread, so they have to outlive it
+	SharedRingWriter m_lockRing;
+
+	// set on the threads of the devices, so they are current when a blocking call returns
+	std::atomic<bool> m_laserConnected{ false };
+	std::atomic<bool> m_daqConnected{ false };
+	std::atomic<bool> m_scanRunning{ false };
+	std::atomic<bool> m_acquireLockingRunning{ false };
+	std::atomic<LOCKSTATE> m_lockState{ LOCKSTATE::INACTIVE };
+	bool m_stopping{ false };
+	TIMER_STATISTICS m_lockingStatistics;
+	QTimer *m_statusTimer{ nullptr };
+
+	void configureAcquisition();
+	void startLock();
+	void finishScan();
+	void logStatus();
+	void lockStateChanged(LOCKSTATE state);
+	THREAD_SETTINGS readThreadSettings(QSettings &config, THREAD_ROLE role);
+};
+
+#endif // HEADLESSCONTROL_H
\ No newline at end of file
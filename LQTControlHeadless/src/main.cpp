@@ -0,0 +1,128 @@
+/*
+ * Runs the scan and the lock of LQTControl without a user interface, e.g. on a lab PC
+ * without a display or as a service:
+ *
+ *   LQTControlHeadless --config lqtcontrol.ini
+ *
+ * SIGINT and SIGTERM stop the lock, close the devices and exit with 0. The exit code is 1
+ * for an invalid configuration, 2 if a device could not be used and 3 if the lock failed.
+ */
+#include "headlessControl.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QTextStream>
+#include <csignal>
+#include <cstdio>
+
+namespace {
+	// the handler may only set the flag, a timer of the event loop checks it
+	volatile std::sig_atomic_t receivedSignal{ 0 };
+
+	void signalHandler(int signal) {
+		receivedSignal = signal;
+	}
+
+	QtMsgType minimumLevel{ QtInfoMsg };
+	QFile logFile;
+	QMutex logMutex;
+
+	int severity(QtMsgType type) {
+		switch (type) {
+			case QtDebugMsg:
+				return 0;
+			case QtInfoMsg:
+				return 1;
+			case QtWarningMsg:
+				return 2;
+			case QtCriticalMsg:
+				return 3;
+			default:
+				return 4;
+		}
+	}
+
+	// writes every message with a timestamp to stderr and the log file, the worker threads log as well
+	void messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &message) {
+		Q_UNUSED(context);
+		if (severity(type) < severity(minimumLevel)) {
+			return;
+		}
+		static const char *levels[]{ "debug", "info", "warning", "critical", "fatal" };
+		auto line = QString("%1 %2 %3\n").arg(QDateTime::currentDateTime().toString(Qt::ISODateWithMs), levels[severity(type)], message).toLocal8Bit();
+		QMutexLocker locker(&logMutex);
+		fputs(line.constData(), stderr);
+		fflush(stderr);
+		if (logFile.isOpen()) {
+			logFile.write(line);
+			logFile.flush();
+		}
+	}
+}
+
+int main(int argc, char *argv[]) {
+	QCoreApplication application(argc, argv);
+	QCoreApplication::setApplicationName("LQTControlHeadless");
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Runs the scan and the lock of LQTControl without a user interface.");
+	parser.addHelpOption();
+	parser.addOptions({
+		{ "config", "configuration file (default lqtcontrol.ini)", "file", "lqtcontrol.ini" },
+	});
+	parser.process(application);
+
+	auto configFile = parser.value("config");
+	if (!QFileInfo::exists(configFile)) {
+		fprintf(stderr, "The configuration file %s does not exist.\n", qPrintable(configFile));
+		return 1;
+	}
+	QSettings config(configFile, QSettings::IniFormat);
+
+	auto level = config.value("log/level", "info").toString().toLower();
+	if (level == "debug") {
+		minimumLevel = QtDebugMsg;
+	} else if (level == "warning") {
+		minimumLevel = QtWarningMsg;
+	} else if (level == "critical") {
+		minimumLevel = QtCriticalMsg;
+	}
+	if (config.contains("log/file")) {
+		logFile.setFileName(config.value("log/file").toString());
+		if (!logFile.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+			fprintf(stderr, "Could not open the log file %s.\n", qPrintable(logFile.fileName()));
+			return 1;
+		}
+	}
+	qInstallMessageHandler(messageHandler);
+
+	HeadlessControl control;
+	if (!control.configure(config)) {
+		return 1;
+	}
+	QMetaObject::Connection connection = QObject::connect(&control, &HeadlessControl::finished, &application, &QCoreApplication::exit, Qt::QueuedConnection);
+
+	std::signal(SIGINT, signalHandler);
+	std::signal(SIGTERM, signalHandler);
+#ifdef SIGBREAK
+	std::signal(SIGBREAK, signalHandler);
+#endif
+	QTimer signalTimer;
+	connection = QObject::connect(&signalTimer, &QTimer::timeout, &control, [&control]() {
+		if (receivedSignal) {
+			qInfo("Received signal %d, stopping.", (int)receivedSignal);
+			receivedSignal = 0;
+			control.stop();
+		}
+	});
+	signalTimer.start(100);
+
+	QTimer::singleShot(0, &control, &HeadlessControl::start);
+	int exitCode = application.exec();
+
+	qInstallMessageHandler(nullptr);
+	return exitCode;
+}
\ No newline at end of file
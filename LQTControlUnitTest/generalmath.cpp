@@ -206,5 +206,41 @@ namespace FPIControlUnitTest {
 				Assert::AreEqual(gsl::index{ 9 }, generalmath::indexWrapped(9, 10));
 				Assert::AreEqual(gsl::index{ 0 }, generalmath::indexWrapped(10, 10));
 			}
+
+			TEST_METHOD(TestMethodLowpassStep) {
+				// after one time constant a step has risen to 1 - 1/e
+				double tau = 1 / (2 * 3.14159265358979323846);
+				Assert::AreEqual(1 - exp(-1.0), generalmath::lowpass(0, 1, 1, tau), 1e-12);
+				Assert::AreEqual(2.0, generalmath::lowpass(2, 5, 1, 0));
+				Assert::AreEqual(5.0, generalmath::lowpass(2, 5, 1, 100), 1e-12);
+			}
+
+			TEST_METHOD(TestMethodLowpassSplit) {
+				// a constant offset ends up in the low-pass part, a fast alternating one in the remainder
+				double filtered{ 0 };
+				double value{ 0 };
+				for (int i{ 0 }; i < 1000; i++) {
+					value = 1.0 + ((i % 2 == 0) ? 0.5 : -0.5);
+					filtered = generalmath::lowpass(filtered, value, 0.1, 0.1);
+				}
+				Assert::AreEqual(1.0, filtered, 0.05);
+				Assert::AreEqual(0.5, abs(value - filtered), 0.05);
+			}
+
+			TEST_METHOD(TestMethodLinspaceInPlace) {
+				// the values are written to the buffer of the vector, which is not reallocated
+				std::vector<double> values;
+				values.reserve(10);
+				const double *buffer = values.data();
+				values.resize(5);
+				generalmath::linspace(-1.0, 1.0, values);
+				Assert::IsTrue(buffer == values.data());
+				Assert::AreEqual(-1.0, values[0]);
+				Assert::AreEqual(-0.5, values[1], 1e-12);
+				Assert::AreEqual(1.0, values[4], 1e-12);
+				values.resize(1);
+				generalmath::linspace(2.0, 3.0, values);
+				Assert::AreEqual(2.0, values[0]);
+			}
 	};
 }
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include "stdafx.h"
+#include "..\LQTControl\src\ipcFrame.h"
+
+#include <string>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FPIControlUnitTest {
+	TEST_CLASS(IpcFrameTest) {
+		public:
+			// A written frame is read back with its header
+			TEST_METHOD(TestMethodRoundTrip) {
+				IPC_HEADER written;
+				written.size = 3;
+				written.type = 0x85;
+				written.tag = 0xBEEF;
+				std::string frame(IPC_HEADER_SIZE, '\0');
+				ipc::writeHeader(&frame[0], written);
+				frame += "abc";
+				IPC_HEADER header;
+				Assert::AreEqual((int)IPC_FRAME_COMPLETE, (int)ipc::parseFrame(frame.data(), frame.size(), header));
+				Assert::AreEqual((uint32_t)3, header.size);
+				Assert::AreEqual((uint16_t)0x85, header.type);
+				Assert::AreEqual((uint16_t)0xBEEF, header.tag);
+			}
+
+			// The header is little-endian with the magic first
+			TEST_METHOD(TestMethodByteOrder) {
+				IPC_HEADER written;
+				written.size = 0x01020304;
+				written.type = 0x0506;
+				written.tag = 0x0708;
+				char frame[IPC_HEADER_SIZE];
+				ipc::writeHeader(frame, written);
+				Assert::AreEqual(std::string("LQTC"), std::string(frame, 4));
+				Assert::AreEqual(0x04, (int)frame[4]);
+				Assert::AreEqual(0x01, (int)frame[7]);
+				Assert::AreEqual(0x06, (int)frame[8]);
+				Assert::AreEqual(0x08, (int)frame[10]);
+			}
+
+			// A frame is incomplete until its header and its whole payload arrived
+			TEST_METHOD(TestMethodPartial) {
+				IPC_HEADER written;
+				written.size = 4;
+				std::string frame(IPC_HEADER_SIZE, '\0');
+				ipc::writeHeader(&frame[0], written);
+				frame += "data";
+				IPC_HEADER header;
+				for (size_t size{ 0 }; size < frame.size(); size++) {
+					Assert::AreEqual((int)IPC_FRAME_INCOMPLETE, (int)ipc::parseFrame(frame.data(), size, header));
+				}
+				Assert::AreEqual((int)IPC_FRAME_COMPLETE, (int)ipc::parseFrame(frame.data(), frame.size(), header));
+			}
+
+			// The bytes of the next frame do not belong to the current one
+			TEST_METHOD(TestMethodFollowingFrame) {
+				IPC_HEADER written;
+				std::string frames(2 * IPC_HEADER_SIZE, '\0');
+				ipc::writeHeader(&frames[0], written);
+				written.tag = 2;
+				ipc::writeHeader(&frames[IPC_HEADER_SIZE], written);
+				IPC_HEADER header;
+				Assert::AreEqual((int)IPC_FRAME_COMPLETE, (int)ipc::parseFrame(frames.data(), frames.size(), header));
+				Assert::AreEqual((uint16_t)0, header.tag);
+				Assert::AreEqual((int)IPC_FRAME_COMPLETE, (int)ipc::parseFrame(frames.data() + IPC_HEADER_SIZE, frames.size() - IPC_HEADER_SIZE, header));
+				Assert::AreEqual((uint16_t)2, header.tag);
+			}
+
+			// A payload above the limit is rejected as soon as its size arrived
+			TEST_METHOD(TestMethodOversized) {
+				IPC_HEADER written;
+				written.size = IPC_MAX_PAYLOAD + 1;
+				char frame[IPC_HEADER_SIZE];
+				ipc::writeHeader(frame, written);
+				IPC_HEADER header;
+				Assert::AreEqual((int)IPC_FRAME_INCOMPLETE, (int)ipc::parseFrame(frame, 7, header));
+				Assert::AreEqual((int)IPC_FRAME_OVERSIZED, (int)ipc::parseFrame(frame, 8, header));
+				Assert::AreEqual((int)IPC_FRAME_OVERSIZED, (int)ipc::parseFrame(frame, IPC_HEADER_SIZE, header));
+			}
+
+			// A payload of exactly the limit is accepted
+			TEST_METHOD(TestMethodMaximumSize) {
+				IPC_HEADER written;
+				written.size = IPC_MAX_PAYLOAD;
+				char frame[IPC_HEADER_SIZE];
+				ipc::writeHeader(frame, written);
+				IPC_HEADER header;
+				Assert::AreEqual((int)IPC_FRAME_INCOMPLETE, (int)ipc::parseFrame(frame, IPC_HEADER_SIZE, header));
+				Assert::AreEqual((uint32_t)IPC_MAX_PAYLOAD, header.size);
+			}
+
+			// Bytes without the magic are rejected as soon as the magic would be complete
+			TEST_METHOD(TestMethodBadMagic) {
+				IPC_HEADER written;
+				char frame[IPC_HEADER_SIZE];
+				ipc::writeHeader(frame, written);
+				// a frame of the previous version started with the size
+				frame[0] = 0;
+				IPC_HEADER header;
+				Assert::AreEqual((int)IPC_FRAME_INCOMPLETE, (int)ipc::parseFrame(frame, 3, header));
+				Assert::AreEqual((int)IPC_FRAME_BAD_MAGIC, (int)ipc::parseFrame(frame, 4, header));
+				Assert::AreEqual((int)IPC_FRAME_BAD_MAGIC, (int)ipc::parseFrame(frame, IPC_HEADER_SIZE, header));
+			}
+	};
+}
\ No newline at end of file
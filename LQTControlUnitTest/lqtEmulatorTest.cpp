@@ -0,0 +1,103 @@
+#include "stdafx.h"
+#include "..\LQTEmulator\src\lqtEmulator.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FPIControlUnitTest {
+	TEST_CLASS(LqtEmulatorTest) {
+		public:
+			// The temperature is set, clamped to the maximum and formatted with three decimals
+			TEST_METHOD(TestMethodTemperature) {
+				LQTEmulator emulator{ EMULATOR_SETTINGS{} };
+				std::string reply;
+				Assert::IsTrue(emulator.handle("UTEMPOFFSET=1.25", reply));
+				Assert::AreEqual(std::string("1.250"), reply);
+				Assert::IsTrue(emulator.handle("utempoffset?", reply));
+				Assert::AreEqual(std::string("1.250"), reply);
+				Assert::IsTrue(emulator.handle("MAXUTEMPOFFSET=-2", reply));
+				Assert::AreEqual(std::string("2.000"), reply);
+				Assert::IsTrue(emulator.handle("UTEMPOFFSET=-3", reply));
+				Assert::AreEqual(std::string("-2.000"), reply);
+				Assert::AreEqual(-2.0, emulator.getState().temperature);
+			}
+
+			// The features are switched with on and off and report their state
+			TEST_METHOD(TestMethodFeatures) {
+				LQTEmulator emulator{ EMULATOR_SETTINGS{} };
+				std::string reply;
+				Assert::IsTrue(emulator.handle("MOD=OFF", reply));
+				Assert::AreEqual(std::string("Laser Modulation OFF"), reply);
+				Assert::IsTrue(emulator.handle("LE?", reply));
+				Assert::AreEqual(std::string("LOCK ENABLE=ON"), reply);
+				Assert::IsTrue(emulator.handle("lock=off", reply));
+				Assert::AreEqual(std::string("LOCK=OFF"), reply);
+				EMULATOR_STATE state = emulator.getState();
+				Assert::IsFalse(state.modEnabled);
+				Assert::IsTrue(state.lockEnabled);
+				Assert::IsFalse(state.lock);
+			}
+
+			// Unknown commands and invalid values are not answered and change nothing
+			TEST_METHOD(TestMethodInvalidCommands) {
+				LQTEmulator emulator{ EMULATOR_SETTINGS{} };
+				std::string reply;
+				Assert::IsFalse(emulator.handle("STATUS?", reply));
+				Assert::IsFalse(emulator.handle("UTEMPOFFSET", reply));
+				Assert::IsFalse(emulator.handle("UTEMPOFFSET=abc", reply));
+				Assert::IsFalse(emulator.handle("MOD=maybe", reply));
+				Assert::AreEqual(std::string(""), reply);
+				EMULATOR_STATE state = emulator.getState();
+				Assert::AreEqual(0.0, state.temperature);
+				Assert::IsTrue(state.modEnabled);
+			}
+
+			// With a drop rate of one no command is answered
+			TEST_METHOD(TestMethodDropRate) {
+				EMULATOR_SETTINGS settings;
+				settings.dropRate = 1;
+				LQTEmulator emulator{ settings };
+				std::string reply;
+				Assert::IsFalse(emulator.handle("UTEMPOFFSET=1", reply));
+				Assert::IsFalse(emulator.handle("UTEMPOFFSET?", reply));
+				Assert::AreEqual(0.0, emulator.getState().temperature);
+			}
+
+			// A new setpoint can be ignored on the first try but is accepted when repeated
+			TEST_METHOD(TestMethodIgnoreFirstSet) {
+				EMULATOR_SETTINGS settings;
+				settings.ignoreFirstSet = 1;
+				LQTEmulator emulator{ settings };
+				std::string reply;
+				Assert::IsTrue(emulator.handle("UTEMPOFFSET=1", reply));
+				Assert::AreEqual(std::string("0.000"), reply);
+				Assert::IsTrue(emulator.handle("UTEMPOFFSET=1", reply));
+				Assert::AreEqual(std::string("1.000"), reply);
+				Assert::IsTrue(emulator.handle("UTEMPOFFSET=1.5", reply));
+				Assert::AreEqual(std::string("1.000"), reply);
+			}
+
+			// The same seed gives the same sequence of dropped commands
+			TEST_METHOD(TestMethodSeed) {
+				EMULATOR_SETTINGS settings;
+				settings.dropRate = 0.5;
+				settings.seed = 42;
+				LQTEmulator first{ settings };
+				LQTEmulator second{ settings };
+				std::string reply;
+				for (int i{ 0 }; i < 100; i++) {
+					Assert::AreEqual(first.handle("UTEMPOFFSET?", reply), second.handle("UTEMPOFFSET?", reply));
+				}
+			}
+
+			// Every byte takes ten bits
+			TEST_METHOD(TestMethodTransmissionTime) {
+				EMULATOR_SETTINGS settings;
+				settings.baudRate = 10000;
+				LQTEmulator emulator{ settings };
+				Assert::AreEqual(10000LL, emulator.transmissionTime(10));
+				settings.baudRate = 0;
+				LQTEmulator unlimited{ settings };
+				Assert::AreEqual(0LL, unlimited.transmissionTime(10));
+			}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "stdafx.h"
+#include "..\LQTControl\src\Devices\lqtResponse.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FPIControlUnitTest {
+	TEST_CLASS(LqtResponseTest) {
+		public:
+			// The responses of a batch are extracted one by one in order
+			TEST_METHOD(TestMethodExtractBatch) {
+				std::string buffer{ "1.5\r\nLOCK=1\r\n2.5\r\n" };
+				std::string response;
+				Assert::IsTrue(lqtResponse::extract(buffer, response));
+				Assert::AreEqual(std::string("1.5"), response);
+				Assert::IsTrue(lqtResponse::extract(buffer, response));
+				Assert::AreEqual(std::string("LOCK=1"), response);
+				Assert::IsTrue(lqtResponse::extract(buffer, response));
+				Assert::AreEqual(std::string("2.5"), response);
+				Assert::IsFalse(lqtResponse::extract(buffer, response));
+				Assert::AreEqual((size_t)0, buffer.size());
+			}
+
+			// An incomplete line stays in the buffer until its terminator arrives
+			TEST_METHOD(TestMethodExtractPartial) {
+				std::string buffer{ "1." };
+				std::string response;
+				Assert::IsFalse(lqtResponse::extract(buffer, response));
+				Assert::AreEqual(std::string("1."), buffer);
+				buffer += "25\r";
+				Assert::IsTrue(lqtResponse::extract(buffer, response));
+				Assert::AreEqual(std::string("1.25"), response);
+			}
+
+			// Empty lines and any mix of CR and LF do not produce responses
+			TEST_METHOD(TestMethodExtractEmptyLines) {
+				std::string buffer{ "\r\n\n\r1\n\r\r2\r" };
+				std::string response;
+				Assert::IsTrue(lqtResponse::extract(buffer, response));
+				Assert::AreEqual(std::string("1"), response);
+				Assert::IsTrue(lqtResponse::extract(buffer, response));
+				Assert::AreEqual(std::string("2"), response);
+				Assert::IsFalse(lqtResponse::extract(buffer, response));
+			}
+
+			// Only a complete finite number is a temperature
+			TEST_METHOD(TestMethodParseTemperature) {
+				double temperature{ 7.0 };
+				Assert::IsTrue(lqtResponse::parseTemperature("-0.125", temperature));
+				Assert::AreEqual(-0.125, temperature);
+				Assert::IsTrue(lqtResponse::parseTemperature("1e-3", temperature));
+				Assert::AreEqual(1e-3, temperature);
+			}
+
+			// Malformed temperatures are rejected and leave the value untouched
+			TEST_METHOD(TestMethodParseMalformedTemperature) {
+				double temperature{ 7.0 };
+				Assert::IsFalse(lqtResponse::parseTemperature("", temperature));
+				Assert::IsFalse(lqtResponse::parseTemperature("abc", temperature));
+				Assert::IsFalse(lqtResponse::parseTemperature("1.2x", temperature));
+				Assert::IsFalse(lqtResponse::parseTemperature("inf", temperature));
+				Assert::IsFalse(lqtResponse::parseTemperature("nan", temperature));
+				Assert::IsFalse(lqtResponse::parseTemperature("LOCK=1", temperature));
+				Assert::AreEqual(7.0, temperature);
+			}
+
+			// A response answering another query is detected, so a batch cannot be shifted
+			TEST_METHOD(TestMethodIsValid) {
+				Assert::IsTrue(lqtResponse::isValid(LQT_COMMAND::GETTEMPERATURE, "0.5"));
+				Assert::IsFalse(lqtResponse::isValid(LQT_COMMAND::GETTEMPERATURE, "LOCK=1"));
+				Assert::IsTrue(lqtResponse::isValid(LQT_COMMAND::GETMAXTEMPERATURE, "2"));
+				Assert::IsFalse(lqtResponse::isValid(LQT_COMMAND::GETMAXTEMPERATURE, "abc"));
+				Assert::IsTrue(lqtResponse::isValid(LQT_COMMAND::GETLOCK, "LOCK=0"));
+				Assert::IsFalse(lqtResponse::isValid(LQT_COMMAND::GETLOCK, "LOCK ENABLE=1"));
+				Assert::IsTrue(lqtResponse::isValid(LQT_COMMAND::GETLE, "LOCK ENABLE=1"));
+				Assert::IsFalse(lqtResponse::isValid(LQT_COMMAND::GETLE, "0.5"));
+				Assert::IsTrue(lqtResponse::isValid(LQT_COMMAND::GETMOD, "Laser Modulation=1"));
+				Assert::IsFalse(lqtResponse::isValid(LQT_COMMAND::GETMOD, ""));
+			}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,120 @@
+#include "stdafx.h"
+#include "..\PicoEmulator\src\picoDevice.h"
+#include <thread>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FPIControlUnitTest {
+	TEST_CLASS(PicoDeviceTest) {
+		public:
+			PICO_EMULATOR_MODEL model{ "test", 2, 1000, 1, 10, 32767, true };
+
+			PICO_EMULATOR_SETTINGS settings() {
+				PICO_EMULATOR_SETTINGS settings;
+				settings.latencyScale = 0;
+				settings.seed = 1;
+				return settings;
+			}
+
+			void waitForBlock(PicoDevice &device) {
+				std::this_thread::sleep_until(device.getBlockReadyTime());
+			}
+
+			// The sample memory is shared by the enabled channels
+			TEST_METHOD(TestMethodMaxSamples) {
+				PicoDevice device{ model, settings() };
+				Assert::AreEqual((uint32_t)500, device.maxSamples());
+				Assert::IsTrue(device.setChannel(1, false, true, 8));
+				Assert::AreEqual((int16_t)1, device.enabledChannels());
+				Assert::AreEqual((uint32_t)1000, device.maxSamples());
+				Assert::IsFalse(device.setChannel(2, true, true, 8));
+				Assert::IsFalse(device.setChannel(0, true, true, 0));
+				Assert::IsFalse(device.setChannel(0, true, true, 11));
+			}
+
+			// A block can only be read once its capture time passed
+			TEST_METHOD(TestMethodBlockReady) {
+				PicoDevice device{ model, settings() };
+				std::vector<int16_t> a(100), b(100);
+				int16_t overflow{ 0 };
+				device.runBlock(100, 1e6);
+				Assert::IsFalse(device.isReady());
+				Assert::AreEqual((uint32_t)0, device.readBlock({ { a.data(), b.data(), nullptr, nullptr } }, 0, 100, overflow));
+				waitForBlock(device);
+				Assert::IsTrue(device.isReady());
+				Assert::AreEqual((uint32_t)100, device.readBlock({ { a.data(), b.data(), nullptr, nullptr } }, 0, 100, overflow));
+				Assert::AreEqual((uint32_t)40, device.readBlock({ { a.data(), b.data(), nullptr, nullptr } }, 60, 100, overflow));
+				Assert::AreEqual((uint32_t)0, device.readBlock({ { a.data(), b.data(), nullptr, nullptr } }, 100, 100, overflow));
+			}
+
+			// A finished block stays readable after stopping until the next capture
+			TEST_METHOD(TestMethodBlockAfterStop) {
+				PicoDevice device{ model, settings() };
+				std::vector<int16_t> a(10), b(10), c(10);
+				int16_t overflow{ 0 };
+				device.runBlock(10, 1e3);
+				waitForBlock(device);
+				Assert::AreEqual((uint32_t)10, device.readBlock({ { a.data(), nullptr, nullptr, nullptr } }, 0, 10, overflow));
+				device.stop();
+				Assert::AreEqual((uint32_t)10, device.readBlock({ { b.data(), nullptr, nullptr, nullptr } }, 0, 10, overflow));
+				Assert::IsTrue(a == b);
+				device.runBlock(10, 1e8);
+				Assert::AreEqual((uint32_t)0, device.readBlock({ { c.data(), nullptr, nullptr, nullptr } }, 0, 10, overflow));
+			}
+
+			// Stopping a block before it finished aborts it
+			TEST_METHOD(TestMethodBlockAborted) {
+				PicoDevice device{ model, settings() };
+				std::vector<int16_t> a(10);
+				int16_t overflow{ 0 };
+				device.runBlock(10, 1e6);
+				device.stop();
+				waitForBlock(device);
+				Assert::IsFalse(device.isReady());
+				Assert::AreEqual((uint32_t)0, device.readBlock({ { a.data(), nullptr, nullptr, nullptr } }, 0, 10, overflow));
+			}
+
+			// The samples only depend on the seed
+			TEST_METHOD(TestMethodSeed) {
+				PicoDevice first{ model, settings() };
+				PicoDevice second{ model, settings() };
+				std::vector<int16_t> a(50), b(50);
+				int16_t overflow{ 0 };
+				first.runBlock(50, 1e3);
+				second.runBlock(50, 1e3);
+				waitForBlock(first);
+				waitForBlock(second);
+				first.readBlock({ { a.data(), nullptr, nullptr, nullptr } }, 0, 50, overflow);
+				second.readBlock({ { b.data(), nullptr, nullptr, nullptr } }, 0, 50, overflow);
+				Assert::IsTrue(a == b);
+			}
+
+			// Signals beyond the input range are clipped and flagged per channel
+			TEST_METHOD(TestMethodOverflow) {
+				PicoDevice device{ model, settings() };
+				Assert::IsTrue(device.setChannel(1, true, true, 1));
+				std::vector<int16_t> a(10), b(10);
+				int16_t overflow{ 0 };
+				device.runBlock(10, 1e3);
+				waitForBlock(device);
+				device.readBlock({ { a.data(), b.data(), nullptr, nullptr } }, 0, 10, overflow);
+				Assert::AreEqual((int16_t)2, overflow);
+				Assert::AreEqual((int16_t)32767, b[0]);
+			}
+
+			// The driver only keeps the latest samples while streaming
+			TEST_METHOD(TestMethodStreamingBuffer) {
+				PicoDevice device{ model, settings() };
+				std::vector<int16_t> a(100);
+				int16_t overflow{ 0 };
+				device.runStreaming(1e3, 20);
+				Assert::IsTrue(device.isStreaming());
+				std::this_thread::sleep_for(std::chrono::milliseconds(2));
+				Assert::AreEqual((uint32_t)20, device.readStreaming({ { a.data(), nullptr, nullptr, nullptr } }, 100, overflow));
+				Assert::IsTrue(device.readStreaming({ { a.data(), nullptr, nullptr, nullptr } }, 5, overflow) <= 5);
+				device.stop();
+				Assert::IsFalse(device.isStreaming());
+				Assert::AreEqual((uint32_t)0, device.readStreaming({ { a.data(), nullptr, nullptr, nullptr } }, 100, overflow));
+			}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include "stdafx.h"
+#include "..\LQTControl\src\Devices\requestQueue.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FPIControlUnitTest {
+	TEST_CLASS(RequestQueueTest) {
+		public:
+			// Requests of the same command are coalesced into one taking the newest value
+			TEST_METHOD(TestMethodCoalesceValue) {
+				RequestQueue queue;
+				queue.enqueue(LQT_COMMAND::SETTEMPERATURE, 1.0, LQT_PRIORITY::CONTROL, nullptr, nullptr);
+				queue.enqueue(LQT_COMMAND::SETTEMPERATURE, 2.0, LQT_PRIORITY::CONTROL, nullptr, nullptr);
+				Assert::AreEqual((size_t)1, queue.size());
+				LQT_REQUEST request;
+				Assert::IsTrue(queue.take(request));
+				Assert::AreEqual(2.0, request.value);
+				Assert::AreEqual((size_t)0, queue.size());
+				Assert::IsFalse(queue.take(request));
+			}
+
+			// A less important request must not lower the priority of a pending request
+			TEST_METHOD(TestMethodCoalesceKeepsHigherPriority) {
+				RequestQueue queue;
+				queue.enqueue(LQT_COMMAND::SETTEMPERATURE, 1.0, LQT_PRIORITY::CONTROL, nullptr, nullptr);
+				queue.enqueue(LQT_COMMAND::SETTEMPERATURE, 2.0, LQT_PRIORITY::STATUS, nullptr, nullptr);
+				LQT_REQUEST request;
+				Assert::IsTrue(queue.take(request));
+				Assert::IsTrue(request.priority == LQT_PRIORITY::CONTROL);
+				Assert::AreEqual(2.0, request.value);
+			}
+
+			// A more important request raises the priority of a pending request
+			TEST_METHOD(TestMethodCoalesceRaisesPriority) {
+				RequestQueue queue;
+				queue.enqueue(LQT_COMMAND::GETTEMPERATURE, 0, LQT_PRIORITY::STATUS, nullptr, nullptr);
+				queue.enqueue(LQT_COMMAND::READSETTINGS, 0, LQT_PRIORITY::USER, nullptr, nullptr);
+				queue.enqueue(LQT_COMMAND::GETTEMPERATURE, 0, LQT_PRIORITY::SCAN, nullptr, nullptr);
+				LQT_REQUEST request;
+				Assert::IsTrue(queue.take(request));
+				Assert::IsTrue(request.command == LQT_COMMAND::GETTEMPERATURE);
+				Assert::IsTrue(request.priority == LQT_PRIORITY::SCAN);
+			}
+
+			// The coalesced request keeps the time it was queued first
+			TEST_METHOD(TestMethodCoalesceKeepsQueueTime) {
+				RequestQueue queue;
+				queue.enqueue(LQT_COMMAND::SETTEMPERATURE, 1.0, LQT_PRIORITY::USER, nullptr, nullptr);
+				LQT_REQUEST first;
+				Assert::IsTrue(queue.take(first));
+				queue.enqueue(LQT_COMMAND::SETTEMPERATURE, 1.0, LQT_PRIORITY::USER, nullptr, nullptr);
+				auto queued = std::chrono::steady_clock::now();
+				queue.enqueue(LQT_COMMAND::SETTEMPERATURE, 2.0, LQT_PRIORITY::CONTROL, nullptr, nullptr);
+				LQT_REQUEST request;
+				Assert::IsTrue(queue.take(request));
+				Assert::IsTrue(request.queued <= queued);
+			}
+
+			// Higher classes go first, requests of the same class in the order they were queued
+			TEST_METHOD(TestMethodTakeByPriority) {
+				RequestQueue queue;
+				queue.enqueue(LQT_COMMAND::READSETTINGS, 0, LQT_PRIORITY::STATUS, nullptr, nullptr);
+				queue.enqueue(LQT_COMMAND::GETTEMPERATURE, 0, LQT_PRIORITY::USER, nullptr, nullptr);
+				queue.enqueue(LQT_COMMAND::TEMPERATURECONTROL, 1, LQT_PRIORITY::USER, nullptr, nullptr);
+				queue.enqueue(LQT_COMMAND::SETTEMPERATURE, 1.0, LQT_PRIORITY::CONTROL, nullptr, nullptr);
+				std::vector<LQT_COMMAND> expected = {
+					LQT_COMMAND::SETTEMPERATURE,
+					LQT_COMMAND::GETTEMPERATURE,
+					LQT_COMMAND::TEMPERATURECONTROL,
+					LQT_COMMAND::READSETTINGS
+				};
+				for (auto command : expected) {
+					LQT_REQUEST request;
+					Assert::IsTrue(queue.take(request));
+					Assert::IsTrue(request.command == command);
+				}
+			}
+
+			// Preemption only takes requests of a higher class than the running one
+			TEST_METHOD(TestMethodTakeAbove) {
+				RequestQueue queue;
+				queue.enqueue(LQT_COMMAND::GETTEMPERATURE, 0, LQT_PRIORITY::USER, nullptr, nullptr);
+				Assert::IsTrue(queue.hasPending(LQT_PRIORITY::STATUS));
+				Assert::IsFalse(queue.hasPending(LQT_PRIORITY::USER));
+				LQT_REQUEST request;
+				Assert::IsFalse(queue.take(request, (int)LQT_PRIORITY::USER));
+				Assert::IsTrue(queue.take(request, (int)LQT_PRIORITY::STATUS));
+				Assert::IsFalse(queue.hasPending(LQT_COMMAND::GETTEMPERATURE));
+			}
+
+			// Every caller of a coalesced request gets its result
+			TEST_METHOD(TestMethodCoalesceFuturesAndCallbacks) {
+				RequestQueue queue;
+				std::shared_future<double> first;
+				std::shared_future<double> second;
+				int called{ 0 };
+				queue.enqueue(LQT_COMMAND::SETTEMPERATURE, 1.0, LQT_PRIORITY::USER, [&called](double) { called++; }, &first);
+				queue.enqueue(LQT_COMMAND::SETTEMPERATURE, 2.0, LQT_PRIORITY::SCAN, [&called](double) { called++; }, &second);
+				queue.enqueue(LQT_COMMAND::SETTEMPERATURE, 3.0, LQT_PRIORITY::CONTROL, nullptr, nullptr);
+				Assert::AreEqual((size_t)2, queue.pendingCallbacks());
+				LQT_REQUEST request;
+				Assert::IsTrue(queue.take(request));
+				Assert::IsTrue((bool)request.promise);
+				request.promise->set_value(request.value);
+				for (auto &callback : request.callbacks) {
+					callback(request.value);
+				}
+				Assert::AreEqual(3.0, first.get());
+				Assert::AreEqual(3.0, second.get());
+				Assert::AreEqual(2, called);
+			}
+
+			// Posting without a future creates no promise
+			TEST_METHOD(TestMethodPostWithoutPromise) {
+				RequestQueue queue;
+				queue.enqueue(LQT_COMMAND::SETTEMPERATURE, 1.0, LQT_PRIORITY::CONTROL, nullptr, nullptr);
+				LQT_REQUEST request;
+				Assert::IsTrue(queue.take(request));
+				Assert::IsFalse((bool)request.promise);
+				Assert::AreEqual((size_t)0, request.callbacks.size());
+			}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,155 @@
+#include "stdafx.h"
+#include "..\LQTControl\src\sharedRingWriter.h"
+#include "..\LQTSharedRing\src\sharedRingReader.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FPIControlUnitTest {
+	TEST_CLASS(SharedRingTest) {
+		public:
+			// A slot holds its header and the record, rounded up to the alignment
+			TEST_METHOD(TestMethodSlotSize) {
+				Assert::AreEqual((uint64_t)64, sharedRing::slotSize(1));
+				Assert::AreEqual((uint64_t)64, sharedRing::slotSize(48));
+				Assert::AreEqual((uint64_t)128, sharedRing::slotSize(49));
+				Assert::AreEqual((uint64_t)0, sharedRing::slotSize(sizeof(SHARED_LOCK_RECORD)) % SHARED_RING_ALIGNMENT);
+			}
+
+			// A ring which was not created cannot be opened
+			TEST_METHOD(TestMethodMissing) {
+				SharedRingReader reader;
+				Assert::IsFalse(reader.open("lqtcontrol-unittest-missing"));
+				Assert::IsFalse(reader.isOpen());
+				Assert::IsFalse(reader.errorString().empty());
+				Assert::IsNull(reader.getLockRecord(0));
+			}
+
+			// A published lock record is read back in place
+			TEST_METHOD(TestMethodLockRecord) {
+				SharedRingWriter writer;
+				Assert::IsTrue(writer.openLock("lqtcontrol-unittest-lock", 4));
+				SharedRingReader reader;
+				Assert::IsTrue(reader.open("lqtcontrol-unittest-lock"));
+				Assert::AreEqual((uint32_t)SHARED_RING_LOCK, reader.getHeader()->kind);
+				Assert::AreEqual((uint64_t)0, reader.getPublished());
+				Assert::IsNull(reader.getLockRecord(0));
+
+				auto written = static_cast<SHARED_LOCK_RECORD *>(writer.beginWrite());
+				written->error = 0.5;
+				written->state = 1;
+				writer.endWrite();
+
+				Assert::AreEqual((uint64_t)1, reader.getPublished());
+				auto record = reader.getLockRecord(0);
+				Assert::IsNotNull(record);
+				Assert::AreEqual(0.5, record->error);
+				Assert::AreEqual((uint32_t)1, record->state);
+				Assert::IsTrue(reader.isValid(0));
+				// a lock ring holds no live records
+				Assert::IsNull(reader.getLiveRecord(0));
+			}
+
+			// A record being written is neither published nor readable
+			TEST_METHOD(TestMethodWriteInProgress) {
+				SharedRingWriter writer;
+				Assert::IsTrue(writer.openLock("lqtcontrol-unittest-progress", 4));
+				SharedRingReader reader;
+				Assert::IsTrue(reader.open("lqtcontrol-unittest-progress"));
+				writer.beginWrite();
+				Assert::AreEqual((uint64_t)0, reader.getPublished());
+				Assert::IsNull(reader.getLockRecord(0));
+				Assert::IsFalse(reader.isValid(0));
+				writer.endWrite();
+				Assert::IsNotNull(reader.getLockRecord(0));
+			}
+
+			// Once the writer wrapped around, the oldest records are gone
+			TEST_METHOD(TestMethodWrapAround) {
+				SharedRingWriter writer;
+				Assert::IsTrue(writer.openLock("lqtcontrol-unittest-wrap", 4));
+				SharedRingReader reader;
+				Assert::IsTrue(reader.open("lqtcontrol-unittest-wrap"));
+				for (int n{ 0 }; n < 6; n++) {
+					static_cast<SHARED_LOCK_RECORD *>(writer.beginWrite())->tempOffset = n;
+					writer.endWrite();
+				}
+				Assert::AreEqual((uint64_t)6, reader.getPublished());
+				Assert::AreEqual((uint64_t)2, reader.getOldest());
+				Assert::IsNull(reader.getLockRecord(0));
+				Assert::IsNull(reader.getLockRecord(1));
+				for (uint64_t n{ 2 }; n < 6; n++) {
+					auto record = reader.getLockRecord(n);
+					Assert::IsNotNull(record);
+					Assert::AreEqual((double)n, record->tempOffset);
+					Assert::IsTrue(reader.isValid(n));
+				}
+			}
+
+			// A record overwritten while it was read is not valid anymore
+			TEST_METHOD(TestMethodOverwrittenWhileRead) {
+				SharedRingWriter writer;
+				Assert::IsTrue(writer.openLock("lqtcontrol-unittest-overwritten", 2));
+				SharedRingReader reader;
+				Assert::IsTrue(reader.open("lqtcontrol-unittest-overwritten"));
+				writer.beginWrite();
+				writer.endWrite();
+				auto record = reader.getLockRecord(0);
+				Assert::IsNotNull(record);
+				// record 2 takes the slot of record 0, record 0 is invalid while and after it is written
+				writer.beginWrite();
+				writer.endWrite();
+				writer.beginWrite();
+				Assert::IsFalse(reader.isValid(0));
+				writer.endWrite();
+				Assert::IsFalse(reader.isValid(0));
+				Assert::IsNull(reader.getLockRecord(0));
+			}
+
+			// The values of a live record are stored channel by channel
+			TEST_METHOD(TestMethodLiveRecord) {
+				SharedRingWriter writer;
+				Assert::IsTrue(writer.openLive("lqtcontrol-unittest-live", 2, 2, 8));
+				Assert::AreEqual((uint32_t)2, writer.getChannels());
+				Assert::AreEqual((uint32_t)8, writer.getMaxSamples());
+				SharedRingReader reader;
+				Assert::IsTrue(reader.open("lqtcontrol-unittest-live"));
+
+				auto written = static_cast<SHARED_LIVE_RECORD *>(writer.beginWrite());
+				written->channels = 2;
+				written->samples = 8;
+				written->enabled = 0x3;
+				for (uint32_t channel{ 0 }; channel < 2; channel++) {
+					int32_t *values = sharedRing::liveValues(written, 8, channel);
+					for (int32_t i{ 0 }; i < 8; i++) {
+						values[i] = 100 * (int32_t)channel + i;
+					}
+				}
+				writer.endWrite();
+
+				auto record = reader.getLiveRecord(0);
+				Assert::IsNotNull(record);
+				Assert::AreEqual((uint32_t)8, record->samples);
+				Assert::AreEqual(7, reader.getLiveValues(record, 0)[7]);
+				Assert::AreEqual(100, reader.getLiveValues(record, 1)[0]);
+				Assert::AreEqual(107, reader.getLiveValues(record, 1)[7]);
+				Assert::IsTrue(reader.isValid(0));
+				Assert::IsNull(reader.getLockRecord(0));
+			}
+
+			// A reader keeps its mapping when the writer is closed
+			TEST_METHOD(TestMethodWriterClosed) {
+				SharedRingReader reader;
+				{
+					SharedRingWriter writer;
+					Assert::IsTrue(writer.openLock("lqtcontrol-unittest-closed", 4));
+					Assert::IsTrue(reader.open("lqtcontrol-unittest-closed"));
+					static_cast<SHARED_LOCK_RECORD *>(writer.beginWrite())->error = 0.25;
+					writer.endWrite();
+				}
+				auto record = reader.getLockRecord(0);
+				Assert::IsNotNull(record);
+				Assert::AreEqual(0.25, record->error);
+				Assert::IsTrue(reader.isValid(0));
+			}
+	};
+}
\ No newline at end of file
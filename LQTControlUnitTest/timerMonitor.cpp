@@ -0,0 +1,104 @@
+#include "stdafx.h"
+#include "..\LQTControl\src\timerMonitor.h"
+#include <thread>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FPIControlUnitTest {
+	TEST_CLASS(TimerMonitorTest) {
+		public:
+			// Ticks which return in time are neither late nor overrun
+			TEST_METHOD(TestMethodTicksInTime) {
+				TimerMonitor monitor(TIMERS::LOCKINGTIMER, 40, 10);
+				for (int i{ 0 }; i < 3; i++) {
+					monitor.tickStarted();
+					monitor.tickFinished();
+				}
+				auto statistics = monitor.getStatistics();
+				Assert::AreEqual((uint64_t)3, statistics.ticks);
+				Assert::AreEqual((uint64_t)0, statistics.overruns);
+				Assert::AreEqual((uint64_t)0, statistics.missedDeadlines);
+				Assert::AreEqual(0.0, statistics.lateRatio);
+				Assert::IsTrue(statistics.rateKept);
+			}
+
+			// An overrun of the very first tick is attributed to the interval this tick started
+			TEST_METHOD(TestMethodOverrunFirstTick) {
+				TimerMonitor monitor(TIMERS::LOCKINGTIMER, 40, 10);
+				monitor.tickStarted();
+				std::this_thread::sleep_for(std::chrono::milliseconds(50));
+				monitor.tickFinished();
+				monitor.tickStarted();
+				monitor.tickFinished();
+				monitor.tickStarted();
+				monitor.tickFinished();
+				auto statistics = monitor.getStatistics();
+				Assert::AreEqual((uint64_t)1, statistics.overruns);
+				Assert::AreEqual((uint64_t)0, statistics.missedDeadlines);
+				Assert::AreEqual(0.5, statistics.lateRatio);
+				Assert::IsFalse(statistics.rateKept);
+			}
+
+			// The overrun of a later tick must not mark the interval before it as late
+			TEST_METHOD(TestMethodOverrunAttribution) {
+				TimerMonitor monitor(TIMERS::LOCKINGTIMER, 40, 10);
+				monitor.tickStarted();
+				monitor.tickFinished();
+				monitor.tickStarted();
+				std::this_thread::sleep_for(std::chrono::milliseconds(50));
+				monitor.tickFinished();
+				auto statistics = monitor.getStatistics();
+				Assert::AreEqual((uint64_t)1, statistics.overruns);
+				Assert::AreEqual(0.0, statistics.lateRatio);
+				monitor.tickStarted();
+				monitor.tickFinished();
+				statistics = monitor.getStatistics();
+				Assert::AreEqual(0.5, statistics.lateRatio);
+			}
+
+			TEST_METHOD(TestMethodMissedDeadline) {
+				TimerMonitor monitor(TIMERS::ACQUISITIONTIMER, 20, 10);
+				monitor.tickStarted();
+				monitor.tickFinished();
+				std::this_thread::sleep_for(std::chrono::milliseconds(50));
+				monitor.tickStarted();
+				monitor.tickFinished();
+				auto statistics = monitor.getStatistics();
+				Assert::AreEqual((uint64_t)0, statistics.overruns);
+				Assert::AreEqual((uint64_t)1, statistics.missedDeadlines);
+				Assert::AreEqual(1.0, statistics.lateRatio);
+			}
+
+			TEST_METHOD(TestMethodReset) {
+				TimerMonitor monitor(TIMERS::SCANTIMER, 40, 10);
+				monitor.tickStarted();
+				std::this_thread::sleep_for(std::chrono::milliseconds(50));
+				monitor.tickFinished();
+				monitor.reset();
+				monitor.tickStarted();
+				monitor.tickFinished();
+				monitor.tickStarted();
+				monitor.tickFinished();
+				auto statistics = monitor.getStatistics();
+				Assert::AreEqual((uint64_t)2, statistics.ticks);
+				Assert::AreEqual((uint64_t)0, statistics.overruns);
+				Assert::AreEqual(0.0, statistics.lateRatio);
+				Assert::AreEqual(40, statistics.period);
+			}
+
+			// The rolling window only keeps the last windowSize intervals
+			TEST_METHOD(TestMethodWindowWraps) {
+				TimerMonitor monitor(TIMERS::LOCKINGTIMER, 40, 2);
+				monitor.tickStarted();
+				std::this_thread::sleep_for(std::chrono::milliseconds(50));
+				monitor.tickFinished();
+				for (int i{ 0 }; i < 3; i++) {
+					monitor.tickStarted();
+					monitor.tickFinished();
+				}
+				auto statistics = monitor.getStatistics();
+				Assert::AreEqual((uint64_t)1, statistics.overruns);
+				Assert::AreEqual(0.0, statistics.lateRatio);
+			}
+	};
+}
\ No newline at end of file
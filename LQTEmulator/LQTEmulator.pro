@@ -0,0 +1,12 @@
+# ----------------------------------------------------
+# Emulator of the laserquantum torus serial protocol.
+# Plain POSIX, runs on Linux only.
+# ----------------------------------------------------
+
+TEMPLATE = app
+TARGET = LQTEmulator
+CONFIG += console c++14
+CONFIG -= qt app_bundle
+HEADERS += ./src/lqtEmulator.h
+SOURCES += ./src/main.cpp \
+    ./src/lqtEmulator.cpp
\ No newline at end of file
@@ -0,0 +1,116 @@
+#include "lqtEmulator.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+LQTEmulator::LQTEmulator(EMULATOR_SETTINGS settings) noexcept : m_settings(settings), m_generator(settings.seed) {}
+
+bool LQTEmulator::handle(std::string command, std::string &reply) {
+	reply = "";
+	if (m_distribution(m_generator) < m_settings.dropRate) {
+		return false;
+	}
+
+	// the laser does not care about the case of the commands
+	std::transform(command.begin(), command.end(), command.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+
+	auto separator = command.find_first_of("=?");
+	if (separator == std::string::npos) {
+		return false;
+	}
+	std::string name = command.substr(0, separator);
+	bool query = (command[separator] == '?');
+	std::string value = command.substr(separator + 1);
+
+	if (name == "utempoffset") {
+		if (!query) {
+			char *end{ nullptr };
+			double temperature = strtod(value.c_str(), &end);
+			if (end == value.c_str()) {
+				return false;
+			}
+			setTemperature(temperature);
+		}
+		reply = formatTemperature(m_state.temperature);
+		return true;
+	}
+	if (name == "maxutempoffset") {
+		if (!query) {
+			char *end{ nullptr };
+			double temperature = strtod(value.c_str(), &end);
+			if (end == value.c_str()) {
+				return false;
+			}
+			m_state.maxTemperature = fabs(temperature);
+		}
+		reply = formatTemperature(m_state.maxTemperature);
+		return true;
+	}
+
+	// the features are switched with "=on" and "=off"
+	bool *feature{ nullptr };
+	if (name == "mod") {
+		feature = &m_state.modEnabled;
+	} else if (name == "lock") {
+		feature = &m_state.lock;
+	} else if (name == "le") {
+		feature = &m_state.lockEnabled;
+	} else {
+		return false;
+	}
+	if (!query) {
+		if (value == "on") {
+			*feature = true;
+		} else if (value == "off") {
+			*feature = false;
+		} else {
+			return false;
+		}
+	}
+	std::string state = *feature ? "ON" : "OFF";
+	if (name == "mod") {
+		reply = "Laser Modulation " + state;
+	} else if (name == "lock") {
+		reply = "LOCK=" + state;
+	} else {
+		reply = "LOCK ENABLE=" + state;
+	}
+	return true;
+}
+
+// A new setpoint is sometimes ignored on the first try, the real laser behaves the same.
+double LQTEmulator::setTemperature(double temperature) {
+	bool repeated = (fabs(temperature - m_lastSetpoint) < 1e-6);
+	m_lastSetpoint = temperature;
+	if (!repeated && m_distribution(m_generator) < m_settings.ignoreFirstSet) {
+		return m_state.temperature;
+	}
+	m_state.temperature = (temperature > m_state.maxTemperature) ? m_state.maxTemperature
+		: (temperature < -m_state.maxTemperature) ? -m_state.maxTemperature : temperature;
+	return m_state.temperature;
+}
+
+std::string LQTEmulator::formatTemperature(double temperature) {
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), "%.3f", temperature);
+	return std::string(buffer);
+}
+
+// Every byte takes a start bit, eight data bits and a stop bit.
+long long LQTEmulator::transmissionTime(size_t bytes) {
+	if (m_settings.baudRate <= 0) {
+		return 0;
+	}
+	return (long long)(bytes * 10 * 1000000LL / m_settings.baudRate);
+}
+
+EMULATOR_SETTINGS LQTEmulator::getSettings() {
+	return m_settings;
+}
+
+EMULATOR_STATE LQTEmulator::getState() {
+	return m_state;
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#ifndef LQTEMULATOR_H
+#define LQTEMULATOR_H
+
+#include <string>
+#include <random>
+#include <cmath>
+
+typedef struct EMULATOR_SETTINGS {
+	int baudRate{ 19200 };			// [Bd]	baud rate used to time the transmission of the replies
+	int replyDelay{ 5 };			// [ms]	processing time of the laser before it replies
+	double dropRate{ 0 };			// [1]	probability that a received command is dropped without reply
+	double ignoreFirstSet{ 0 };		// [1]	probability that a new temperature setpoint is ignored on the first try
+	unsigned int seed{ 0 };			//		seed of the random number generator
+} EMULATOR_SETTINGS;
+
+typedef struct EMULATOR_STATE {
+	double temperature{ 0 };		// [K]	temperature offset
+	double maxTemperature{ 5 };		// [K]	maximum absolute temperature offset
+	bool modEnabled{ true };
+	bool lockEnabled{ true };
+	bool lock{ true };
+} EMULATOR_STATE;
+
+/*
+ * Implements the serial protocol of the laserquantum torus.
+ * The transport and the timing of the replies is up to the caller.
+ */
+class LQTEmulator {
+
+public:
+	explicit LQTEmulator(EMULATOR_SETTINGS settings) noexcept;
+
+	// Returns false if the command is dropped or unknown, the laser does not reply then.
+	bool handle(std::string command, std::string &reply);
+
+	// [us] time the transmission of the given number of bytes takes
+	long long transmissionTime(size_t bytes);
+
+	EMULATOR_SETTINGS getSettings();
+	EMULATOR_STATE getState();
+
+private:
+	EMULATOR_SETTINGS m_settings;
+	EMULATOR_STATE m_state;
+	std::mt19937 m_generator;
+	std::uniform_real_distribution<double> m_distribution{ 0.0, 1.0 };
+	double m_lastSetpoint{ NAN };	// [K]	last requested temperature setpoint
+
+	double setTemperature(double temperature);
+	std::string formatTemperature(double temperature);
+};
+
+#endif // LQTEMULATOR_H
\ No newline at end of file
@@ -0,0 +1,174 @@
+/*
+ * Emulates a laserquantum torus on a pseudo-terminal, so the serial
+ * communication of LQTControl can be tested without a laser:
+ *
+ *   LQTEmulator --link /tmp/lqt --baud 19200 --delay 5 --drop-rate 0.01 --ignore-first-set 0.5
+ *
+ * LQTControl connects to it with LQTCONTROL_LASER_PORT=/tmp/lqt.
+ */
+#include "lqtEmulator.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <getopt.h>
+#include <termios.h>
+#include <unistd.h>
+
+static volatile sig_atomic_t running{ 1 };
+
+static void stop(int) {
+	running = 0;
+}
+
+static void usage(const char *name) {
+	fprintf(stderr,
+		"Usage: %s [options]\n"
+		"  --baud N              baud rate used to time the replies (default 19200, 0 for no timing)\n"
+		"  --delay MS            reply delay in milliseconds (default 5)\n"
+		"  --drop-rate P         probability that a command is dropped (default 0)\n"
+		"  --ignore-first-set P  probability that a new setpoint is ignored on the first try (default 0)\n"
+		"  --seed N              seed of the random number generator (default 0)\n"
+		"  --link PATH           create a symbolic link to the pseudo-terminal\n",
+		name);
+}
+
+// Writes the reply byte by byte, taking as long as the serial line would.
+static bool writeReply(int fd, LQTEmulator &emulator, const std::string &reply) {
+	long long byteTime = emulator.transmissionTime(1);
+	for (char c : reply) {
+		if (byteTime > 0) {
+			usleep((useconds_t)byteTime);
+		}
+		if (write(fd, &c, 1) != 1) {
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char *argv[]) {
+	EMULATOR_SETTINGS settings;
+	std::string link{ "" };
+
+	static struct option options[] = {
+		{ "baud", required_argument, nullptr, 'b' },
+		{ "delay", required_argument, nullptr, 'd' },
+		{ "drop-rate", required_argument, nullptr, 'r' },
+		{ "ignore-first-set", required_argument, nullptr, 'i' },
+		{ "seed", required_argument, nullptr, 's' },
+		{ "link", required_argument, nullptr, 'l' },
+		{ "help", no_argument, nullptr, 'h' },
+		{ nullptr, 0, nullptr, 0 }
+	};
+	int option;
+	while ((option = getopt_long(argc, argv, "b:d:r:i:s:l:h", options, nullptr)) != -1) {
+		switch (option) {
+			case 'b':
+				settings.baudRate = atoi(optarg);
+				break;
+			case 'd':
+				settings.replyDelay = atoi(optarg);
+				break;
+			case 'r':
+				settings.dropRate = atof(optarg);
+				break;
+			case 'i':
+				settings.ignoreFirstSet = atof(optarg);
+				break;
+			case 's':
+				settings.seed = (unsigned int)strtoul(optarg, nullptr, 10);
+				break;
+			case 'l':
+				link = optarg;
+				break;
+			default:
+				usage(argv[0]);
+				return (option == 'h') ? 0 : 1;
+		}
+	}
+
+	int master = posix_openpt(O_RDWR | O_NOCTTY);
+	if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+		fprintf(stderr, "Could not create the pseudo-terminal: %s\n", strerror(errno));
+		return 1;
+	}
+	const char *slaveName = ptsname(master);
+
+	// Keep the slave side open, so the emulator survives clients closing the port,
+	// and make it raw, so the line discipline neither echoes nor translates anything.
+	int slave = open(slaveName, O_RDWR | O_NOCTTY);
+	if (slave < 0) {
+		fprintf(stderr, "Could not open %s: %s\n", slaveName, strerror(errno));
+		return 1;
+	}
+	struct termios attributes;
+	tcgetattr(slave, &attributes);
+	cfmakeraw(&attributes);
+	tcsetattr(slave, TCSANOW, &attributes);
+
+	if (link.size() > 0) {
+		unlink(link.c_str());
+		if (symlink(slaveName, link.c_str()) != 0) {
+			fprintf(stderr, "Could not create the link %s: %s\n", link.c_str(), strerror(errno));
+			return 1;
+		}
+	}
+	printf("%s\n", slaveName);
+	fflush(stdout);
+
+	// without SA_RESTART, which signal() sets, so the blocking read() returns EINTR and the loop ends
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = stop;
+	sigemptyset(&action.sa_mask);
+	action.sa_flags = 0;
+	sigaction(SIGINT, &action, nullptr);
+	sigaction(SIGTERM, &action, nullptr);
+
+	LQTEmulator emulator(settings);
+	std::string buffer{ "" };
+	char data[256];
+	while (running) {
+		ssize_t count = read(master, data, sizeof(data));
+		if (count < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			break;
+		}
+		buffer.append(data, (size_t)count);
+
+		// every command is terminated by \r, a \n is tolerated as well
+		size_t end;
+		while ((end = buffer.find_first_of("\r\n")) != std::string::npos) {
+			std::string command = buffer.substr(0, end);
+			buffer.erase(0, end + 1);
+			if (command.size() == 0) {
+				continue;
+			}
+			std::string reply;
+			if (!emulator.handle(command, reply)) {
+				continue;
+			}
+			if (settings.replyDelay > 0) {
+				usleep((useconds_t)settings.replyDelay * 1000);
+			}
+			if (!writeReply(master, emulator, reply + "\r\n")) {
+				running = 0;
+				break;
+			}
+		}
+	}
+
+	if (link.size() > 0) {
+		unlink(link.c_str());
+	}
+	close(slave);
+	close(master);
+	return 0;
+}
\ No newline at end of file
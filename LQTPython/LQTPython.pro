@@ -0,0 +1,37 @@
+# ----------------------------------------------------
+# Python module lqtcontrol: the acquisition, the lock
+# and the simulation against the digital twin of the
+# laser with NumPy views of the lock and scan data.
+# Needs pybind11 and NumPy for the given Python, e.g.
+# qmake PYTHON=/usr/bin/python3
+# ----------------------------------------------------
+
+TEMPLATE = lib
+TARGET = lqtcontrol
+CONFIG += plugin no_plugin_name_prefix c++14
+CONFIG -= app_bundle
+include(../LQTControlCore/LQTControlCore.pri)
+
+isEmpty(PYTHON): PYTHON = python3
+QMAKE_CXXFLAGS += $$system($$PYTHON -m pybind11 --includes)
+# the module is loaded by the interpreter, which provides the symbols of Python
+win32 {
+    QMAKE_EXTENSION_SHLIB = pyd
+    LIBS += -L$$system($$PYTHON -c \"import sys, os; print(os.path.join(sys.base_prefix, 'libs'))\")
+} else {
+    QMAKE_EXTENSION_SHLIB = $$system($$PYTHON -c \"import sysconfig; print(sysconfig.get_config_var('EXT_SUFFIX')[1:])\")
+    macx: QMAKE_LFLAGS_PLUGIN += -undefined dynamic_lookup
+}
+
+INCLUDEPATH += ./src \
+    ../LQTSimulation/src \
+    ../LQTEmulator/src
+HEADERS += ./src/simulation.h \
+    ../LQTSimulation/src/laserTwin.h \
+    ../LQTSimulation/src/twinTransport.h \
+    ../LQTEmulator/src/lqtEmulator.h
+SOURCES += ./src/bindings.cpp \
+    ./src/simulation.cpp \
+    ../LQTSimulation/src/laserTwin.cpp \
+    ../LQTSimulation/src/twinTransport.cpp \
+    ../LQTEmulator/src/lqtEmulator.cpp
\ No newline at end of file
@@ -0,0 +1,267 @@
+/*
+ * Python module lqtcontrol: the acquisition, the lock and the simulation against the digital twin
+ * of the laser. The lock history and the scan are NumPy arrays viewing the vectors of LOCK_DATA
+ * and SCAN_DATA, so reading them copies nothing:
+ *
+ *   import lqtcontrol
+ *   simulation = lqtcontrol.Simulation()
+ *   locking = simulation.locking
+ *   simulation.run_scan()
+ *   locking.start_stop_acquire_locking()
+ *   locking.start_stop_locking()
+ *   simulation.run(3600)
+ *   error = locking.lock_data.error
+ *
+ * The views are read-only and keep the simulation alive. The lock reserves the storage for its
+ * maximum size and fills it in place, so a view never outlives its buffer, but it keeps the length
+ * the data had when it was taken. Get it from the data again once the acquisition for the lock or
+ * a scan was started again.
+ */
+// before Qt, which defines slots as a macro, a name the headers of Python use
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+
+#include <QCoreApplication>
+
+#include "locking.h"
+#include "simulation.h"
+#include "Devices/daq.h"
+#include "Devices/DAQ_Synthetic.h"
+
+namespace py = pybind11;
+
+namespace {
+	// A read-only array viewing the values, which keeps their owner alive.
+	template <typename T>
+	py::array_t<T> view(const T *values, size_t size, py::handle owner) {
+		py::array_t<T> array({ (py::ssize_t)size }, { (py::ssize_t)sizeof(T) }, values, owner);
+		array.attr("flags").attr("writeable") = false;
+		return array;
+	}
+
+	template <typename T>
+	py::array_t<T> view(const std::vector<T> &values, py::handle owner) {
+		return view(values.data(), values.size(), owner);
+	}
+
+	// An array which takes over the values without copying them.
+	template <typename T>
+	py::array_t<T> take(std::vector<T> &&values) {
+		auto owned = new std::vector<T>(std::move(values));
+		py::capsule owner(owned, [](void *pointer) {
+			delete static_cast<std::vector<T> *>(pointer);
+		});
+		return py::array_t<T>({ (py::ssize_t)owned->size() }, { (py::ssize_t)sizeof(T) }, owned->data(), owner);
+	}
+
+	typedef Clock::time_point::rep TICKS;
+	static_assert(sizeof(Clock::time_point) == sizeof(TICKS), "the time points are viewed as their ticks");
+}
+
+PYBIND11_MODULE(lqtcontrol, m) {
+	m.doc() = "Acquisition, lock and simulation of LQTControl with NumPy views of the lock and scan data";
+
+	// the timers of the lock and the DAQ need an application, unless the script already created one
+	if (!QCoreApplication::instance()) {
+		static int argc{ 1 };
+		static char name[] = "lqtcontrol";
+		static char *argv[] = { name, nullptr };
+		new QCoreApplication(argc, argv);
+	}
+
+	// [s] duration of a tick of the time stamps in LockData.time
+	m.attr("CLOCK_PERIOD") = (double)Clock::time_point::period::num / Clock::time_point::period::den;
+	m.attr("MAX_CHANNELS") = DAQ_MAX_CHANNELS;
+
+	py::enum_<LOCKSTATE>(m, "LockState")
+		.value("INACTIVE", LOCKSTATE::INACTIVE)
+		.value("ACTIVE", LOCKSTATE::ACTIVE)
+		.value("FAILURE", LOCKSTATE::FAILURE);
+
+	py::enum_<LOCKTIMEBASE>(m, "LockTimebase")
+		.value("HOSTTIMER", LOCKTIMEBASE::HOSTTIMER)
+		.value("SAMPLECLOCK", LOCKTIMEBASE::SAMPLECLOCK);
+
+	py::enum_<LOCKACTUATOR>(m, "LockActuator")
+		.value("TEMPERATURE", LOCKACTUATOR::TEMPERATURE)
+		.value("ANALOG", LOCKACTUATOR::ANALOG)
+		.value("DUAL", LOCKACTUATOR::DUAL);
+
+	py::enum_<SCANPARAMETERS>(m, "ScanParameter")
+		.value("LOW", SCANPARAMETERS::LOW)
+		.value("HIGH", SCANPARAMETERS::HIGH)
+		.value("STEPS", SCANPARAMETERS::STEPS)
+		.value("INTERVAL", SCANPARAMETERS::INTERVAL);
+
+	py::enum_<LOCKPARAMETERS>(m, "LockParameter")
+		.value("P", LOCKPARAMETERS::P)
+		.value("I", LOCKPARAMETERS::I)
+		.value("D", LOCKPARAMETERS::D)
+		.value("SETPOINT", LOCKPARAMETERS::SETPOINT)
+		.value("PIPELINED", LOCKPARAMETERS::PIPELINED)
+		.value("ADAPTIVE", LOCKPARAMETERS::ADAPTIVE)
+		.value("MINTIMEOUT", LOCKPARAMETERS::MINTIMEOUT)
+		.value("MAXTIMEOUT", LOCKPARAMETERS::MAXTIMEOUT)
+		.value("FASTERROR", LOCKPARAMETERS::FASTERROR)
+		.value("FASTERRORRATE", LOCKPARAMETERS::FASTERRORRATE)
+		.value("STABLEERROR", LOCKPARAMETERS::STABLEERROR)
+		.value("TIMEBASE", LOCKPARAMETERS::TIMEBASE)
+		.value("SAMPLESPERUPDATE", LOCKPARAMETERS::SAMPLESPERUPDATE)
+		.value("ACTUATOR", LOCKPARAMETERS::ACTUATOR)
+		.value("ANALOGSCALING", LOCKPARAMETERS::ANALOGSCALING)
+		.value("ANALOGOFFSET", LOCKPARAMETERS::ANALOGOFFSET)
+		.value("ANALOGMIN", LOCKPARAMETERS::ANALOGMIN)
+		.value("ANALOGMAX", LOCKPARAMETERS::ANALOGMAX)
+		.value("CROSSOVER", LOCKPARAMETERS::CROSSOVER)
+		.value("DESATURATIONRATE", LOCKPARAMETERS::DESATURATIONRATE);
+
+	py::class_<SCAN_SETTINGS>(m, "ScanSettings")
+		.def_readonly("low", &SCAN_SETTINGS::low)
+		.def_readonly("high", &SCAN_SETTINGS::high)
+		.def_readonly("steps", &SCAN_SETTINGS::nrSteps)
+		.def_readonly("interval", &SCAN_SETTINGS::interval);
+
+	py::class_<LOCK_SETTINGS>(m, "LockSettings")
+		.def_readonly("proportional", &LOCK_SETTINGS::proportional)
+		.def_readonly("integral", &LOCK_SETTINGS::integral)
+		.def_readonly("derivative", &LOCK_SETTINGS::derivative)
+		.def_readonly("locking_timeout", &LOCK_SETTINGS::lockingTimeout)
+		.def_readonly("state", &LOCK_SETTINGS::state)
+		.def_readonly("transmission_setpoint", &LOCK_SETTINGS::transmissionSetpoint)
+		.def_readonly("pipelined", &LOCK_SETTINGS::pipelined)
+		.def_readonly("adaptive", &LOCK_SETTINGS::adaptive)
+		.def_readonly("min_locking_timeout", &LOCK_SETTINGS::minLockingTimeout)
+		.def_readonly("max_locking_timeout", &LOCK_SETTINGS::maxLockingTimeout)
+		.def_readonly("timebase", &LOCK_SETTINGS::timebase)
+		.def_readonly("samples_per_update", &LOCK_SETTINGS::samplesPerUpdate)
+		.def_readonly("actuator", &LOCK_SETTINGS::actuator)
+		.def_readonly("analog_scaling", &LOCK_SETTINGS::analogScaling)
+		.def_readonly("analog_offset", &LOCK_SETTINGS::analogOffset)
+		.def_readonly("analog_min_voltage", &LOCK_SETTINGS::analogMinVoltage)
+		.def_readonly("analog_max_voltage", &LOCK_SETTINGS::analogMaxVoltage)
+		.def_readonly("crossover_frequency", &LOCK_SETTINGS::crossoverFrequency)
+		.def_readonly("desaturation_rate", &LOCK_SETTINGS::desaturationRate);
+
+	// the arrays are views of the scan of the lock this was taken from
+	py::class_<SCAN_DATA>(m, "ScanData")
+		.def_readonly("running", &SCAN_DATA::m_running)
+		.def_readonly("pass_", &SCAN_DATA::pass)
+		.def_readonly("steps", &SCAN_DATA::nrSteps)
+		.def_property_readonly("temperatures", [](py::object self) { return view(self.cast<const SCAN_DATA &>().temperatures, self); })
+		.def_property_readonly("reference", [](py::object self) { return view(self.cast<const SCAN_DATA &>().reference, self); })
+		.def_property_readonly("absorption", [](py::object self) { return view(self.cast<const SCAN_DATA &>().absorption, self); })
+		.def_property_readonly("quotient", [](py::object self) { return view(self.cast<const SCAN_DATA &>().quotient, self); })
+		.def_property_readonly("transmission", [](py::object self) { return view(self.cast<const SCAN_DATA &>().transmission, self); });
+
+	// the arrays are views of the ring of the lock history, next_index is the index written next,
+	// once wrapped is set numpy.roll(array, -next_index) puts it in chronological order
+	py::class_<LOCK_DATA>(m, "LockData")
+		.def_property_readonly("time", [](py::object self) {
+			const auto &time = self.cast<const LOCK_DATA &>().time;
+			return view(reinterpret_cast<const TICKS *>(time.data()), time.size(), self);
+		})
+		.def_property_readonly("temp_offset", [](py::object self) { return view(self.cast<const LOCK_DATA &>().tempOffset, self); })
+		.def_property_readonly("absorption", [](py::object self) { return view(self.cast<const LOCK_DATA &>().absorption, self); })
+		.def_property_readonly("reference", [](py::object self) { return view(self.cast<const LOCK_DATA &>().reference, self); })
+		.def_property_readonly("quotient", [](py::object self) { return view(self.cast<const LOCK_DATA &>().quotient, self); })
+		.def_property_readonly("transmission", [](py::object self) { return view(self.cast<const LOCK_DATA &>().transmission, self); })
+		.def_property_readonly("error", [](py::object self) { return view(self.cast<const LOCK_DATA &>().error, self); })
+		.def_property_readonly("output_voltage", [](py::object self) { return view(self.cast<const LOCK_DATA &>().outputVoltage, self); })
+		.def_readonly("quotient_max", &LOCK_DATA::quotient_max)
+		.def_readonly("i_error", &LOCK_DATA::iError)
+		.def_readonly("current_temp_offset", &LOCK_DATA::currentTempOffset)
+		.def_readonly("fast_offset", &LOCK_DATA::fastOffset)
+		.def_readonly("offset_mean", &LOCK_DATA::offsetMean)
+		.def_readonly("storage_duration", &LOCK_DATA::storageDuration)
+		.def_readonly("storage_size", &LOCK_DATA::storageSize)
+		.def_readonly("next_index", &LOCK_DATA::nextIndex)
+		.def_readonly("wrapped", &LOCK_DATA::wrapped)
+		.def_property_readonly("start_time", [](const LOCK_DATA &data) { return data.startTime.time_since_epoch().count(); });
+
+	// the objects belong to a simulation or to the program which embeds the interpreter
+	py::class_<daq, std::unique_ptr<daq, py::nodelete>>(m, "Daq")
+		.def("connect", &daq::connect)
+		.def("disconnect", &daq::disconnect)
+		.def("set_sample_rate", &daq::setSampleRate)
+		.def("set_range", &daq::setRange)
+		.def("set_number_samples", &daq::setNumberSamples)
+		.def("set_output_voltage", &daq::setOutputVoltage)
+		.def_property_readonly("sampling_rates", &daq::getSamplingRates)
+		.def_property_readonly("current_sampling_rate", &daq::getCurrentSamplingRate)
+		// [mV] captures a block, one array per channel which is empty if the channel is disabled
+		.def("collect_block", [](daq &acquisition) {
+			std::array<std::vector<int32_t>, DAQ_MAX_CHANNELS> values;
+			acquisition.collectBlockData(values);
+			py::list channels;
+			for (auto &channel : values) {
+				channels.append(take(std::move(channel)));
+			}
+			return channels;
+		});
+
+	py::class_<SYNTHETIC_SETTINGS>(m, "SyntheticSettings")
+		.def(py::init<>())
+		.def_readwrite("seed", &SYNTHETIC_SETTINGS::seed)
+		.def_readwrite("reference_level", &SYNTHETIC_SETTINGS::referenceLevel)
+		.def_readwrite("absorption_level", &SYNTHETIC_SETTINGS::absorptionLevel)
+		.def_readwrite("absorption_depth", &SYNTHETIC_SETTINGS::absorptionDepth)
+		.def_readwrite("linewidth", &SYNTHETIC_SETTINGS::linewidth)
+		.def_readwrite("detuning", &SYNTHETIC_SETTINGS::detuning)
+		.def_readwrite("drift", &SYNTHETIC_SETTINGS::drift)
+		.def_readwrite("noise", &SYNTHETIC_SETTINGS::noise)
+		.def_readwrite("offset_a", &SYNTHETIC_SETTINGS::offsetA)
+		.def_readwrite("offset_b", &SYNTHETIC_SETTINGS::offsetB)
+		.def_readwrite("overflow_rate", &SYNTHETIC_SETTINGS::overflowRate)
+		.def_readwrite("capture_latency", &SYNTHETIC_SETTINGS::captureLatency);
+
+	py::class_<daq_Synthetic, daq, std::unique_ptr<daq_Synthetic, py::nodelete>>(m, "SyntheticDaq")
+		.def_property("synthetic_settings", &daq_Synthetic::getSyntheticSettings, &daq_Synthetic::setSyntheticSettings);
+
+	py::class_<Locking, std::unique_ptr<Locking, py::nodelete>>(m, "Locking")
+		.def("set_lock_parameter", &Locking::setLockParameters)
+		.def("set_scan_parameter", &Locking::setScanParameters)
+		.def("set_analog_range", &Locking::setAnalogRange, py::arg("min_voltage"), py::arg("max_voltage"))
+		.def("set_lock_state", &Locking::setLockState)
+		.def("start_scan", &Locking::startScan)
+		.def("start_stop_acquire_locking", &Locking::startStopAcquireLocking)
+		.def("start_stop_locking", &Locking::startStopLocking)
+		.def("number_of_samples", &Locking::getNumberOfSamples)
+		.def_property_readonly("lock_settings", &Locking::getLockSettings)
+		.def_property_readonly("scan_settings", &Locking::getScanSettings)
+		.def_property_readonly("locking_timeout", &Locking::getLockingTimeout)
+		.def_property_readonly("acquire_locking_running", &Locking::getAcquireLockingRunning)
+		// [s] takes effect when the acquisition for the lock is started
+		.def_property("storage_duration",
+			[](const Locking &locking) { return locking.lockData.storageDuration; },
+			[](Locking &locking, int duration) {
+				if (duration <= 0) {
+					throw py::value_error("The storage duration has to be positive.");
+				}
+				locking.lockData.storageDuration = duration;
+			})
+		.def_readonly("lock_data", &Locking::lockData)
+		.def_readonly("scan_data", &Locking::scanData);
+
+	py::class_<LASER_TWIN_SETTINGS>(m, "TwinSettings")
+		.def(py::init<>())
+		.def_readwrite("seed", &LASER_TWIN_SETTINGS::seed)
+		.def_readwrite("time_constant", &LASER_TWIN_SETTINGS::timeConstant)
+		.def_readwrite("dead_time", &LASER_TWIN_SETTINGS::deadTime)
+		.def_readwrite("line_center", &LASER_TWIN_SETTINGS::lineCenter)
+		.def_readwrite("drift", &LASER_TWIN_SETTINGS::drift)
+		.def_readwrite("wander", &LASER_TWIN_SETTINGS::wander)
+		.def_readwrite("tuning", &LASER_TWIN_SETTINGS::tuning);
+
+	// the simulation does not hold the interpreter lock while it runs
+	py::class_<Simulation>(m, "Simulation")
+		.def(py::init<LASER_TWIN_SETTINGS>(), py::arg("twin") = LASER_TWIN_SETTINGS{})
+		.def_property_readonly("locking", &Simulation::getLocking)
+		.def_property_readonly("acquisition", &Simulation::getAcquisition)
+		.def_property_readonly("time", &Simulation::getTime)
+		.def_property_readonly("laser_temperature", &Simulation::getLaserTemperature)
+		.def_property_readonly("line_center", &Simulation::getLineCenter)
+		.def("run", &Simulation::run, py::arg("duration"), py::call_guard<py::gil_scoped_release>())
+		.def("run_scan", &Simulation::runScan, py::call_guard<py::gil_scoped_release>())
+		.def("wait_for_laser", &Simulation::waitForLaser, py::call_guard<py::gil_scoped_release>());
+}
\ No newline at end of file
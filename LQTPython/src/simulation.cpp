@@ -0,0 +1,138 @@
+#include "simulation.h"
+#include "twinTransport.h"
+
+#include <stdexcept>
+
+namespace {
+	// the clock is global, a second simulation would run on the time of the first one
+	bool simulationExists{ false };
+
+	double seconds(Clock::time_point::duration duration) {
+		return std::chrono::duration<double>(duration).count();
+	}
+}
+
+Simulation::Simulation(LASER_TWIN_SETTINGS settings) {
+	if (simulationExists) {
+		throw std::runtime_error("Only one simulation can exist at a time.");
+	}
+	simulationExists = true;
+
+	// everything from here on runs in virtual time
+	Clock::set(&m_clock);
+	m_start = m_clock.now();
+	m_twin = std::make_unique<LaserTwin>(settings, m_start);
+
+	// the status polling would run in real time
+	m_laser = std::make_unique<LQT>();
+	m_laser->setTransport(new TwinTransport(m_twin.get(), EMULATOR_SETTINGS{}));
+	m_laser->setStatusPollingInterval(0);
+	m_serialThread.startWorker(m_laser.get());
+	QMetaObject::invokeMethod(m_laser.get(), "connect", Qt::BlockingQueuedConnection);
+
+	m_acquisition = std::make_unique<daq_Synthetic>(nullptr);
+	SYNTHETIC_SETTINGS acquisitionSettings = m_acquisition->getSyntheticSettings();
+	acquisitionSettings.seed = settings.seed;
+	acquisitionSettings.linewidth *= settings.tuning;
+	m_acquisition->setSyntheticSettings(acquisitionSettings);
+	LaserTwin *twin = m_twin.get();
+	m_acquisition->setDetuningModel([twin](Clock::time_point time) {
+		return twin->getDetuning(time);
+	});
+	m_acquisition->init();
+	m_acquisition->connect();
+	m_dataAcquisition = m_acquisition.get();
+
+	m_locking = std::make_unique<Locking>(nullptr, &m_dataAcquisition, m_laser.get());
+	m_locking->init();
+}
+
+Simulation::~Simulation() {
+	if (m_locking->getAcquireLockingRunning()) {
+		m_locking->startStopAcquireLocking();
+	}
+	if (m_locking->scanData.m_running) {
+		m_locking->startScan();
+	}
+	waitForLaser();
+	m_acquisition->disconnect();
+	QMetaObject::invokeMethod(m_laser.get(), "disconnect", Qt::BlockingQueuedConnection);
+	m_serialThread.quit();
+	m_serialThread.wait();
+	// the lock and the DAQ ask the clock for the time until they are gone
+	m_locking.reset();
+	m_acquisition.reset();
+	Clock::set(nullptr);
+	simulationExists = false;
+}
+
+Locking &Simulation::getLocking() {
+	return *m_locking;
+}
+
+daq_Synthetic &Simulation::getAcquisition() {
+	return *m_acquisition;
+}
+
+double Simulation::getTime() {
+	return seconds(m_clock.now() - m_start);
+}
+
+double Simulation::getLaserTemperature() {
+	return m_twin->getTemperature(m_clock.now());
+}
+
+double Simulation::getLineCenter() {
+	return m_twin->getLineCenter(m_clock.now());
+}
+
+void Simulation::run(double duration) {
+	auto end = m_clock.now() + std::chrono::microseconds((int64_t)(1e6 * duration));
+	waitForLaser();
+	while (m_clock.now() < end) {
+		// the timers start counting when the lock or the scan is started, and like a QTimer
+		// they do not catch up with ticks missed while a capture took the virtual time
+		bool lockRunning = m_locking->getAcquireLockingRunning();
+		bool scanRunning = m_locking->scanData.m_running;
+		if (lockRunning && (!m_lockRunning || m_nextLock < m_clock.now())) {
+			m_nextLock = m_clock.now() + std::chrono::milliseconds(m_locking->getLockingTimeout());
+		}
+		if (scanRunning && (!m_scanRunning || m_nextScan < m_clock.now())) {
+			m_nextScan = m_clock.now() + std::chrono::seconds(1);
+		}
+		m_lockRunning = lockRunning;
+		m_scanRunning = scanRunning;
+
+		auto next = end;
+		if (lockRunning && m_nextLock < next) {
+			next = m_nextLock;
+		}
+		if (scanRunning && m_nextScan < next) {
+			next = m_nextScan;
+		}
+		m_clock.sleepUntil(next);
+		if (lockRunning && m_nextLock <= next) {
+			QMetaObject::invokeMethod(m_locking.get(), "lock", Qt::DirectConnection);
+			m_nextLock += std::chrono::milliseconds(m_locking->getLockingTimeout());
+		}
+		if (scanRunning && m_nextScan <= next) {
+			QMetaObject::invokeMethod(m_locking.get(), "scan", Qt::DirectConnection);
+			m_nextScan += std::chrono::seconds(1);
+		}
+		waitForLaser();
+	}
+}
+
+void Simulation::runScan() {
+	if (!m_locking->scanData.m_running) {
+		m_locking->startScan();
+	}
+	while (m_locking->scanData.m_running) {
+		run(1);
+	}
+}
+
+// The marker is served last, since it has the lowest priority.
+void Simulation::waitForLaser() {
+	m_laser->request(LQT_COMMAND::OTHER, 0, LQT_PRIORITY::STATUS).wait();
+}
\ No newline at end of file
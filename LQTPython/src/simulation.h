@@ -0,0 +1,58 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <memory>
+
+#include "clock.h"
+#include "locking.h"
+#include "thread.h"
+#include "Devices/DAQ_Synthetic.h"
+#include "Devices/LQT.h"
+#include "laserTwin.h"
+
+/*
+ * The lock, the scan and the synthetic DAQ against the digital twin of the laser under virtual
+ * time like in LQTSimulation, but advanced step by step by a script. The laser lives on its own
+ * thread, the lock and the DAQ on the thread of the caller, which triggers their updates when
+ * their timers would fire. Only one simulation can exist at a time, since it replaces the clock.
+ */
+class Simulation {
+
+public:
+	explicit Simulation(LASER_TWIN_SETTINGS settings);
+	~Simulation();
+
+	Locking &getLocking();
+	daq_Synthetic &getAcquisition();
+
+	// [s]	virtual time passed since the simulation was created
+	double getTime();
+	// [K]	temperature offset of the laser twin
+	double getLaserTemperature();
+	// [K]	temperature offset at which the laser twin is on resonance
+	double getLineCenter();
+
+	// advances the virtual time by duration [s], updating the lock and the scan whenever their timers would fire
+	void run(double duration);
+	// starts a scan unless one is running and runs it to its end
+	void runScan();
+	// lets the laser execute all requests queued so far
+	void waitForLaser();
+
+private:
+	VirtualClock m_clock;
+	Clock::time_point m_start;
+	std::unique_ptr<LaserTwin> m_twin;
+	std::unique_ptr<LQT> m_laser;
+	Thread m_serialThread{ THREAD_ROLE::SERIAL };
+	std::unique_ptr<daq_Synthetic> m_acquisition;
+	daq *m_dataAcquisition{ nullptr };
+	std::unique_ptr<Locking> m_locking;
+
+	bool m_lockRunning{ false };	//		whether the lock timer ran at the last step
+	bool m_scanRunning{ false };	//		whether the scan timer ran at the last step
+	Clock::time_point m_nextLock;	//		time the lock timer fires next
+	Clock::time_point m_nextScan;	//		time the scan timer fires next
+};
+
+#endif // SIMULATION_H
\ No newline at end of file
@@ -0,0 +1,82 @@
+"""
+Smoke test of the Python module lqtcontrol, run with the directory the module was built to:
+
+    PYTHONPATH=<build directory> python3 -m unittest discover LQTPython/test
+"""
+import unittest
+
+import numpy
+
+import lqtcontrol
+
+
+class SimulationTest(unittest.TestCase):
+    # only one simulation can exist at a time and the views keep it alive
+    @classmethod
+    def setUpClass(cls):
+        cls.simulation = lqtcontrol.Simulation()
+        cls.locking = cls.simulation.locking
+
+    def scan(self, steps):
+        self.assertTrue(self.locking.set_scan_parameter(lqtcontrol.ScanParameter.STEPS, steps))
+        self.simulation.run_scan()
+        return self.locking.scan_data
+
+    def test_scan_arrays(self):
+        scan = self.scan(20)
+        self.assertEqual(scan.steps, 20)
+        for name in ("temperatures", "reference", "absorption", "quotient", "transmission"):
+            array = getattr(scan, name)
+            self.assertEqual(array.shape, (20,), name)
+            self.assertEqual(array.dtype, numpy.float64, name)
+        settings = self.locking.scan_settings
+        self.assertAlmostEqual(scan.temperatures[0], settings.low)
+        self.assertAlmostEqual(scan.temperatures[-1], settings.high)
+        self.assertAlmostEqual(numpy.nanmax(scan.transmission), 1)
+
+    def test_scan_arrays_read_only(self):
+        scan = self.scan(10)
+        for name in ("temperatures", "reference", "absorption", "quotient", "transmission"):
+            array = getattr(scan, name)
+            self.assertFalse(array.flags.writeable, name)
+            with self.assertRaises(ValueError):
+                array[0] = 0
+
+    def test_rescan_in_place(self):
+        # a view taken before the scan is started again still reads the buffer of the scan
+        before = self.scan(30).temperatures
+        after = self.scan(10).temperatures
+        self.assertEqual(before.shape, (30,))
+        self.assertEqual(after.shape, (10,))
+        self.assertEqual(before.__array_interface__["data"][0], after.__array_interface__["data"][0])
+        numpy.testing.assert_array_equal(before[:10], after)
+
+    def test_scan_steps_limit(self):
+        steps = self.locking.scan_settings.steps
+        self.assertFalse(self.locking.set_scan_parameter(lqtcontrol.ScanParameter.STEPS, 100000))
+        self.assertFalse(self.locking.set_scan_parameter(lqtcontrol.ScanParameter.STEPS, 0))
+        self.assertEqual(self.locking.scan_settings.steps, steps)
+
+    def test_storage_duration_positive(self):
+        duration = self.locking.storage_duration
+        for value in (0, -1):
+            with self.assertRaises(ValueError):
+                self.locking.storage_duration = value
+        self.assertEqual(self.locking.storage_duration, duration)
+
+    def test_lock_arrays(self):
+        self.locking.start_stop_acquire_locking()
+        self.simulation.run(2)
+        self.locking.start_stop_acquire_locking()
+        history = self.locking.lock_data
+        self.assertGreater(history.next_index, 0)
+        dtypes = {"time": numpy.int64, "absorption": numpy.int32, "reference": numpy.int32}
+        for name in ("time", "temp_offset", "absorption", "reference", "quotient", "transmission", "error", "output_voltage"):
+            array = getattr(history, name)
+            self.assertEqual(array.shape, (history.storage_size,), name)
+            self.assertEqual(array.dtype, dtypes.get(name, numpy.float64), name)
+            self.assertFalse(array.flags.writeable, name)
+
+
+if __name__ == "__main__":
+    unittest.main()
\ No newline at end of file
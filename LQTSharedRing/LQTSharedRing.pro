@@ -0,0 +1,15 @@
+# ----------------------------------------------------
+# Reader of the shared memory rings LQTControl exports
+# the live blocks and the lock updates to. Needs no Qt.
+# ----------------------------------------------------
+
+TEMPLATE = lib
+TARGET = LQTSharedRing
+CONFIG += c++14 staticlib
+CONFIG -= qt
+unix:!macx:LIBS += -lrt
+INCLUDEPATH += ./src \
+    ../LQTControl/src
+HEADERS += ./src/sharedRingReader.h \
+    ../LQTControl/src/sharedRingLayout.h
+SOURCES += ./src/sharedRingReader.cpp
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include "sharedRingReader.h"
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+SharedRingReader::SharedRingReader() noexcept {}
+
+SharedRingReader::~SharedRingReader() {
+	close();
+}
+
+bool SharedRingReader::open(const std::string &name) {
+	close();
+
+#ifdef _WIN32
+	std::string path = "Local\\" + name;
+	m_handle = OpenFileMappingA(FILE_MAP_READ, FALSE, path.c_str());
+	if (!m_handle) {
+		m_errorString = "OpenFileMapping failed with error " + std::to_string(GetLastError());
+		return false;
+	}
+	m_mapping = MapViewOfFile(m_handle, FILE_MAP_READ, 0, 0, 0);
+	if (!m_mapping) {
+		m_errorString = "MapViewOfFile failed with error " + std::to_string(GetLastError());
+		CloseHandle(m_handle);
+		m_handle = nullptr;
+		return false;
+	}
+	MEMORY_BASIC_INFORMATION info;
+	VirtualQuery(m_mapping, &info, sizeof(info));
+	m_size = info.RegionSize;
+#else
+	std::string path = (name.size() > 0 && name[0] == '/') ? name : "/" + name;
+	int fd = shm_open(path.c_str(), O_RDONLY, 0);
+	if (fd < 0) {
+		m_errorString = "shm_open failed: " + std::string(strerror(errno));
+		return false;
+	}
+	struct stat status;
+	if (fstat(fd, &status) != 0) {
+		m_errorString = "fstat failed: " + std::string(strerror(errno));
+		::close(fd);
+		return false;
+	}
+	m_size = (uint64_t)status.st_size;
+	void *mapping = (m_size >= sizeof(SHARED_RING_HEADER)) ? mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+	::close(fd);
+	if (mapping == MAP_FAILED) {
+		m_errorString = "mmap failed: " + std::string(strerror(errno));
+		return false;
+	}
+	m_mapping = mapping;
+#endif
+
+	m_header = static_cast<const SHARED_RING_HEADER *>(m_mapping);
+	// the writer sets the magic last, its absence means the ring is not ready yet
+	if (m_header->magic.load(std::memory_order_acquire) != SHARED_RING_MAGIC || m_header->version != SHARED_RING_VERSION
+		|| m_header->slotCount < 1 || sharedRing::mappingSize(*m_header) > m_size) {
+		m_errorString = "not a ring of this version or not ready yet";
+		close();
+		return false;
+	}
+	m_errorString.clear();
+	return true;
+}
+
+void SharedRingReader::close() {
+	if (!m_mapping) {
+		return;
+	}
+#ifdef _WIN32
+	UnmapViewOfFile(m_mapping);
+	CloseHandle(m_handle);
+	m_handle = nullptr;
+#else
+	munmap(const_cast<void *>(m_mapping), m_size);
+#endif
+	m_mapping = nullptr;
+	m_header = nullptr;
+}
+
+bool SharedRingReader::isOpen() {
+	return m_mapping != nullptr;
+}
+
+std::string SharedRingReader::errorString() {
+	return m_errorString;
+}
+
+const SHARED_RING_HEADER *SharedRingReader::getHeader() {
+	return m_header;
+}
+
+uint64_t SharedRingReader::getPublished() {
+	return m_header ? m_header->published.load(std::memory_order_acquire) : 0;
+}
+
+uint64_t SharedRingReader::getOldest() {
+	if (!m_header) {
+		return 0;
+	}
+	uint64_t published = getPublished();
+	return (published > m_header->slotCount) ? published - m_header->slotCount : 0;
+}
+
+const void *SharedRingReader::getRecord(uint64_t n) {
+	if (!m_header) {
+		return nullptr;
+	}
+	const SHARED_RING_SLOT *slot = sharedRing::slot(m_mapping, *m_header, n);
+	if (slot->sequence.load(std::memory_order_acquire) != 2 * n + 2) {
+		return nullptr;
+	}
+	return slot + 1;
+}
+
+const SHARED_LOCK_RECORD *SharedRingReader::getLockRecord(uint64_t n) {
+	return (m_header && m_header->kind == SHARED_RING_LOCK) ? static_cast<const SHARED_LOCK_RECORD *>(getRecord(n)) : nullptr;
+}
+
+const SHARED_LIVE_RECORD *SharedRingReader::getLiveRecord(uint64_t n) {
+	return (m_header && m_header->kind == SHARED_RING_LIVE) ? static_cast<const SHARED_LIVE_RECORD *>(getRecord(n)) : nullptr;
+}
+
+const int32_t *SharedRingReader::getLiveValues(const SHARED_LIVE_RECORD *record, uint32_t channel) {
+	return sharedRing::liveValues(record, m_header->maxSamples, channel);
+}
+
+bool SharedRingReader::isValid(uint64_t n) {
+	if (!m_header) {
+		return false;
+	}
+	// the reads of the record must not move past the second read of the sequence
+	std::atomic_thread_fence(std::memory_order_acquire);
+	const SHARED_RING_SLOT *slot = sharedRing::slot(m_mapping, *m_header, n);
+	return slot->sequence.load(std::memory_order_relaxed) == 2 * n + 2;
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#ifndef SHAREDRINGREADER_H
+#define SHAREDRINGREADER_H
+
+#include <string>
+
+#include "sharedRingLayout.h"
+
+/*
+ * Maps a ring LQTControl writes to read-only and gives access to its records in place, see
+ * sharedRingLayout.h for the layout and the protocol. A record has to be checked with
+ * isValid() after it was read, the writer may have overwritten it in between:
+ *
+ *   SharedRingReader reader;
+ *   reader.open("lqtcontrol-lock");
+ *   uint64_t n = reader.getPublished();
+ *   ...
+ *   while (n < reader.getPublished()) {
+ *       auto record = reader.getLockRecord(n);
+ *       // nullptr once the record was overwritten
+ *       if (record) {
+ *           double error = record->error;
+ *           if (reader.isValid(n)) { use(error); }
+ *       }
+ *       n++;
+ *   }
+ *
+ * Several readers may map the same ring, none of them slows the writer down. A reader which
+ * falls more than slotCount records behind loses the oldest ones. On Windows, a writer can only
+ * create the ring again once every reader closed the mapping of its previous one.
+ */
+class SharedRingReader {
+
+public:
+	SharedRingReader() noexcept;
+	~SharedRingReader();
+
+	// maps the ring, a name without a leading slash gets one on POSIX
+	bool open(const std::string &name);
+	void close();
+	bool isOpen();
+	std::string errorString();
+
+	const SHARED_RING_HEADER *getHeader();
+	// number of records written, the newest one is getPublished() - 1
+	uint64_t getPublished();
+	// number of the oldest record which may still be in the ring
+	uint64_t getOldest();
+
+	// the record in the mapping, nullptr if it is not in the ring anymore or not written yet
+	const void *getRecord(uint64_t n);
+	const SHARED_LOCK_RECORD *getLockRecord(uint64_t n);
+	const SHARED_LIVE_RECORD *getLiveRecord(uint64_t n);
+	const int32_t *getLiveValues(const SHARED_LIVE_RECORD *record, uint32_t channel);
+
+	// whether record n is still the complete record it was when getRecord() returned it
+	bool isValid(uint64_t n);
+
+private:
+	std::string m_errorString;
+	const void *m_mapping{ nullptr };
+	uint64_t m_size{ 0 };
+	const SHARED_RING_HEADER *m_header{ nullptr };
+#ifdef _WIN32
+	void *m_handle{ nullptr };
+#endif
+};
+
+#endif // SHAREDRINGREADER_H
\ No newline at end of file
@@ -0,0 +1,47 @@
+# ----------------------------------------------------
+# Digital twin of the laser and the absorption cell,
+# runs the lock loop, the scan and a soak test under
+# virtual time.
+# ----------------------------------------------------
+
+TEMPLATE = app
+TARGET = LQTSimulation
+QT += core widgets serialport charts
+CONFIG += console c++14
+CONFIG -= app_bundle
+DEFINES += LQTCONTROL_COUNT_ALLOCATIONS
+INCLUDEPATH += ./src \
+    ../LQTControl/src \
+    ../LQTEmulator/src \
+    ../LQTControl/external/gsl/include \
+    ../LQTControl/external/fmt/include
+HEADERS += ./src/laserTwin.h \
+    ./src/twinTransport.h \
+    ../LQTControl/src/allocationCounter.h \
+    ../LQTControl/src/clock.h \
+    ../LQTControl/src/generalmath.h \
+    ../LQTControl/src/lockView.h \
+    ../LQTControl/src/locking.h \
+    ../LQTControl/src/sharedRingLayout.h \
+    ../LQTControl/src/sharedRingWriter.h \
+    ../LQTControl/src/thread.h \
+    ../LQTControl/src/Devices/daq.h \
+    ../LQTControl/src/Devices/DAQ_Synthetic.h \
+    ../LQTControl/src/Devices/LQT.h
+SOURCES += ./src/main.cpp \
+    ./src/laserTwin.cpp \
+    ./src/twinTransport.cpp \
+    ../LQTEmulator/src/lqtEmulator.cpp \
+    ../LQTControl/src/allocationCounter.cpp \
+    ../LQTControl/src/clock.cpp \
+    ../LQTControl/src/locking.cpp \
+    ../LQTControl/src/sharedRingWriter.cpp \
+    ../LQTControl/src/thread.cpp \
+    ../LQTControl/src/Devices/daq.cpp \
+    ../LQTControl/src/Devices/DAQ_Synthetic.cpp \
+    ../LQTControl/src/Devices/LQT.cpp \
+    ../LQTControl/src/Devices/serialTransport.cpp \
+    ../LQTControl/src/Devices/traceTransport.cpp \
+    ../LQTControl/external/fmt/src/format.cc
+win32:LIBS += -lpsapi
+unix:!macx:LIBS += -lrt
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include "laserTwin.h"
+#include <cmath>
+
+namespace {
+	// the temperature does not change noticeably faster, so the state is only advanced in steps of at least this
+	const auto resolution = std::chrono::milliseconds(1);
+}
+
+LaserTwin::LaserTwin(LASER_TWIN_SETTINGS settings, time_point start) noexcept :
+	m_settings(settings), m_generator(settings.seed), m_time(start) {}
+
+void LaserTwin::setSetpoint(double setpoint, time_point time) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto acting = time + std::chrono::microseconds((int64_t)(1e6 * m_settings.deadTime));
+	m_pending.push_back({ acting, setpoint });
+}
+
+double LaserTwin::getTemperature(time_point time) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	advance(time);
+	return m_temperature;
+}
+
+double LaserTwin::getLineCenter(time_point time) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	advance(time);
+	return m_settings.lineCenter + m_lineOffset;
+}
+
+double LaserTwin::getDetuning(time_point time) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	advance(time);
+	return m_settings.tuning * (m_temperature - m_settings.lineCenter - m_lineOffset);
+}
+
+LASER_TWIN_SETTINGS LaserTwin::getSettings() {
+	return m_settings;
+}
+
+// Has to be called with the mutex locked.
+void LaserTwin::advance(time_point time) {
+	if (time < m_time + resolution) {
+		return;
+	}
+	// the setpoints act one after the other, the temperature follows the setpoint valid in between
+	while (m_pending.size() > 0 && m_pending.front().first <= time) {
+		auto acting = m_pending.front().first;
+		if (acting > m_time) {
+			integrate(std::chrono::duration<double>(acting - m_time).count());
+			m_time = acting;
+		}
+		m_setpoint = m_pending.front().second;
+		m_pending.pop_front();
+	}
+	integrate(std::chrono::duration<double>(time - m_time).count());
+	m_time = time;
+}
+
+// The exact solution of the first order lag for a constant setpoint.
+void LaserTwin::integrate(double dt) {
+	if (dt <= 0) {
+		return;
+	}
+	m_temperature += (m_setpoint - m_temperature) * (1 - exp(-dt / m_settings.timeConstant));
+	m_lineOffset += m_settings.drift * dt + m_settings.wander * sqrt(dt) * m_normal(m_generator);
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#ifndef LASERTWIN_H
+#define LASERTWIN_H
+
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <random>
+
+typedef struct LASER_TWIN_SETTINGS {
+	unsigned int seed{ 1 };			//		seed of the random walk of the line
+	double timeConstant{ 20 };		// [s]	thermal time constant of the laser temperature
+	double deadTime{ 1 };			// [s]	time until a new setpoint starts to act on the temperature
+	double lineCenter{ 1 };			// [K]	temperature offset at which the laser is on resonance with the line
+	double drift{ 1e-5 };			// [K/s]	drift of the line relative to the laser, e.g. by the ambient temperature
+	double wander{ 1e-4 };			// [K/s^0.5]	random walk of the line relative to the laser
+	double tuning{ 1 };				// [V/K]	output voltage of the DAQ equivalent to a temperature change of 1 K
+} LASER_TWIN_SETTINGS;
+
+/*
+ * Thermal model of the laser and its detuning from the absorption line.
+ * The temperature follows the setpoint with a dead time and a first order lag,
+ * the line drifts and wanders. The state is advanced with the time it is queried for,
+ * which has to increase monotonically, e.g. the time of a virtual clock.
+ */
+class LaserTwin {
+
+public:
+	typedef std::chrono::system_clock::time_point time_point;
+
+	LaserTwin(LASER_TWIN_SETTINGS settings, time_point start) noexcept;
+
+	// the laser received a new temperature setpoint [K]
+	void setSetpoint(double setpoint, time_point time);
+
+	// [K]	temperature offset of the laser
+	double getTemperature(time_point time);
+	// [K]	temperature offset at which the laser is on resonance
+	double getLineCenter(time_point time);
+	// [V]	detuning from the line in units of the output voltage of the DAQ
+	double getDetuning(time_point time);
+
+	LASER_TWIN_SETTINGS getSettings();
+
+private:
+	void advance(time_point time);
+	void integrate(double dt);
+
+	LASER_TWIN_SETTINGS m_settings;
+	std::mutex m_mutex;
+	std::mt19937 m_generator;
+	std::normal_distribution<double> m_normal{ 0.0, 1.0 };
+
+	time_point m_time;										//		time of the current state
+	std::deque<std::pair<time_point, double>> m_pending;	//		setpoints and the time they start to act
+	double m_setpoint{ 0 };									// [K]	setpoint currently acting on the temperature
+	double m_temperature{ 0 };								// [K]	temperature offset of the laser
+	double m_lineOffset{ 0 };								// [K]	accumulated drift and random walk of the line
+};
+
+#endif // LASERTWIN_H
\ No newline at end of file
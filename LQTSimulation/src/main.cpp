@@ -0,0 +1,542 @@
+/*
+ * Runs the lock loop or a scan of LQTControl against a digital twin of the laser and the
+ * absorption cell under virtual time, so hours of locking take seconds:
+ *
+ *   LQTSimulation --mode lock --duration 14400 --p 0.007 --i 0.001
+ *   LQTSimulation --mode scan --steps 100 --interval 10
+ *   LQTSimulation --mode soak --duration 259200 --storage 600
+ *
+ * The setpoints reach the twin through LQT and the serial protocol of the laser, the signals
+ * are generated by the synthetic DAQ from the detuning of the twin.
+ */
+#include "allocationCounter.h"
+#include "clock.h"
+#include "locking.h"
+#include "lockView.h"
+#include "thread.h"
+#include "Devices/LQT.h"
+#include "Devices/DAQ_Synthetic.h"
+#include "laserTwin.h"
+#include "twinTransport.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <iterator>
+
+#if defined(Q_OS_WIN)
+#include <Windows.h>
+#include <Psapi.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+typedef struct SIMULATION_SETTINGS {
+	QString mode{ "lock" };			//		"lock", "scan" or "soak"
+	double duration{ 4 * 3600 };	// [s]	simulated duration of the lock
+	double settle{ 10 };			// [s]	time the signals are acquired before the lock is started
+	double lockThreshold{ 0.02 };	// [1]	absolute error below which the laser counts as locked
+	double lockHold{ 10 };			// [s]	time the error has to stay below the threshold
+	double storage{ 3600 };			// [s]	duration of the lock history in the soak test, shorter than in LQTControl so it wraps often
+	double warmup{ 7200 };			// [s]	time until the soak test expects the metrics to level off
+	double sampleInterval{ 60 };	// [s]	interval between two samples of the metrics in the soak test
+	QString samplesFile{ "" };		//		file the samples of the soak test are written to as CSV
+} SIMULATION_SETTINGS;
+
+typedef struct SIMULATION_RESULT {
+	double simulated{ 0 };			// [s]	simulated time
+	double wall{ 0 };				// [s]	wall clock time of the simulation
+	double cpu{ 0 };				// [s]	processor time of the simulation
+	double peakMemory{ 0 };			// [MB]	peak resident memory of the process
+	uint64_t ticks{ 0 };			//		number of lock or scan updates
+	double meanTick{ 0 };			// [ms]	mean processing time of an update
+	double maxTick{ 0 };			// [ms]	maximum processing time of an update
+	uint64_t allocatingTicks{ 0 };	//		number of lock updates which allocated after the first one
+} SIMULATION_RESULT;
+
+enum class SOAK_METRIC {
+	MEMORY,
+	ALLOCATIONS,
+	POINTS,
+	LASERQUEUE,
+	BACKLOG,
+	UPDATETIME,
+	COUNT
+};
+
+typedef struct SOAK_METRIC_LIMIT {
+	const char *name;		//		name of the metric
+	const char *unit;		//		unit of the metric
+	double tolerance;		// [1]	growth after the warm-up relative to the level after the warm-up, which is tolerated
+	double slack;			//		absolute growth after the warm-up, which is always tolerated
+} SOAK_METRIC_LIMIT;
+
+// indexed by SOAK_METRIC, the update time is measured in wall clock time and varies with the load of the machine
+static const SOAK_METRIC_LIMIT soakLimits[] = {
+	{ "resident memory",		"MB",	0.05,	4 },
+	{ "heap allocations",		"",		0.05,	256 },
+	{ "lock view points",		"",		0,		8 },
+	{ "laser queue",			"",		0,		8 },
+	{ "streaming backlog",		"",		0,		10000 },
+	{ "update time",			"ms",	1,		0.1 }
+};
+
+typedef struct SOAK_SAMPLE {
+	double time{ 0 };				// [s]	simulated time since the start
+	std::array<double, static_cast<int>(SOAK_METRIC::COUNT)> values{};
+} SOAK_SAMPLE;
+
+// [MB]
+static double getPeakMemory() {
+#if defined(Q_OS_WIN)
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+		return counters.PeakWorkingSetSize / 1048576.0;
+	}
+	return 0;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0) {
+		return usage.ru_maxrss / 1024.0;
+	}
+	return 0;
+#endif
+}
+
+// [MB]
+static double getResidentMemory() {
+#if defined(Q_OS_WIN)
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+		return counters.WorkingSetSize / 1048576.0;
+	}
+	return 0;
+#else
+	// the second field of statm is the number of resident pages
+	FILE *statm = fopen("/proc/self/statm", "r");
+	if (!statm) {
+		return getPeakMemory();
+	}
+	long pages{ 0 };
+	long resident{ 0 };
+	int fields = fscanf(statm, "%ld %ld", &pages, &resident);
+	fclose(statm);
+	return (fields == 2) ? resident * (double)sysconf(_SC_PAGESIZE) / 1048576.0 : getPeakMemory();
+#endif
+}
+
+static double seconds(Clock::time_point::duration duration) {
+	return std::chrono::duration<double>(duration).count();
+}
+
+// Lets the laser execute all requests queued so far. The marker is served last, since it has the lowest priority.
+static void waitForLaser(LQT &laser) {
+	laser.request(LQT_COMMAND::OTHER, 0, LQT_PRIORITY::STATUS).wait();
+}
+
+static void printResources(const SIMULATION_RESULT &result) {
+	printf("Resources\n");
+	printf("  simulated time          %12.1f s\n", result.simulated);
+	printf("  wall time               %12.3f s\n", result.wall);
+	printf("  speed-up                %12.0f x\n", (result.wall > 0) ? result.simulated / result.wall : 0);
+	printf("  processor time          %12.3f s\n", result.cpu);
+	printf("  peak memory             %12.1f MB\n", result.peakMemory);
+	printf("  updates                 %12llu\n", (unsigned long long)result.ticks);
+	printf("  mean update time        %12.3f ms\n", result.meanTick);
+	printf("  max update time         %12.3f ms\n", result.maxTick);
+	printf("  allocating updates      %12llu\n", (unsigned long long)result.allocatingTicks);
+}
+
+/*
+ * Acquires for the settle time, starts the lock and runs it for the duration. The updates are
+ * triggered at the intervals the locking timer would have, the capture of a block takes its time.
+ */
+static int simulateLock(SIMULATION_SETTINGS settings, VirtualClock &clock, LQT &laser, Locking &locking, LaserTwin &twin, SIMULATION_RESULT &result) {
+	bool failed{ false };
+	QMetaObject::Connection connection = QObject::connect(&locking, &Locking::lockStateChanged, [&failed](LOCKSTATE state) {
+		failed = failed || (state == LOCKSTATE::FAILURE);
+	});
+	connection = QObject::connect(&locking, &Locking::timingStatisticsChanged, [&result](TIMER_STATISTICS statistics) {
+		result.ticks++;
+		result.meanTick += (statistics.lastDuration - result.meanTick) / result.ticks;
+		result.maxTick = (statistics.lastDuration > result.maxTick) ? statistics.lastDuration : result.maxTick;
+		if (statistics.timer == TIMERS::LOCKINGTIMER) {
+			result.allocatingTicks = statistics.allocatingTicks;
+		}
+	});
+
+	auto start = clock.now();
+	auto lockStart = start + std::chrono::microseconds((int64_t)(1e6 * settings.settle));
+	auto end = lockStart + std::chrono::microseconds((int64_t)(1e6 * settings.duration));
+	bool lockStarted{ false };
+
+	double sumSquaredError{ 0 };
+	double maxError{ 0 };
+	uint64_t lockedTicks{ 0 };
+	Clock::time_point belowSince{};	// time since which the error stayed below the threshold
+	bool below{ false };
+	double timeToLock{ -1 };		// [s]
+
+	locking.startStopAcquireLocking();
+	auto tick = clock.now();
+	while (clock.now() < end && !failed) {
+		tick += std::chrono::milliseconds(locking.getLockingTimeout());
+		clock.sleepUntil(tick);
+		if (!lockStarted && clock.now() >= lockStart) {
+			locking.startStopLocking();
+			lockStarted = true;
+		}
+		QMetaObject::invokeMethod(&locking, "lock", Qt::DirectConnection);
+		waitForLaser(laser);
+		if (!lockStarted || locking.lockData.storageSize == 0) {
+			continue;
+		}
+
+		auto index = generalmath::indexWrapped((int)locking.lockData.nextIndex - 1, locking.lockData.storageSize);
+		double error = locking.lockData.error[index];
+		auto now = locking.lockData.time[index];
+		if (std::abs(error) < settings.lockThreshold) {
+			if (!below) {
+				belowSince = now;
+				below = true;
+			}
+			if (timeToLock < 0 && seconds(now - belowSince) >= settings.lockHold) {
+				timeToLock = seconds(belowSince - lockStart);
+			}
+		} else {
+			below = false;
+		}
+		// the error is only judged once the laser is locked
+		if (timeToLock >= 0) {
+			sumSquaredError += error * error;
+			maxError = (std::abs(error) > maxError) ? std::abs(error) : maxError;
+			lockedTicks++;
+		}
+	}
+	locking.startStopAcquireLocking();
+	waitForLaser(laser);
+	result.simulated = seconds(clock.now() - start);
+
+	printf("Lock\n");
+	printf("  state                   %12s\n", failed ? "failed" : ((timeToLock >= 0) ? "locked" : "not locked"));
+	if (timeToLock >= 0) {
+		printf("  time to lock            %12.1f s\n", timeToLock);
+		printf("  RMS error               %12.5f\n", sqrt(sumSquaredError / lockedTicks));
+		printf("  max error               %12.5f\n", maxError);
+	}
+	printf("  laser temperature       %12.4f K\n", twin.getTemperature(clock.now()));
+	printf("  line center             %12.4f K\n", twin.getLineCenter(clock.now()));
+	return (failed || timeToLock < 0) ? 1 : 0;
+}
+
+/*
+ * Runs a scan with the scan timer ticking once per second and compares the transmission minimum it found to the line.
+ */
+static int simulateScan(VirtualClock &clock, LQT &laser, Locking &locking, LaserTwin &twin, SIMULATION_RESULT &result) {
+	QMetaObject::Connection connection = QObject::connect(&locking, &Locking::timingStatisticsChanged, [&result](TIMER_STATISTICS statistics) {
+		result.ticks++;
+		result.meanTick += (statistics.lastDuration - result.meanTick) / result.ticks;
+		result.maxTick = (statistics.lastDuration > result.maxTick) ? statistics.lastDuration : result.maxTick;
+	});
+
+	auto start = clock.now();
+	locking.startScan();
+	waitForLaser(laser);
+	auto tick = clock.now();
+	while (locking.scanData.m_running) {
+		tick += std::chrono::seconds(1);
+		clock.sleepUntil(tick);
+		QMetaObject::invokeMethod(&locking, "scan", Qt::DirectConnection);
+		waitForLaser(laser);
+	}
+	result.simulated = seconds(clock.now() - start);
+
+	auto minimum = std::min_element(locking.scanData.transmission.begin(), locking.scanData.transmission.end());
+	double found = locking.scanData.temperatures[std::distance(locking.scanData.transmission.begin(), minimum)];
+	printf("Scan\n");
+	printf("  steps                   %12d\n", locking.scanData.nrSteps);
+	printf("  minimum transmission    %12.4f\n", *minimum);
+	printf("  minimum found at        %12.4f K\n", found);
+	printf("  line center             %12.4f K\n", twin.getLineCenter(clock.now()));
+	return 0;
+}
+
+/*
+ * Runs the acquisition, the lock and the updates of the lock view for the duration and samples
+ * the resident memory, the live heap allocations, the points of the lock view, the queue depths
+ * and the update time. After the warm-up every metric has to level off, a metric which still grows
+ * from the first to the last third of the remaining samples fails the test.
+ */
+static int simulateSoak(SIMULATION_SETTINGS settings, VirtualClock &clock, LQT &laser, daq &acquisition, Locking &locking, SIMULATION_RESULT &result) {
+	// the series of the lock view, updated on every lock update like in LQTControl
+	QVector<QtCharts::QLineSeries *> plots;
+	for (gsl::index i{ 0 }; i < static_cast<int>(lockViewPlotTypes::COUNT); i++) {
+		plots.push_back(new QtCharts::QLineSeries());
+	}
+	gsl::index nextIndex{ 0 };
+	QMetaObject::Connection connection = QObject::connect(&locking, &Locking::locked, [&locking, &plots, &nextIndex]() {
+		lockView::appendLatest(locking.lockData, locking.getNumberOfSamples(5.0), plots, nextIndex);
+	});
+
+	uint64_t intervalTicks{ 0 };
+	double intervalTickTime{ 0 };	// [ms]
+	connection = QObject::connect(&locking, &Locking::timingStatisticsChanged, [&result, &intervalTicks, &intervalTickTime](TIMER_STATISTICS statistics) {
+		result.ticks++;
+		result.meanTick += (statistics.lastDuration - result.meanTick) / result.ticks;
+		result.maxTick = (statistics.lastDuration > result.maxTick) ? statistics.lastDuration : result.maxTick;
+		if (statistics.timer == TIMERS::LOCKINGTIMER) {
+			result.allocatingTicks = statistics.allocatingTicks;
+		}
+		intervalTicks++;
+		intervalTickTime += statistics.lastDuration;
+	});
+
+	locking.lockData.storageDuration = (int)settings.storage;
+	auto start = clock.now();
+	auto lockStart = start + std::chrono::microseconds((int64_t)(1e6 * settings.settle));
+	auto end = start + std::chrono::microseconds((int64_t)(1e6 * settings.duration));
+	auto sampleInterval = std::chrono::microseconds((int64_t)(1e6 * settings.sampleInterval));
+	auto nextSample = start + sampleInterval;
+	bool lockStarted{ false };
+	std::vector<SOAK_SAMPLE> samples;
+
+	locking.startStopAcquireLocking();
+	auto tick = clock.now();
+	while (clock.now() < end) {
+		tick += std::chrono::milliseconds(locking.getLockingTimeout());
+		clock.sleepUntil(tick);
+		if (!lockStarted && clock.now() >= lockStart) {
+			locking.startStopLocking();
+			lockStarted = true;
+		}
+		QMetaObject::invokeMethod(&locking, "lock", Qt::DirectConnection);
+		waitForLaser(laser);
+
+		if (clock.now() >= nextSample) {
+			SOAK_SAMPLE sample;
+			sample.time = seconds(clock.now() - start);
+			sample.values[static_cast<int>(SOAK_METRIC::MEMORY)] = getResidentMemory();
+			sample.values[static_cast<int>(SOAK_METRIC::ALLOCATIONS)] = (double)allocationCounter::live();
+			double points{ 0 };
+			for (auto series : plots) {
+				points += series->count();
+			}
+			sample.values[static_cast<int>(SOAK_METRIC::POINTS)] = points;
+			sample.values[static_cast<int>(SOAK_METRIC::LASERQUEUE)] = (double)(laser.getQueueLength() + laser.getPendingCallbacks());
+			sample.values[static_cast<int>(SOAK_METRIC::BACKLOG)] = (double)acquisition.getStreamingBacklog();
+			sample.values[static_cast<int>(SOAK_METRIC::UPDATETIME)] = intervalTicks ? intervalTickTime / intervalTicks : 0;
+			samples.push_back(sample);
+			intervalTicks = 0;
+			intervalTickTime = 0;
+			nextSample += sampleInterval;
+		}
+	}
+	locking.startStopAcquireLocking();
+	waitForLaser(laser);
+	result.simulated = seconds(clock.now() - start);
+
+	// the connections refer to the series and the counters of this function, which are not needed anymore
+	QObject::disconnect(&locking, &Locking::locked, nullptr, nullptr);
+	QObject::disconnect(&locking, &Locking::timingStatisticsChanged, nullptr, nullptr);
+	qDeleteAll(plots);
+
+	if (settings.samplesFile.size()) {
+		QFile file(settings.samplesFile);
+		if (file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+			QTextStream stream(&file);
+			stream << "time";
+			for (const auto &limit : soakLimits) {
+				stream << "," << limit.name;
+			}
+			stream << "\n";
+			for (const auto &sample : samples) {
+				stream << sample.time;
+				for (auto value : sample.values) {
+					stream << "," << value;
+				}
+				stream << "\n";
+			}
+		} else {
+			printf("Could not write the samples to %s\n", qPrintable(settings.samplesFile));
+		}
+	}
+
+	// compare the mean of the first and the last third of the samples after the warm-up
+	std::vector<SOAK_SAMPLE> settled;
+	std::copy_if(samples.begin(), samples.end(), std::back_inserter(settled), [&settings](const SOAK_SAMPLE &sample) {
+		return sample.time >= settings.warmup;
+	});
+	printf("Soak\n");
+	if (settled.size() < 3) {
+		printf("  too few samples after the warm-up, increase the duration\n");
+		return 1;
+	}
+	auto third = settled.size() / 3;
+	bool failed{ false };
+	printf("  %-23s %12s %12s %12s\n", "metric", "first third", "last third", "state");
+	for (gsl::index metric{ 0 }; metric < static_cast<int>(SOAK_METRIC::COUNT); metric++) {
+		double first{ 0 };
+		double last{ 0 };
+		for (gsl::index i{ 0 }; i < (gsl::index)third; i++) {
+			first += settled[i].values[metric] / third;
+			last += settled[settled.size() - third + i].values[metric] / third;
+		}
+		const auto &limit = soakLimits[metric];
+		bool grows = (last - first) > limit.tolerance * std::abs(first) + limit.slack;
+		failed = failed || grows;
+		printf("  %-18s %-4s %12.3f %12.3f %12s\n", limit.name, limit.unit, first, last, grows ? "grows" : "bounded");
+	}
+	return failed ? 1 : 0;
+}
+
+int main(int argc, char *argv[]) {
+	QCoreApplication application(argc, argv);
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Runs the lock or a scan against a digital twin of the laser under virtual time.");
+	parser.addHelpOption();
+	parser.addOptions({
+		{ "mode", "lock, scan or soak (default lock)", "mode", "lock" },
+		{ "duration", "simulated duration of the lock in s (default 14400, 86400 for the soak test)", "s" },
+		{ "settle", "acquisition time before the lock is started in s (default 10)", "s", "10" },
+		{ "lock-threshold", "absolute error below which the laser counts as locked (default 0.02)", "error", "0.02" },
+		{ "lock-hold", "time the error has to stay below the threshold in s (default 10)", "s", "10" },
+		{ "p", "proportional parameter of the lock", "value" },
+		{ "i", "integral parameter of the lock", "value" },
+		{ "d", "derivative parameter of the lock", "value" },
+		{ "setpoint", "transmission setpoint of the lock", "value" },
+		{ "actuator", "temperature, analog or dual (default temperature)", "actuator", "temperature" },
+		{ "adaptive", "adapt the locking timeout to the error signal" },
+		{ "pipelined", "start the next capture before the current block is processed" },
+		{ "timebase", "host or sampleclock (default host)", "timebase", "host" },
+		{ "low", "start of the scan in K", "K" },
+		{ "high", "end of the scan in K", "K" },
+		{ "steps", "number of steps of the scan", "steps" },
+		{ "interval", "interval between two steps of the scan in s", "s" },
+		{ "seed", "seed of the twin and the DAQ (default 1)", "seed", "1" },
+		{ "time-constant", "thermal time constant of the laser in s (default 20)", "s", "20" },
+		{ "dead-time", "dead time of the laser temperature in s (default 1)", "s", "1" },
+		{ "line-center", "temperature offset of the line in K (default 1)", "K", "1" },
+		{ "drift", "drift of the line in K/s (default 1e-5)", "K/s", "1e-5" },
+		{ "wander", "random walk of the line in K/s^0.5 (default 1e-4)", "K/s^0.5", "1e-4" },
+		{ "storage", "duration of the lock history in the soak test in s (default 3600)", "s", "3600" },
+		{ "warmup", "time until the metrics of the soak test have to level off in s (default twice the storage)", "s" },
+		{ "sample-interval", "interval between two samples of the soak test in s (default 60)", "s", "60" },
+		{ "samples", "write the samples of the soak test as CSV to the file", "file" },
+	});
+	parser.process(application);
+
+	SIMULATION_SETTINGS settings;
+	settings.mode = parser.value("mode");
+	if (parser.isSet("duration")) {
+		settings.duration = parser.value("duration").toDouble();
+	} else if (settings.mode == "soak") {
+		settings.duration = 24 * 3600;
+	}
+	settings.settle = parser.value("settle").toDouble();
+	settings.lockThreshold = parser.value("lock-threshold").toDouble();
+	settings.lockHold = parser.value("lock-hold").toDouble();
+	settings.storage = parser.value("storage").toDouble();
+	if (!(settings.storage >= 1)) {
+		qCritical("The storage has to be at least 1 s.");
+		return 1;
+	}
+	settings.warmup = parser.isSet("warmup") ? parser.value("warmup").toDouble() : 2 * settings.storage;
+	settings.sampleInterval = parser.value("sample-interval").toDouble();
+	settings.samplesFile = parser.value("samples");
+
+	LASER_TWIN_SETTINGS twinSettings;
+	twinSettings.seed = parser.value("seed").toUInt();
+	twinSettings.timeConstant = parser.value("time-constant").toDouble();
+	twinSettings.deadTime = parser.value("dead-time").toDouble();
+	twinSettings.lineCenter = parser.value("line-center").toDouble();
+	twinSettings.drift = parser.value("drift").toDouble();
+	twinSettings.wander = parser.value("wander").toDouble();
+
+	// everything from here on runs in virtual time
+	VirtualClock clock;
+	Clock::set(&clock);
+	LaserTwin twin(twinSettings, clock.now());
+
+	// the laser lives on its own thread like in LQTControl, the status polling would run in real time
+	LQT laser;
+	laser.setTransport(new TwinTransport(&twin, EMULATOR_SETTINGS{}));
+	laser.setStatusPollingInterval(0);
+	Thread serialThread{ THREAD_ROLE::SERIAL };
+	serialThread.startWorker(&laser);
+	QMetaObject::invokeMethod(&laser, "connect", Qt::BlockingQueuedConnection);
+
+	daq_Synthetic acquisition(nullptr);
+	SYNTHETIC_SETTINGS acquisitionSettings = acquisition.getSyntheticSettings();
+	acquisitionSettings.seed = twinSettings.seed;
+	acquisitionSettings.linewidth *= twinSettings.tuning;
+	acquisition.setSyntheticSettings(acquisitionSettings);
+	acquisition.setDetuningModel([&twin](Clock::time_point time) {
+		return twin.getDetuning(time);
+	});
+	acquisition.init();
+	acquisition.connect();
+	daq *dataAcquisition = &acquisition;
+
+	Locking locking(nullptr, &dataAcquisition, &laser);
+	locking.init();
+	if (parser.isSet("p")) {
+		locking.setLockParameters(LOCKPARAMETERS::P, parser.value("p").toDouble());
+	}
+	if (parser.isSet("i")) {
+		locking.setLockParameters(LOCKPARAMETERS::I, parser.value("i").toDouble());
+	}
+	if (parser.isSet("d")) {
+		locking.setLockParameters(LOCKPARAMETERS::D, parser.value("d").toDouble());
+	}
+	if (parser.isSet("setpoint")) {
+		locking.setLockParameters(LOCKPARAMETERS::SETPOINT, parser.value("setpoint").toDouble());
+	}
+	QString actuator = parser.value("actuator");
+	locking.setLockParameters(LOCKPARAMETERS::ACTUATOR, (actuator == "analog") ? LOCKACTUATOR::ANALOG
+		: ((actuator == "dual") ? LOCKACTUATOR::DUAL : LOCKACTUATOR::TEMPERATURE));
+	locking.setLockParameters(LOCKPARAMETERS::ADAPTIVE, parser.isSet("adaptive"));
+	locking.setLockParameters(LOCKPARAMETERS::PIPELINED, parser.isSet("pipelined"));
+	locking.setLockParameters(LOCKPARAMETERS::TIMEBASE, (parser.value("timebase") == "sampleclock") ? LOCKTIMEBASE::SAMPLECLOCK : LOCKTIMEBASE::HOSTTIMER);
+	if (parser.isSet("low")) {
+		locking.setScanParameters(SCANPARAMETERS::LOW, parser.value("low").toDouble());
+	}
+	if (parser.isSet("high")) {
+		locking.setScanParameters(SCANPARAMETERS::HIGH, parser.value("high").toDouble());
+	}
+	if (parser.isSet("steps")) {
+		locking.setScanParameters(SCANPARAMETERS::STEPS, parser.value("steps").toInt());
+	}
+	if (parser.isSet("interval")) {
+		locking.setScanParameters(SCANPARAMETERS::INTERVAL, parser.value("interval").toInt());
+	}
+
+	SIMULATION_RESULT result;
+	auto wallStart = std::chrono::steady_clock::now();
+	auto cpuStart = std::clock();
+	int status{ 0 };
+	if (settings.mode == "scan") {
+		status = simulateScan(clock, laser, locking, twin, result);
+	} else if (settings.mode == "soak") {
+		status = simulateSoak(settings, clock, laser, acquisition, locking, result);
+	} else {
+		status = simulateLock(settings, clock, laser, locking, twin, result);
+	}
+	result.wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+	result.cpu = (double)(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+	result.peakMemory = getPeakMemory();
+	printResources(result);
+
+	acquisition.disconnect();
+	QMetaObject::invokeMethod(&laser, "disconnect", Qt::BlockingQueuedConnection);
+	serialThread.quit();
+	serialThread.wait();
+	Clock::set(nullptr);
+	return status;
+}
\ No newline at end of file
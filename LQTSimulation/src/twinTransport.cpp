@@ -0,0 +1,65 @@
+#include "twinTransport.h"
+#include "clock.h"
+#include <cstring>
+
+TwinTransport::TwinTransport(LaserTwin *twin, EMULATOR_SETTINGS settings) noexcept :
+	m_twin(twin), m_emulator(settings) {}
+
+bool TwinTransport::open(const std::string &port, int baudRate) {
+	return true;
+}
+
+void TwinTransport::close() {}
+
+void TwinTransport::clear() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_input.clear();
+	m_output.clear();
+}
+
+qint64 TwinTransport::write(const char *data) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_input += data;
+
+	// every command is terminated by \r, a \n is tolerated as well
+	size_t end;
+	while ((end = m_input.find_first_of("\r\n")) != std::string::npos) {
+		std::string command = m_input.substr(0, end);
+		m_input.erase(0, end + 1);
+		if (command.size() == 0) {
+			continue;
+		}
+		double temperature = m_emulator.getState().temperature;
+		std::string reply;
+		if (!m_emulator.handle(command, reply)) {
+			continue;
+		}
+		if (m_emulator.getState().temperature != temperature) {
+			m_twin->setSetpoint(m_emulator.getState().temperature, Clock::get()->now());
+		}
+		m_output.append(QByteArray::fromStdString(reply + "\r\n"));
+	}
+	return (qint64)strlen(data);
+}
+
+bool TwinTransport::waitForBytesWritten(int timeout) {
+	return true;
+}
+
+// The replies are there immediately, there is nothing to wait for.
+bool TwinTransport::waitForReadyRead(int timeout) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_output.size() > 0;
+}
+
+QByteArray TwinTransport::readAll() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	QByteArray output = m_output;
+	m_output.clear();
+	return output;
+}
+
+EMULATOR_STATE TwinTransport::getState() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_emulator.getState();
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#ifndef TWINTRANSPORT_H
+#define TWINTRANSPORT_H
+
+#include "Devices/serialTransport.h"
+#include "lqtEmulator.h"
+#include "laserTwin.h"
+#include <mutex>
+#include <string>
+
+/*
+ * Connects LQT to the laser twin. The commands are answered by the emulation of the laser protocol
+ * without delay, every temperature setpoint the laser accepts is passed on to the twin
+ * at the time of the clock.
+ */
+class TwinTransport : public SerialTransport {
+
+public:
+	TwinTransport(LaserTwin *twin, EMULATOR_SETTINGS settings) noexcept;
+
+	bool open(const std::string &port, int baudRate) override;
+	void close() override;
+
+	void clear() override;
+	qint64 write(const char *data) override;
+	bool waitForBytesWritten(int timeout) override;
+	bool waitForReadyRead(int timeout) override;
+	QByteArray readAll() override;
+
+	EMULATOR_STATE getState();
+
+private:
+	LaserTwin *m_twin;
+	std::mutex m_mutex;
+	LQTEmulator m_emulator;
+	std::string m_input{ "" };		// received bytes of the incomplete command
+	QByteArray m_output;			// replies not yet read
+};
+
+#endif // TWINTRANSPORT_H
\ No newline at end of file
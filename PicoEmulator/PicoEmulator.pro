@@ -0,0 +1,9 @@
+# ----------------------------------------------------
+# Emulation of the PicoScope ps2000 and ps2000a drivers.
+# Builds libps2000 and libps2000a, which stand in for
+# the libraries of the PicoSDK.
+# ----------------------------------------------------
+
+TEMPLATE = subdirs
+SUBDIRS += ps2000.pro \
+    ps2000a.pro
\ No newline at end of file
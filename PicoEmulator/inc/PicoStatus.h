@@ -0,0 +1,39 @@
+#ifndef PICOSTATUS_H
+#define PICOSTATUS_H
+
+/*
+ * The status codes and unit information lines of the PicoSDK used by the emulation.
+ */
+
+#include <stdint.h>
+
+typedef uint32_t PICO_INFO;
+
+#define PICO_DRIVER_VERSION		0x00000000UL
+#define PICO_USB_VERSION		0x00000001UL
+#define PICO_HARDWARE_VERSION	0x00000002UL
+#define PICO_VARIANT_INFO		0x00000003UL
+#define PICO_BATCH_AND_SERIAL	0x00000004UL
+#define PICO_CAL_DATE			0x00000005UL
+#define PICO_KERNEL_VERSION		0x00000006UL
+
+typedef uint32_t PICO_STATUS;
+
+#define PICO_OK							0x00000000UL
+#define PICO_MAX_UNITS_OPENED			0x00000001UL
+#define PICO_MEMORY_FAIL				0x00000002UL
+#define PICO_NOT_FOUND					0x00000003UL
+#define PICO_INVALID_HANDLE				0x0000000CUL
+#define PICO_INVALID_PARAMETER			0x0000000DUL
+#define PICO_INVALID_TIMEBASE			0x0000000EUL
+#define PICO_INVALID_VOLTAGE_RANGE		0x0000000FUL
+#define PICO_INVALID_CHANNEL			0x00000010UL
+#define PICO_STREAMING_FAILED			0x00000014UL
+#define PICO_NULL_PARAMETER				0x00000016UL
+#define PICO_DATA_NOT_AVAILABLE			0x00000017UL
+#define PICO_STRING_BUFFER_TO_SMALL		0x00000018UL
+#define PICO_TOO_MANY_SAMPLES			0x0000001CUL
+#define PICO_NO_SAMPLES_AVAILABLE		0x00000024UL
+#define PICO_BUSY						0x00000026UL
+
+#endif // PICOSTATUS_H
\ No newline at end of file
@@ -0,0 +1,32 @@
+#ifndef PICOSHIMS_H
+#define PICOSHIMS_H
+
+/*
+ * The parts of the Windows API the PicoScope backends use besides the driver.
+ * On Windows they come from windows.h, elsewhere they are emulated here.
+ */
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <chrono>
+#include <thread>
+// windows.h brings the C string functions along
+#include <string.h>
+
+#ifndef __stdcall
+#define __stdcall
+#endif
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+inline void Sleep(unsigned long milliseconds) {
+	std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+}
+#endif
+
+#endif // PICOSHIMS_H
\ No newline at end of file
@@ -0,0 +1,145 @@
+#ifndef PS2000_H
+#define PS2000_H
+
+/*
+ * Emulation of the subset of the PicoScope 2000 driver API used by LQTControl.
+ * The declarations follow ps2000.h of the PicoSDK, so the backends build unmodified against either.
+ */
+
+#include <stdint.h>
+#include "picoShims.h"
+
+#define PS2000_FIRST_USB	1
+#define PS2000_LAST_USB		127
+
+#define PS2000_MAX_UNITS	(PS2000_LAST_USB - PS2000_FIRST_USB + 1)
+
+#define PS2000_MAX_TIMEBASE		19
+#define PS2105_MAX_TIMEBASE		20
+#define PS2104_MAX_TIMEBASE		19
+#define PS2200_MAX_TIMEBASE		23
+
+#define PS2000_MAX_OVERSAMPLE	256
+
+#define PS2000_MAX_VALUE	32767
+#define PS2000_MIN_VALUE	-32767
+#define PS2000_LOST_DATA	-32768
+
+typedef enum enPS2000Channel {
+	PS2000_CHANNEL_A,
+	PS2000_CHANNEL_B,
+	PS2000_CHANNEL_C,
+	PS2000_CHANNEL_D,
+	PS2000_EXTERNAL,
+	PS2000_MAX_CHANNELS = PS2000_EXTERNAL,
+	PS2000_NONE,
+} PS2000_CHANNEL;
+
+typedef enum enPS2000Range {
+	PS2000_10MV,
+	PS2000_20MV,
+	PS2000_50MV,
+	PS2000_100MV,
+	PS2000_200MV,
+	PS2000_500MV,
+	PS2000_1V,
+	PS2000_2V,
+	PS2000_5V,
+	PS2000_10V,
+	PS2000_20V,
+	PS2000_50V,
+	PS2000_MAX_RANGES
+} PS2000_RANGE;
+
+typedef enum enPS2000TimeUnits {
+	PS2000_FS,
+	PS2000_PS,
+	PS2000_NS,
+	PS2000_US,
+	PS2000_MS,
+	PS2000_S,
+	PS2000_MAX_TIME_UNITS,
+} PS2000_TIME_UNITS;
+
+typedef enum enPS2000Info {
+	PS2000_DRIVER_VERSION,
+	PS2000_USB_VERSION,
+	PS2000_HARDWARE_VERSION,
+	PS2000_VARIANT_INFO,
+	PS2000_BATCH_AND_SERIAL,
+	PS2000_CAL_DATE,
+	PS2000_ERROR_CODE,
+	PS2000_KERNEL_DRIVER_VERSION,
+	PS2000_DRIVER_PATH
+} PS2000_INFO;
+
+typedef enum enPS2000TriggerDirection {
+	PS2000_RISING,
+	PS2000_FALLING,
+	PS2000_MAX_DIRS
+} PS2000_TDIR;
+
+typedef enum enPS2000EtsMode {
+	PS2000_ETS_OFF,
+	PS2000_ETS_FAST,
+	PS2000_ETS_SLOW,
+	PS2000_ETS_MODES_MAX
+} PS2000_ETS_MODE;
+
+typedef enum enPS2000SweepType {
+	PS2000_UP,
+	PS2000_DOWN,
+	PS2000_UPDOWN,
+	PS2000_DOWNUP,
+	MAX_SWEEP_TYPES
+} PS2000_SWEEP_TYPE;
+
+typedef enum enPS2000WaveType {
+	PS2000_SINE,
+	PS2000_SQUARE,
+	PS2000_TRIANGLE,
+	PS2000_RAMPUP,
+	PS2000_RAMPDOWN,
+	PS2000_DC_VOLTAGE,
+	PS2000_GAUSSIAN,
+	PS2000_SINC,
+	PS2000_HALF_SINE,
+} PS2000_WAVE_TYPE;
+
+typedef void (__stdcall *GetOverviewBuffersMaxMin)(
+	int16_t **overviewBuffers,
+	int16_t overflow,
+	uint32_t triggeredAt,
+	int16_t triggered,
+	int16_t auto_stop,
+	uint32_t nValues
+);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int16_t ps2000_open_unit(void);
+int16_t ps2000_get_unit_info(int16_t handle, int8_t *string, int16_t string_length, int16_t line);
+int16_t ps2000_close_unit(int16_t handle);
+
+int16_t ps2000_set_channel(int16_t handle, int16_t channel, int16_t enabled, int16_t dc, int16_t range);
+int16_t ps2000_set_trigger(int16_t handle, int16_t source, int16_t threshold, int16_t direction, int16_t delay, int16_t auto_trigger_ms);
+int32_t ps2000_set_ets(int16_t handle, int16_t mode, int16_t ets_cycles, int16_t ets_interleave);
+int16_t ps2000_get_timebase(int16_t handle, int16_t timebase, int32_t no_of_samples, int32_t *time_interval, int16_t *time_units, int16_t oversample, int32_t *max_samples);
+
+int16_t ps2000_run_block(int16_t handle, int32_t no_of_values, int16_t timebase, int16_t oversample, int32_t *time_indisposed_ms);
+int16_t ps2000_ready(int16_t handle);
+int16_t ps2000_stop(int16_t handle);
+int32_t ps2000_get_times_and_values(int16_t handle, int32_t *times, int16_t *buffer_a, int16_t *buffer_b, int16_t *buffer_c, int16_t *buffer_d, int16_t *overflow, int16_t time_units, int32_t no_of_values);
+
+int16_t ps2000_run_streaming_ns(int16_t handle, uint32_t sample_interval, PS2000_TIME_UNITS time_units, uint32_t max_samples, int16_t auto_stop, uint32_t noOfSamplesPerAggregate, uint32_t overview_buffer_size);
+int16_t ps2000_get_streaming_last_values(int16_t handle, GetOverviewBuffersMaxMin lpGetOverviewBuffersMaxMin);
+
+int16_t ps2000_set_sig_gen_built_in(int16_t handle, int32_t offsetVoltage, uint32_t pkToPk, PS2000_WAVE_TYPE waveType, float startFrequency, float stopFrequency, float increment, float dwellTime, PS2000_SWEEP_TYPE sweepType, uint32_t sweeps);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PS2000_H
\ No newline at end of file
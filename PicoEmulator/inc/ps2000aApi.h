@@ -0,0 +1,188 @@
+#ifndef PS2000AAPI_H
+#define PS2000AAPI_H
+
+/*
+ * Emulation of the subset of the PicoScope 2000A driver API used by LQTControl.
+ * The declarations follow ps2000aApi.h of the PicoSDK, so the backends build unmodified against either.
+ */
+
+#include <stdint.h>
+#include "picoShims.h"
+#include "PicoStatus.h"
+
+#define PS2000A_MAX_OVERSAMPLE	256
+
+#define PS2000A_MAX_VALUE	32512
+#define PS2000A_MIN_VALUE	-32512
+#define PS2000A_LOST_DATA	-32768
+
+typedef enum enPS2000AChannelBufferIndex {
+	PS2000A_CHANNEL_A_MAX,
+	PS2000A_CHANNEL_A_MIN,
+	PS2000A_CHANNEL_B_MAX,
+	PS2000A_CHANNEL_B_MIN,
+	PS2000A_CHANNEL_C_MAX,
+	PS2000A_CHANNEL_C_MIN,
+	PS2000A_CHANNEL_D_MAX,
+	PS2000A_CHANNEL_D_MIN,
+	PS2000A_MAX_CHANNEL_BUFFERS
+} PS2000A_CHANNEL_BUFFER_INDEX;
+
+typedef enum enPS2000AChannel {
+	PS2000A_CHANNEL_A,
+	PS2000A_CHANNEL_B,
+	PS2000A_CHANNEL_C,
+	PS2000A_CHANNEL_D,
+	PS2000A_EXTERNAL,
+	PS2000A_MAX_CHANNELS = PS2000A_EXTERNAL,
+	PS2000A_TRIGGER_AUX,
+	PS2000A_MAX_TRIGGER_SOURCES
+} PS2000A_CHANNEL;
+
+typedef enum enPS2000ACoupling {
+	PS2000A_AC,
+	PS2000A_DC
+} PS2000A_COUPLING;
+
+typedef enum enPS2000ARange {
+	PS2000A_10MV,
+	PS2000A_20MV,
+	PS2000A_50MV,
+	PS2000A_100MV,
+	PS2000A_200MV,
+	PS2000A_500MV,
+	PS2000A_1V,
+	PS2000A_2V,
+	PS2000A_5V,
+	PS2000A_10V,
+	PS2000A_20V,
+	PS2000A_50V,
+	PS2000A_MAX_RANGES
+} PS2000A_RANGE;
+
+typedef enum enPS2000AEtsMode {
+	PS2000A_ETS_OFF,
+	PS2000A_ETS_FAST,
+	PS2000A_ETS_SLOW,
+	PS2000A_ETS_MODES_MAX
+} PS2000A_ETS_MODE;
+
+typedef enum enPS2000ATimeUnits {
+	PS2000A_FS,
+	PS2000A_PS,
+	PS2000A_NS,
+	PS2000A_US,
+	PS2000A_MS,
+	PS2000A_S,
+	PS2000A_MAX_TIME_UNITS,
+} PS2000A_TIME_UNITS;
+
+typedef enum enPS2000ASweepType {
+	PS2000A_UP,
+	PS2000A_DOWN,
+	PS2000A_UPDOWN,
+	PS2000A_DOWNUP,
+	PS2000A_MAX_SWEEP_TYPES
+} PS2000A_SWEEP_TYPE;
+
+typedef enum enPS2000AWaveType {
+	PS2000A_SINE,
+	PS2000A_SQUARE,
+	PS2000A_TRIANGLE,
+	PS2000A_RAMP_UP,
+	PS2000A_RAMP_DOWN,
+	PS2000A_SINC,
+	PS2000A_GAUSSIAN,
+	PS2000A_HALF_SINE,
+	PS2000A_DC_VOLTAGE,
+	PS2000A_MAX_WAVE_TYPES
+} PS2000A_WAVE_TYPE;
+
+typedef enum enPS2000AExtraOperations {
+	PS2000A_ES_OFF,
+	PS2000A_WHITENOISE,
+	PS2000A_PRBS
+} PS2000A_EXTRA_OPERATIONS;
+
+typedef enum enPS2000ASigGenTrigType {
+	PS2000A_SIGGEN_RISING,
+	PS2000A_SIGGEN_FALLING,
+	PS2000A_SIGGEN_GATE_HIGH,
+	PS2000A_SIGGEN_GATE_LOW
+} PS2000A_SIGGEN_TRIG_TYPE;
+
+typedef enum enPS2000ASigGenTrigSource {
+	PS2000A_SIGGEN_NONE,
+	PS2000A_SIGGEN_SCOPE_TRIG,
+	PS2000A_SIGGEN_AUX_IN,
+	PS2000A_SIGGEN_EXT_IN,
+	PS2000A_SIGGEN_SOFT_TRIG
+} PS2000A_SIGGEN_TRIG_SOURCE;
+
+typedef enum enPS2000AThresholdDirection {
+	PS2000A_ABOVE,
+	PS2000A_INSIDE = PS2000A_ABOVE,
+	PS2000A_BELOW,
+	PS2000A_OUTSIDE = PS2000A_BELOW,
+	PS2000A_RISING,
+	PS2000A_ENTER = PS2000A_RISING,
+	PS2000A_NONE = PS2000A_RISING,
+	PS2000A_FALLING,
+	PS2000A_EXIT = PS2000A_FALLING,
+	PS2000A_RISING_OR_FALLING,
+	PS2000A_ENTER_OR_EXIT = PS2000A_RISING_OR_FALLING
+} PS2000A_THRESHOLD_DIRECTION;
+
+typedef enum enPS2000ARatioMode {
+	PS2000A_RATIO_MODE_NONE,
+	PS2000A_RATIO_MODE_AGGREGATE = 1,
+	PS2000A_RATIO_MODE_DECIMATE = 2,
+	PS2000A_RATIO_MODE_AVERAGE = 4
+} PS2000A_RATIO_MODE;
+
+typedef void (__stdcall *ps2000aBlockReady)(
+	int16_t handle,
+	PICO_STATUS status,
+	void *pParameter
+);
+
+typedef void (__stdcall *ps2000aStreamingReady)(
+	int16_t handle,
+	int32_t noOfSamples,
+	uint32_t startIndex,
+	int16_t overflow,
+	uint32_t triggerAt,
+	int16_t triggered,
+	int16_t autoStop,
+	void *pParameter
+);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+PICO_STATUS ps2000aOpenUnit(int16_t *handle, int8_t *serial);
+PICO_STATUS ps2000aGetUnitInfo(int16_t handle, int8_t *string, int16_t stringLength, int16_t *requiredSize, PICO_INFO info);
+PICO_STATUS ps2000aCloseUnit(int16_t handle);
+
+PICO_STATUS ps2000aSetChannel(int16_t handle, PS2000A_CHANNEL channel, int16_t enabled, PS2000A_COUPLING type, PS2000A_RANGE range, float analogOffset);
+PICO_STATUS ps2000aSetSimpleTrigger(int16_t handle, int16_t enable, PS2000A_CHANNEL source, int16_t threshold, PS2000A_THRESHOLD_DIRECTION direction, uint32_t delay, int16_t autoTrigger_ms);
+PICO_STATUS ps2000aSetEts(int16_t handle, PS2000A_ETS_MODE mode, int16_t etsCycles, int16_t etsInterleave, int32_t *sampleTimePicoseconds);
+PICO_STATUS ps2000aGetTimebase(int16_t handle, uint32_t timebase, int32_t noSamples, int32_t *timeIntervalNanoseconds, int16_t oversample, int32_t *totalSamples, uint32_t segmentIndex);
+
+PICO_STATUS ps2000aRunBlock(int16_t handle, int32_t noOfPreTriggerSamples, int32_t noOfPostTriggerSamples, uint32_t timebase, int16_t oversample, int32_t *timeIndisposedMs, uint32_t segmentIndex, ps2000aBlockReady lpReady, void *pParameter);
+PICO_STATUS ps2000aIsReady(int16_t handle, int16_t *ready);
+PICO_STATUS ps2000aStop(int16_t handle);
+PICO_STATUS ps2000aSetDataBuffers(int16_t handle, int32_t channelOrPort, int16_t *bufferMax, int16_t *bufferMin, int32_t bufferLth, uint32_t segmentIndex, PS2000A_RATIO_MODE mode);
+PICO_STATUS ps2000aGetValues(int16_t handle, uint32_t startIndex, uint32_t *noOfSamples, uint32_t downSampleRatio, PS2000A_RATIO_MODE downSampleRatioMode, uint32_t segmentIndex, int16_t *overflow);
+
+PICO_STATUS ps2000aRunStreaming(int16_t handle, uint32_t *sampleInterval, PS2000A_TIME_UNITS sampleIntervalTimeUnits, uint32_t maxPreTriggerSamples, uint32_t maxPostPreTriggerSamples, int16_t autoStop, uint32_t downSampleRatio, PS2000A_RATIO_MODE downSampleRatioMode, uint32_t overviewBufferSize);
+PICO_STATUS ps2000aGetStreamingLatestValues(int16_t handle, ps2000aStreamingReady lpPs2000aReady, void *pParameter);
+
+PICO_STATUS ps2000aSetSigGenBuiltIn(int16_t handle, int32_t offsetVoltage, uint32_t pkToPk, PS2000A_WAVE_TYPE waveType, float startFrequency, float stopFrequency, float increment, float dwellTime, PS2000A_SWEEP_TYPE sweepType, PS2000A_EXTRA_OPERATIONS operationType, uint32_t shots, uint32_t sweeps, PS2000A_SIGGEN_TRIG_TYPE triggerType, PS2000A_SIGGEN_TRIG_SOURCE triggerSource, int16_t extInThreshold);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PS2000AAPI_H
\ No newline at end of file
@@ -0,0 +1,16 @@
+# ----------------------------------------------------
+# Emulation of the PicoScope ps2000 driver.
+# ----------------------------------------------------
+
+TEMPLATE = lib
+TARGET = ps2000
+CONFIG += c++14
+CONFIG -= qt
+LIBS += -lpthread
+INCLUDEPATH += ./inc
+HEADERS += ./inc/ps2000.h \
+    ./inc/PicoStatus.h \
+    ./inc/picoShims.h \
+    ./src/picoDevice.h
+SOURCES += ./src/ps2000.cpp \
+    ./src/picoDevice.cpp
\ No newline at end of file
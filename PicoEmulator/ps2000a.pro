@@ -0,0 +1,16 @@
+# ----------------------------------------------------
+# Emulation of the PicoScope ps2000a driver.
+# ----------------------------------------------------
+
+TEMPLATE = lib
+TARGET = ps2000a
+CONFIG += c++14
+CONFIG -= qt
+LIBS += -lpthread
+INCLUDEPATH += ./inc
+HEADERS += ./inc/ps2000aApi.h \
+    ./inc/PicoStatus.h \
+    ./inc/picoShims.h \
+    ./src/picoDevice.h
+SOURCES += ./src/ps2000a.cpp \
+    ./src/picoDevice.cpp
\ No newline at end of file
@@ -0,0 +1,227 @@
+#include "picoDevice.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+
+namespace {
+	// [mV]	input ranges, indexed like PS2000_RANGE and PS2000A_RANGE
+	const int32_t inputRanges[] = { 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000 };
+
+	double environmentValue(const char *name, double value) {
+		const char *string = getenv(name);
+		if (!string) {
+			return value;
+		}
+		char *end{ nullptr };
+		double parsed = strtod(string, &end);
+		return (end == string) ? value : parsed;
+	}
+}
+
+PicoDevice::PicoDevice(PICO_EMULATOR_MODEL model, PICO_EMULATOR_SETTINGS settings) noexcept :
+	m_model(model), m_settings(settings), m_generator(settings.seed) {
+	for (int channel{ 0 }; channel < PICO_EMULATOR_CHANNELS; channel++) {
+		m_enabled[channel] = (channel < m_model.channels) && m_enabled[channel];
+	}
+}
+
+PICO_EMULATOR_SETTINGS PicoDevice::getSettingsFromEnvironment() {
+	PICO_EMULATOR_SETTINGS settings;
+	settings.seed = (unsigned int)environmentValue("PICOEMULATOR_SEED", settings.seed);
+	settings.latencyScale = environmentValue("PICOEMULATOR_LATENCY_SCALE", settings.latencyScale);
+	settings.noise = environmentValue("PICOEMULATOR_NOISE", settings.noise);
+	settings.transferRate = environmentValue("PICOEMULATOR_TRANSFER_RATE", settings.transferRate);
+	return settings;
+}
+
+PICO_EMULATOR_MODEL PicoDevice::getModel() {
+	return m_model;
+}
+
+void PicoDevice::wait(double latency) {
+	double scaled = latency * m_settings.latencyScale;
+	if (scaled > 0) {
+		std::this_thread::sleep_for(std::chrono::microseconds((long long)(1e3 * scaled)));
+	}
+}
+
+void PicoDevice::command() {
+	wait(m_settings.callLatency);
+}
+
+void PicoDevice::configure() {
+	wait(m_settings.callLatency + m_settings.configurationTime);
+}
+
+bool PicoDevice::setChannel(int16_t channel, bool enabled, bool /*dc*/, int16_t range) {
+	configure();
+	if (channel < 0 || channel >= m_model.channels) {
+		return false;
+	}
+	if (enabled && (range < m_model.firstRange || range > m_model.lastRange)) {
+		return false;
+	}
+	m_enabled[channel] = enabled;
+	m_range[channel] = range;
+	return true;
+}
+
+void PicoDevice::setOutputVoltage(double voltage) {
+	configure();
+	m_outputVoltage = voltage;
+}
+
+int16_t PicoDevice::enabledChannels() {
+	int16_t count{ 0 };
+	for (int channel{ 0 }; channel < m_model.channels; channel++) {
+		count += m_enabled[channel];
+	}
+	return count;
+}
+
+// The sample memory is shared by the enabled channels
+uint32_t PicoDevice::maxSamples() {
+	auto channels = enabledChannels();
+	return (channels > 0) ? m_model.memory / channels : m_model.memory;
+}
+
+void PicoDevice::runBlock(uint32_t nrSamples, double interval) {
+	command();
+	m_streaming = false;
+	m_blockRunning = true;
+	m_blockValid = true;
+	m_blockCaptured = false;
+	m_blockSamples = nrSamples;
+	m_blockInterval = interval;
+	// the capture takes the full time even without latencies, as a real acquisition would
+	m_blockReady = clock::now() + std::chrono::nanoseconds((long long)(nrSamples * interval));
+}
+
+std::chrono::steady_clock::time_point PicoDevice::getBlockReadyTime() {
+	return m_blockReady;
+}
+
+bool PicoDevice::isReady() {
+	command();
+	return m_blockRunning && (clock::now() >= m_blockReady);
+}
+
+uint32_t PicoDevice::readBlock(std::array<int16_t *, PICO_EMULATOR_CHANNELS> buffers, uint32_t startIndex, uint32_t nrSamples, int16_t &overflow) {
+	command();
+	if (!m_blockValid || clock::now() < m_blockReady || startIndex >= m_blockSamples) {
+		return 0;
+	}
+	captureBlock();
+	nrSamples = (nrSamples < m_blockSamples - startIndex) ? nrSamples : m_blockSamples - startIndex;
+	// the samples of the enabled channels are transferred over USB
+	wait(1e3 * 2.0 * nrSamples * enabledChannels() / m_settings.transferRate);
+	for (int channel{ 0 }; channel < PICO_EMULATOR_CHANNELS; channel++) {
+		if (buffers[channel] && m_enabled[channel]) {
+			std::copy(m_blockData[channel].begin() + startIndex, m_blockData[channel].begin() + startIndex + nrSamples, buffers[channel]);
+		}
+	}
+	overflow = m_blockOverflow;
+	return nrSamples;
+}
+
+uint32_t PicoDevice::getBlockSamples() {
+	return m_blockSamples;
+}
+
+double PicoDevice::getBlockInterval() {
+	return m_blockInterval;
+}
+
+void PicoDevice::runStreaming(double interval, uint32_t bufferSize) {
+	command();
+	m_blockRunning = false;
+	m_blockValid = false;
+	m_streaming = true;
+	m_streamingInterval = interval;
+	m_streamingBufferSize = bufferSize;
+	m_streamingStart = clock::now();
+	m_streamedSamples = 0;
+}
+
+bool PicoDevice::isStreaming() {
+	return m_streaming;
+}
+
+uint32_t PicoDevice::readStreaming(std::array<int16_t *, PICO_EMULATOR_CHANNELS> buffers, uint32_t maxSamples, int16_t &overflow) {
+	command();
+	overflow = 0;
+	if (!m_streaming) {
+		return 0;
+	}
+	auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - m_streamingStart).count();
+	auto acquired = (uint64_t)(elapsed / m_streamingInterval);
+	// the driver only keeps the latest samples, older ones are lost if we poll too rarely
+	if (m_streamingBufferSize > 0 && acquired - m_streamedSamples > m_streamingBufferSize) {
+		m_streamedSamples = acquired - m_streamingBufferSize;
+	}
+	auto available = acquired - m_streamedSamples;
+	auto nrSamples = (uint32_t)((available < maxSamples) ? available : maxSamples);
+	if (nrSamples == 0) {
+		return 0;
+	}
+	wait(1e3 * 2.0 * nrSamples * enabledChannels() / m_settings.transferRate);
+	generate(buffers, nrSamples, overflow);
+	m_streamedSamples += nrSamples;
+	return nrSamples;
+}
+
+// Like the driver, a finished block can still be read after stopping until the next capture.
+// Stopping a block before it finished aborts it.
+void PicoDevice::stop() {
+	command();
+	if (m_blockRunning && clock::now() < m_blockReady) {
+		m_blockValid = false;
+	}
+	m_blockRunning = false;
+	m_streaming = false;
+}
+
+void PicoDevice::captureBlock() {
+	if (m_blockCaptured) {
+		return;
+	}
+	std::array<int16_t *, PICO_EMULATOR_CHANNELS> buffers;
+	for (int channel{ 0 }; channel < PICO_EMULATOR_CHANNELS; channel++) {
+		m_blockData[channel].resize(m_blockSamples);
+		buffers[channel] = m_blockData[channel].data();
+	}
+	generate(buffers, m_blockSamples, m_blockOverflow);
+	m_blockCaptured = true;
+}
+
+void PicoDevice::generate(std::array<int16_t *, PICO_EMULATOR_CHANNELS> buffers, uint32_t nrSamples, int16_t &overflow) {
+	overflow = 0;
+	for (uint32_t i{ 0 }; i < nrSamples; i++) {
+		double detuning = (m_settings.detuning + m_outputVoltage) / m_settings.linewidth;
+		double transmission = 1 - m_settings.absorptionDepth / (1 + detuning * detuning);
+		std::array<double, PICO_EMULATOR_CHANNELS> signals{ {
+			m_settings.absorptionLevel * transmission,
+			m_settings.referenceLevel,
+			0,
+			0
+		} };
+		for (int channel{ 0 }; channel < PICO_EMULATOR_CHANNELS; channel++) {
+			double noise = m_settings.noise * m_noise(m_generator);
+			if (buffers[channel] && m_enabled[channel]) {
+				buffers[channel][i] = toADC(signals[channel] + noise, channel, overflow);
+			}
+		}
+	}
+}
+
+// Converts to ADC counts in the range of the channel and flags samples beyond the range
+int16_t PicoDevice::toADC(double mv, int channel, int16_t &overflow) {
+	double adc = mv * m_model.maxValue / inputRanges[m_range[channel]];
+	if (adc > m_model.maxValue || adc < -m_model.maxValue) {
+		overflow |= (1 << channel);
+		adc = (adc > 0) ? m_model.maxValue : -m_model.maxValue;
+	}
+	return (int16_t)std::round(adc);
+}
\ No newline at end of file
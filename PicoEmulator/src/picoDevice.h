@@ -0,0 +1,113 @@
+#ifndef PICODEVICE_H
+#define PICODEVICE_H
+
+#include <stdint.h>
+#include <array>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#define PICO_EMULATOR_CHANNELS 4
+
+typedef struct PICO_EMULATOR_SETTINGS {
+	unsigned int seed{ 0 };				//		seed of the noise generator
+	double latencyScale{ 1 };			// [1]	factor applied to all latencies, 0 answers every call immediately
+	double openTime{ 1500 };			// [ms]	time to open the unit and load the firmware
+	double callLatency{ 0.25 };			// [ms]	round trip of a command over USB
+	double configurationTime{ 1 };		// [ms]	time to apply channel, trigger or signal generator settings
+	double transferRate{ 20e6 };		// [B/s]	USB transfer rate of the sample data
+	double noise{ 1 };					// [mV]	standard deviation of the noise on all channels
+	double referenceLevel{ 400 };		// [mV]	signal of the reference detector (channel B)
+	double absorptionLevel{ 150 };		// [mV]	signal behind the absorption cell (channel A) far from the line
+	double absorptionDepth{ 0.8 };		// [1]	fraction of the light absorbed on resonance
+	double linewidth{ 0.5 };			// [V]	half width of the line in units of the signal generator offset
+	double detuning{ 0.5 };				// [V]	detuning of the laser from the line at zero offset
+} PICO_EMULATOR_SETTINGS;
+
+typedef struct PICO_EMULATOR_MODEL {
+	const char *variant;				//		variant string reported by the unit information
+	int16_t channels;					//		number of analog channels
+	uint32_t memory;					//		sample memory shared by the enabled channels
+	int16_t firstRange;					//		index of the smallest supported input range
+	int16_t lastRange;					//		index of the largest supported input range
+	int16_t maxValue;					//		ADC count at the full input range
+	bool hasSignalGenerator;
+} PICO_EMULATOR_MODEL;
+
+/*
+ * Models a PicoScope as seen through its driver: the latency of every call, the sample memory,
+ * the capture time of a block and the samples accumulating while streaming.
+ * Channel A carries the signal behind an absorption cell, which the offset of the signal generator
+ * tunes across the line, channel B carries the reference signal.
+ * The samples only depend on the seed, the signal generator offset and the number of samples captured since opening.
+ */
+class PicoDevice {
+
+public:
+	PicoDevice(PICO_EMULATOR_MODEL model, PICO_EMULATOR_SETTINGS settings) noexcept;
+
+	// settings from the PICOEMULATOR_* environment variables
+	static PICO_EMULATOR_SETTINGS getSettingsFromEnvironment();
+
+	PICO_EMULATOR_MODEL getModel();
+
+	// waits the given latency scaled by latencyScale
+	void wait(double latency);
+	void command();
+	void configure();
+
+	bool setChannel(int16_t channel, bool enabled, bool dc, int16_t range);
+	void setOutputVoltage(double voltage);
+	int16_t enabledChannels();
+	uint32_t maxSamples();
+
+	// block mode
+	void runBlock(uint32_t nrSamples, double interval);
+	bool isReady();
+	// copies at most nrSamples of the captured block from startIndex on to the buffers, returns the number of samples copied
+	uint32_t readBlock(std::array<int16_t *, PICO_EMULATOR_CHANNELS> buffers, uint32_t startIndex, uint32_t nrSamples, int16_t &overflow);
+	std::chrono::steady_clock::time_point getBlockReadyTime();
+	uint32_t getBlockSamples();
+	double getBlockInterval();
+
+	// streaming mode
+	void runStreaming(double interval, uint32_t bufferSize);
+	bool isStreaming();
+	// returns the number of samples acquired since the last call, at most maxSamples
+	uint32_t readStreaming(std::array<int16_t *, PICO_EMULATOR_CHANNELS> buffers, uint32_t maxSamples, int16_t &overflow);
+
+	void stop();
+
+private:
+	typedef std::chrono::steady_clock clock;
+
+	void generate(std::array<int16_t *, PICO_EMULATOR_CHANNELS> buffers, uint32_t nrSamples, int16_t &overflow);
+	void captureBlock();
+	int16_t toADC(double mv, int channel, int16_t &overflow);
+
+	PICO_EMULATOR_MODEL m_model;
+	PICO_EMULATOR_SETTINGS m_settings;
+	std::mt19937 m_generator;
+	std::normal_distribution<double> m_noise{ 0.0, 1.0 };
+
+	std::array<bool, PICO_EMULATOR_CHANNELS> m_enabled{ { true, true, false, false } };
+	std::array<int16_t, PICO_EMULATOR_CHANNELS> m_range{ { 8, 8, 8, 8 } };
+	double m_outputVoltage{ 0 };		// [V]	offset of the signal generator
+
+	bool m_blockRunning{ false };
+	bool m_blockValid{ false };			//		whether the memory holds a block, which stays readable after stopping
+	uint32_t m_blockSamples{ 0 };
+	double m_blockInterval{ 0 };		// [ns]	sample interval of the block
+	clock::time_point m_blockReady;		//		time the block capture finishes
+	bool m_blockCaptured{ false };		//		whether the samples of the block were generated
+	std::array<std::vector<int16_t>, PICO_EMULATOR_CHANNELS> m_blockData;
+	int16_t m_blockOverflow{ 0 };
+
+	bool m_streaming{ false };
+	double m_streamingInterval{ 0 };	// [ns]	sample interval while streaming
+	uint32_t m_streamingBufferSize{ 0 };	//	number of samples the driver keeps while streaming
+	clock::time_point m_streamingStart;
+	uint64_t m_streamedSamples{ 0 };	//		number of samples handed over or lost since the streaming was started
+};
+
+#endif // PICODEVICE_H
\ No newline at end of file
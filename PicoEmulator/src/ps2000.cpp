@@ -0,0 +1,264 @@
+#include "ps2000.h"
+#include "picoDevice.h"
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+
+/*
+ * Emulates a PicoScope 2205 behind the ps2000 driver.
+ * The driver calls return 0 on failure, like the real ones.
+ */
+
+namespace {
+	const PICO_EMULATOR_MODEL ps2205{
+		"2205",				// variant
+		2,					// channels
+		16000,				// memory
+		PS2000_50MV,		// firstRange
+		PS2000_20V,			// lastRange
+		PS2000_MAX_VALUE,	// maxValue
+		true				// hasSignalGenerator
+	};
+
+	std::mutex unitsMutex;
+	std::map<int16_t, std::unique_ptr<PicoDevice>> units;
+	int16_t nextHandle{ 1 };
+
+	// the driver keeps the overview buffers until the next call
+	std::array<std::vector<int16_t>, 2 * PICO_EMULATOR_CHANNELS> overviewBuffers;
+	uint32_t overviewBufferSize{ 0 };
+
+	PicoDevice *getUnit(int16_t handle) {
+		auto unit = units.find(handle);
+		return (unit == units.end()) ? nullptr : unit->second.get();
+	}
+
+	// [ns]	the 2205 samples at 200 MS/s divided by powers of two, with two channels at 100 MS/s at most
+	double getInterval(PicoDevice *unit, int16_t timebase) {
+		if (timebase < 0 || timebase > PS2000_MAX_TIMEBASE || (timebase == 0 && unit->enabledChannels() > 1)) {
+			return 0;
+		}
+		return 5.0 * (1 << timebase);
+	}
+
+	double toNanoseconds(uint32_t value, PS2000_TIME_UNITS units) {
+		const double factors[] = { 1e-6, 1e-3, 1, 1e3, 1e6, 1e9 };
+		return (units < PS2000_MAX_TIME_UNITS) ? value * factors[units] : 0;
+	}
+}
+
+int16_t ps2000_open_unit(void) {
+	auto settings = PicoDevice::getSettingsFromEnvironment();
+	auto unit = std::unique_ptr<PicoDevice>(new PicoDevice(ps2205, settings));
+	// opening loads the firmware, the other units stay usable meanwhile
+	unit->wait(settings.openTime);
+	std::lock_guard<std::mutex> lock(unitsMutex);
+	int16_t handle = nextHandle++;
+	units[handle] = std::move(unit);
+	return handle;
+}
+
+int16_t ps2000_get_unit_info(int16_t handle, int8_t *string, int16_t string_length, int16_t line) {
+	std::lock_guard<std::mutex> lock(unitsMutex);
+	if (!string || string_length <= 0) {
+		return 0;
+	}
+	const char *info{ "" };
+	switch (line) {
+		case PS2000_DRIVER_VERSION:
+			info = "PicoEmulator 1.0";
+			break;
+		case PS2000_USB_VERSION:
+			info = "2.0";
+			break;
+		case PS2000_HARDWARE_VERSION:
+			info = "1";
+			break;
+		case PS2000_VARIANT_INFO:
+			info = ps2205.variant;
+			break;
+		case PS2000_BATCH_AND_SERIAL:
+			info = "EMU00/000";
+			break;
+		case PS2000_CAL_DATE:
+			info = "01Jan20";
+			break;
+		case PS2000_ERROR_CODE:
+			// without a unit the error code tells that none was found
+			info = getUnit(handle) ? "0" : "3";
+			break;
+		default:
+			return 0;
+	}
+	snprintf((char *)string, string_length, "%s", info);
+	return (int16_t)strlen((char *)string);
+}
+
+int16_t ps2000_close_unit(int16_t handle) {
+	std::lock_guard<std::mutex> lock(unitsMutex);
+	return (int16_t)units.erase(handle);
+}
+
+int16_t ps2000_set_channel(int16_t handle, int16_t channel, int16_t enabled, int16_t dc, int16_t range) {
+	std::lock_guard<std::mutex> lock(unitsMutex);
+	auto unit = getUnit(handle);
+	return (unit && unit->setChannel(channel, enabled != 0, dc != 0, range)) ? 1 : 0;
+}
+
+int16_t ps2000_set_trigger(int16_t handle, int16_t source, int16_t threshold, int16_t direction, int16_t delay, int16_t auto_trigger_ms) {
+	std::lock_guard<std::mutex> lock(unitsMutex);
+	auto unit = getUnit(handle);
+	if (!unit) {
+		return 0;
+	}
+	// the emulated unit always triggers immediately
+	unit->configure();
+	return 1;
+}
+
+int32_t ps2000_set_ets(int16_t handle, int16_t mode, int16_t ets_cycles, int16_t ets_interleave) {
+	std::lock_guard<std::mutex> lock(unitsMutex);
+	auto unit = getUnit(handle);
+	if (!unit || mode != PS2000_ETS_OFF) {
+		return 0;
+	}
+	unit->configure();
+	return 0;
+}
+
+int16_t ps2000_get_timebase(int16_t handle, int16_t timebase, int32_t no_of_samples, int32_t *time_interval, int16_t *time_units, int16_t oversample, int32_t *max_samples) {
+	std::lock_guard<std::mutex> lock(unitsMutex);
+	auto unit = getUnit(handle);
+	if (!unit) {
+		return 0;
+	}
+	unit->command();
+	double interval = getInterval(unit, timebase);
+	if (interval == 0 || no_of_samples <= 0 || (uint32_t)no_of_samples > unit->maxSamples() || oversample < 1 || oversample > PS2000_MAX_OVERSAMPLE) {
+		return 0;
+	}
+	if (time_interval) {
+		*time_interval = (int32_t)interval;
+	}
+	if (time_units) {
+		*time_units = PS2000_NS;
+	}
+	if (max_samples) {
+		*max_samples = (int32_t)unit->maxSamples();
+	}
+	return 1;
+}
+
+int16_t ps2000_run_block(int16_t handle, int32_t no_of_values, int16_t timebase, int16_t oversample, int32_t *time_indisposed_ms) {
+	std::lock_guard<std::mutex> lock(unitsMutex);
+	auto unit = getUnit(handle);
+	if (!unit) {
+		return 0;
+	}
+	double interval = getInterval(unit, timebase);
+	if (interval == 0 || no_of_values <= 0 || (uint32_t)no_of_values > unit->maxSamples()) {
+		return 0;
+	}
+	unit->runBlock(no_of_values, interval);
+	if (time_indisposed_ms) {
+		*time_indisposed_ms = (int32_t)(no_of_values * interval / 1e6);
+	}
+	return 1;
+}
+
+int16_t ps2000_ready(int16_t handle) {
+	std::lock_guard<std::mutex> lock(unitsMutex);
+	auto unit = getUnit(handle);
+	if (!unit) {
+		return -1;
+	}
+	return unit->isReady() ? 1 : 0;
+}
+
+int16_t ps2000_stop(int16_t handle) {
+	std::lock_guard<std::mutex> lock(unitsMutex);
+	auto unit = getUnit(handle);
+	if (!unit) {
+		return 0;
+	}
+	unit->stop();
+	return 1;
+}
+
+int32_t ps2000_get_times_and_values(int16_t handle, int32_t *times, int16_t *buffer_a, int16_t *buffer_b, int16_t *buffer_c, int16_t *buffer_d, int16_t *overflow, int16_t time_units, int32_t no_of_values) {
+	std::lock_guard<std::mutex> lock(unitsMutex);
+	auto unit = getUnit(handle);
+	if (!unit || no_of_values <= 0 || time_units < PS2000_FS || time_units >= PS2000_MAX_TIME_UNITS) {
+		return 0;
+	}
+	int16_t overflowFlags{ 0 };
+	auto nrValues = unit->readBlock({ { buffer_a, buffer_b, buffer_c, buffer_d } }, 0, no_of_values, overflowFlags);
+	if (nrValues == 0) {
+		return 0;
+	}
+	if (overflow) {
+		*overflow = overflowFlags;
+	}
+	if (times) {
+		double unitLength = toNanoseconds(1, (PS2000_TIME_UNITS)time_units);
+		for (uint32_t i{ 0 }; i < nrValues; i++) {
+			times[i] = (int32_t)(i * unit->getBlockInterval() / unitLength);
+		}
+	}
+	return (int32_t)nrValues;
+}
+
+int16_t ps2000_run_streaming_ns(int16_t handle, uint32_t sample_interval, PS2000_TIME_UNITS time_units, uint32_t max_samples, int16_t auto_stop, uint32_t noOfSamplesPerAggregate, uint32_t overview_buffer_size) {
+	std::lock_guard<std::mutex> lock(unitsMutex);
+	auto unit = getUnit(handle);
+	double interval = toNanoseconds(sample_interval, time_units);
+	// fast streaming is limited to 1 MS/s on the 2000 series
+	if (!unit || interval < 1000 || overview_buffer_size == 0 || noOfSamplesPerAggregate != 1) {
+		return 0;
+	}
+	overviewBufferSize = overview_buffer_size;
+	for (auto &buffer : overviewBuffers) {
+		buffer.resize(overviewBufferSize);
+	}
+	unit->runStreaming(interval, max_samples);
+	return 1;
+}
+
+int16_t ps2000_get_streaming_last_values(int16_t handle, GetOverviewBuffersMaxMin lpGetOverviewBuffersMaxMin) {
+	std::array<int16_t *, 2 * PICO_EMULATOR_CHANNELS> buffers;
+	uint32_t nrValues{ 0 };
+	int16_t overflow{ 0 };
+	{
+		std::lock_guard<std::mutex> lock(unitsMutex);
+		auto unit = getUnit(handle);
+		if (!unit || !unit->isStreaming() || !lpGetOverviewBuffersMaxMin) {
+			return 0;
+		}
+		nrValues = unit->readStreaming({ { overviewBuffers[0].data(), overviewBuffers[2].data(), overviewBuffers[4].data(), overviewBuffers[6].data() } }, overviewBufferSize, overflow);
+		// without aggregation the minimum equals the maximum
+		for (int ch{ 0 }; ch < PICO_EMULATOR_CHANNELS; ch++) {
+			std::copy(overviewBuffers[2 * ch].begin(), overviewBuffers[2 * ch].begin() + nrValues, overviewBuffers[2 * ch + 1].begin());
+		}
+		for (int i{ 0 }; i < 2 * PICO_EMULATOR_CHANNELS; i++) {
+			buffers[i] = overviewBuffers[i].data();
+		}
+	}
+	if (nrValues > 0) {
+		lpGetOverviewBuffersMaxMin(buffers.data(), overflow, 0, 0, 0, nrValues);
+	}
+	return 1;
+}
+
+int16_t ps2000_set_sig_gen_built_in(int16_t handle, int32_t offsetVoltage, uint32_t pkToPk, PS2000_WAVE_TYPE waveType, float startFrequency, float stopFrequency, float increment, float dwellTime, PS2000_SWEEP_TYPE sweepType, uint32_t sweeps) {
+	std::lock_guard<std::mutex> lock(unitsMutex);
+	auto unit = getUnit(handle);
+	// the offset of the 2205 signal generator is limited to +-2 V
+	if (!unit || !unit->getModel().hasSignalGenerator || offsetVoltage > 2000000 || offsetVoltage < -2000000) {
+		return 0;
+	}
+	unit->setOutputVoltage(offsetVoltage / 1e6);
+	return 1;
+}
\ No newline at end of file
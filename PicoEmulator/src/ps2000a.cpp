@@ -0,0 +1,381 @@
+#include "ps2000aApi.h"
+#include "picoDevice.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/*
+ * Emulates a PicoScope 2405A behind the ps2000a driver.
+ */
+
+namespace {
+	const PICO_EMULATOR_MODEL ps2405a{
+		"2405A",				// variant
+		4,						// channels
+		48000000,				// memory
+		PS2000A_50MV,			// firstRange
+		PS2000A_20V,			// lastRange
+		PS2000A_MAX_VALUE,		// maxValue
+		true					// hasSignalGenerator
+	};
+
+	typedef struct DATA_BUFFER {
+		int16_t *max{ nullptr };
+		int16_t *min{ nullptr };
+		int32_t length{ 0 };
+	} DATA_BUFFER;
+
+	typedef struct UNIT {
+		std::unique_ptr<PicoDevice> device;
+		std::array<DATA_BUFFER, PICO_EMULATOR_CHANNELS> buffers;
+		uint32_t overviewBufferSize{ 0 };
+		uint32_t streamingIndex{ 0 };	// index the next streamed samples are written to
+	} UNIT;
+
+	std::mutex unitsMutex;
+	std::map<int16_t, UNIT> units;
+	int16_t nextHandle{ 1 };
+
+	UNIT *getUnit(int16_t handle) {
+		auto unit = units.find(handle);
+		return (unit == units.end()) ? nullptr : &unit->second;
+	}
+
+	// [ns]	the 2405A shares 500 MS/s between the enabled channels
+	double getInterval(PicoDevice *device, uint32_t timebase) {
+		auto channels = device->enabledChannels();
+		uint32_t minTimebase = (channels <= 1) ? 0 : ((channels == 2) ? 1 : 2);
+		if (timebase < minTimebase) {
+			return 0;
+		}
+		return (timebase < 3) ? 2.0 * (1 << timebase) : 16.0 * (timebase - 2.0);
+	}
+
+	double toNanoseconds(double value, PS2000A_TIME_UNITS units) {
+		const double factors[] = { 1e-6, 1e-3, 1, 1e3, 1e6, 1e9 };
+		return (units >= PS2000A_FS && units < PS2000A_MAX_TIME_UNITS) ? value * factors[units] : 0;
+	}
+}
+
+PICO_STATUS ps2000aOpenUnit(int16_t *handle, int8_t *serial) {
+	if (!handle) {
+		return PICO_NULL_PARAMETER;
+	}
+	auto settings = PicoDevice::getSettingsFromEnvironment();
+	UNIT unit;
+	unit.device = std::unique_ptr<PicoDevice>(new PicoDevice(ps2405a, settings));
+	// opening loads the firmware, the other units stay usable meanwhile
+	unit.device->wait(settings.openTime);
+	std::lock_guard<std::mutex> lock(unitsMutex);
+	*handle = nextHandle++;
+	units[*handle] = std::move(unit);
+	return PICO_OK;
+}
+
+PICO_STATUS ps2000aGetUnitInfo(int16_t handle, int8_t *string, int16_t stringLength, int16_t *requiredSize, PICO_INFO info) {
+	std::lock_guard<std::mutex> lock(unitsMutex);
+	if (!getUnit(handle)) {
+		return PICO_INVALID_HANDLE;
+	}
+	const char *line{ "" };
+	switch (info) {
+		case PICO_DRIVER_VERSION:
+			line = "PicoEmulator 1.0";
+			break;
+		case PICO_USB_VERSION:
+			line = "2.0";
+			break;
+		case PICO_HARDWARE_VERSION:
+			line = "1";
+			break;
+		case PICO_VARIANT_INFO:
+			line = ps2405a.variant;
+			break;
+		case PICO_BATCH_AND_SERIAL:
+			line = "EMU00/000";
+			break;
+		case PICO_CAL_DATE:
+			line = "01Jan20";
+			break;
+		case PICO_KERNEL_VERSION:
+			line = "1.0";
+			break;
+		default:
+			return PICO_INVALID_PARAMETER;
+	}
+	auto length = (int16_t)(strlen(line) + 1);
+	if (requiredSize) {
+		*requiredSize = length;
+	}
+	if (!string) {
+		return PICO_OK;
+	}
+	snprintf((char *)string, stringLength, "%s", line);
+	return (stringLength < length) ? PICO_STRING_BUFFER_TO_SMALL : PICO_OK;
+}
+
+PICO_STATUS ps2000aCloseUnit(int16_t handle) {
+	std::lock_guard<std::mutex> lock(unitsMutex);
+	return units.erase(handle) ? PICO_OK : PICO_INVALID_HANDLE;
+}
+
+PICO_STATUS ps2000aSetChannel(int16_t handle, PS2000A_CHANNEL channel, int16_t enabled, PS2000A_COUPLING type, PS2000A_RANGE range, float analogOffset) {
+	std::lock_guard<std::mutex> lock(unitsMutex);
+	auto unit = getUnit(handle);
+	if (!unit) {
+		return PICO_INVALID_HANDLE;
+	}
+	if (channel < PS2000A_CHANNEL_A || channel >= ps2405a.channels) {
+		unit->device->command();
+		return PICO_INVALID_CHANNEL;
+	}
+	return unit->device->setChannel(channel, enabled != 0, type == PS2000A_DC, range) ? PICO_OK : PICO_INVALID_VOLTAGE_RANGE;
+}
+
+PICO_STATUS ps2000aSetSimpleTrigger(int16_t handle, int16_t enable, PS2000A_CHANNEL source, int16_t threshold, PS2000A_THRESHOLD_DIRECTION direction, uint32_t delay, int16_t autoTrigger_ms) {
+	std::lock_guard<std::mutex> lock(unitsMutex);
+	auto unit = getUnit(handle);
+	if (!unit) {
+		return PICO_INVALID_HANDLE;
+	}
+	// the emulated unit always triggers immediately
+	unit->device->configure();
+	return PICO_OK;
+}
+
+PICO_STATUS ps2000aSetEts(int16_t handle, PS2000A_ETS_MODE mode, int16_t etsCycles, int16_t etsInterleave, int32_t *sampleTimePicoseconds) {
+	std::lock_guard<std::mutex> lock(unitsMutex);
+	auto unit = getUnit(handle);
+	if (!unit) {
+		return PICO_INVALID_HANDLE;
+	}
+	unit->device->configure();
+	if (mode != PS2000A_ETS_OFF) {
+		return PICO_INVALID_PARAMETER;
+	}
+	if (sampleTimePicoseconds) {
+		*sampleTimePicoseconds = 0;
+	}
+	return PICO_OK;
+}
+
+PICO_STATUS ps2000aGetTimebase(int16_t handle, uint32_t timebase, int32_t noSamples, int32_t *timeIntervalNanoseconds, int16_t oversample, int32_t *totalSamples, uint32_t segmentIndex) {
+	std::lock_guard<std::mutex> lock(unitsMutex);
+	auto unit = getUnit(handle);
+	if (!unit) {
+		return PICO_INVALID_HANDLE;
+	}
+	unit->device->command();
+	double interval = getInterval(unit->device.get(), timebase);
+	if (interval == 0) {
+		return PICO_INVALID_TIMEBASE;
+	}
+	if (noSamples <= 0 || (uint32_t)noSamples > unit->device->maxSamples()) {
+		return PICO_TOO_MANY_SAMPLES;
+	}
+	if (timeIntervalNanoseconds) {
+		*timeIntervalNanoseconds = (int32_t)interval;
+	}
+	if (totalSamples) {
+		*totalSamples = (int32_t)unit->device->maxSamples();
+	}
+	return PICO_OK;
+}
+
+PICO_STATUS ps2000aRunBlock(int16_t handle, int32_t noOfPreTriggerSamples, int32_t noOfPostTriggerSamples, uint32_t timebase, int16_t oversample, int32_t *timeIndisposedMs, uint32_t segmentIndex, ps2000aBlockReady lpReady, void *pParameter) {
+	std::lock_guard<std::mutex> lock(unitsMutex);
+	auto unit = getUnit(handle);
+	if (!unit) {
+		return PICO_INVALID_HANDLE;
+	}
+	double interval = getInterval(unit->device.get(), timebase);
+	if (interval == 0) {
+		return PICO_INVALID_TIMEBASE;
+	}
+	auto nrSamples = noOfPreTriggerSamples + noOfPostTriggerSamples;
+	if (nrSamples <= 0 || (uint32_t)nrSamples > unit->device->maxSamples()) {
+		return PICO_TOO_MANY_SAMPLES;
+	}
+	unit->device->runBlock(nrSamples, interval);
+	if (timeIndisposedMs) {
+		*timeIndisposedMs = (int32_t)(nrSamples * interval / 1e6);
+	}
+	if (lpReady) {
+		// the driver signals the finished capture from its own thread
+		auto readyTime = unit->device->getBlockReadyTime();
+		std::thread([handle, lpReady, pParameter, readyTime]() {
+			std::this_thread::sleep_until(readyTime);
+			lpReady(handle, PICO_OK, pParameter);
+		}).detach();
+	}
+	return PICO_OK;
+}
+
+PICO_STATUS ps2000aIsReady(int16_t handle, int16_t *ready) {
+	std::lock_guard<std::mutex> lock(unitsMutex);
+	auto unit = getUnit(handle);
+	if (!unit) {
+		return PICO_INVALID_HANDLE;
+	}
+	if (!ready) {
+		return PICO_NULL_PARAMETER;
+	}
+	*ready = unit->device->isReady() ? 1 : 0;
+	return PICO_OK;
+}
+
+PICO_STATUS ps2000aStop(int16_t handle) {
+	std::lock_guard<std::mutex> lock(unitsMutex);
+	auto unit = getUnit(handle);
+	if (!unit) {
+		return PICO_INVALID_HANDLE;
+	}
+	unit->device->stop();
+	return PICO_OK;
+}
+
+PICO_STATUS ps2000aSetDataBuffers(int16_t handle, int32_t channelOrPort, int16_t *bufferMax, int16_t *bufferMin, int32_t bufferLth, uint32_t segmentIndex, PS2000A_RATIO_MODE mode) {
+	std::lock_guard<std::mutex> lock(unitsMutex);
+	auto unit = getUnit(handle);
+	if (!unit) {
+		return PICO_INVALID_HANDLE;
+	}
+	if (channelOrPort < PS2000A_CHANNEL_A || channelOrPort >= ps2405a.channels) {
+		return PICO_INVALID_CHANNEL;
+	}
+	if (mode != PS2000A_RATIO_MODE_NONE) {
+		return PICO_INVALID_PARAMETER;
+	}
+	unit->buffers[channelOrPort].max = bufferMax;
+	unit->buffers[channelOrPort].min = bufferMin;
+	unit->buffers[channelOrPort].length = bufferLth;
+	return PICO_OK;
+}
+
+PICO_STATUS ps2000aGetValues(int16_t handle, uint32_t startIndex, uint32_t *noOfSamples, uint32_t downSampleRatio, PS2000A_RATIO_MODE downSampleRatioMode, uint32_t segmentIndex, int16_t *overflow) {
+	std::lock_guard<std::mutex> lock(unitsMutex);
+	auto unit = getUnit(handle);
+	if (!unit) {
+		return PICO_INVALID_HANDLE;
+	}
+	if (!noOfSamples) {
+		return PICO_NULL_PARAMETER;
+	}
+	// the samples are copied to the registered buffers, which have to hold them
+	std::array<int16_t *, PICO_EMULATOR_CHANNELS> buffers;
+	uint32_t nrSamples = *noOfSamples;
+	for (int ch{ 0 }; ch < PICO_EMULATOR_CHANNELS; ch++) {
+		buffers[ch] = unit->buffers[ch].max;
+		if (buffers[ch] && (uint32_t)unit->buffers[ch].length < nrSamples) {
+			nrSamples = unit->buffers[ch].length;
+		}
+	}
+	int16_t overflowFlags{ 0 };
+	nrSamples = unit->device->readBlock(buffers, startIndex, nrSamples, overflowFlags);
+	if (nrSamples == 0) {
+		return PICO_NO_SAMPLES_AVAILABLE;
+	}
+	// without down sampling the minimum equals the maximum
+	for (int ch{ 0 }; ch < PICO_EMULATOR_CHANNELS; ch++) {
+		if (unit->buffers[ch].max && unit->buffers[ch].min) {
+			std::copy(unit->buffers[ch].max, unit->buffers[ch].max + nrSamples, unit->buffers[ch].min);
+		}
+	}
+	*noOfSamples = nrSamples;
+	if (overflow) {
+		*overflow = overflowFlags;
+	}
+	return PICO_OK;
+}
+
+PICO_STATUS ps2000aRunStreaming(int16_t handle, uint32_t *sampleInterval, PS2000A_TIME_UNITS sampleIntervalTimeUnits, uint32_t maxPreTriggerSamples, uint32_t maxPostPreTriggerSamples, int16_t autoStop, uint32_t downSampleRatio, PS2000A_RATIO_MODE downSampleRatioMode, uint32_t overviewBufferSize) {
+	std::lock_guard<std::mutex> lock(unitsMutex);
+	auto unit = getUnit(handle);
+	if (!unit) {
+		return PICO_INVALID_HANDLE;
+	}
+	if (!sampleInterval) {
+		return PICO_NULL_PARAMETER;
+	}
+	double requested = toNanoseconds(*sampleInterval, sampleIntervalTimeUnits);
+	if (requested <= 0 || overviewBufferSize == 0 || downSampleRatioMode != PS2000A_RATIO_MODE_NONE) {
+		return PICO_INVALID_PARAMETER;
+	}
+	// the driver picks the closest interval of the 62.5 MHz timebase and reports it back
+	uint32_t timebase = (uint32_t)round(requested / 16.0) + 2;
+	timebase = (timebase < 3) ? 3 : timebase;
+	double interval = getInterval(unit->device.get(), timebase);
+	*sampleInterval = (uint32_t)round(interval / toNanoseconds(1, sampleIntervalTimeUnits));
+	unit->overviewBufferSize = overviewBufferSize;
+	unit->streamingIndex = 0;
+	unit->device->runStreaming(interval, maxPreTriggerSamples + maxPostPreTriggerSamples);
+	return PICO_OK;
+}
+
+PICO_STATUS ps2000aGetStreamingLatestValues(int16_t handle, ps2000aStreamingReady lpPs2000aReady, void *pParameter) {
+	uint32_t nrSamples{ 0 };
+	uint32_t startIndex{ 0 };
+	int16_t overflow{ 0 };
+	{
+		std::lock_guard<std::mutex> lock(unitsMutex);
+		auto unit = getUnit(handle);
+		if (!unit) {
+			return PICO_INVALID_HANDLE;
+		}
+		if (!unit->device->isStreaming()) {
+			return PICO_BUSY;
+		}
+		// the samples are written to the registered buffers like to a ring, up to the end of the buffers at once
+		startIndex = unit->streamingIndex;
+		uint32_t maxSamples = unit->overviewBufferSize;
+		std::array<int16_t *, PICO_EMULATOR_CHANNELS> buffers{ { nullptr, nullptr, nullptr, nullptr } };
+		for (int ch{ 0 }; ch < PICO_EMULATOR_CHANNELS; ch++) {
+			auto &buffer = unit->buffers[ch];
+			if (!buffer.max || buffer.length <= 0) {
+				continue;
+			}
+			if ((uint32_t)buffer.length <= startIndex) {
+				startIndex = 0;
+			}
+			uint32_t space = buffer.length - startIndex;
+			maxSamples = (space < maxSamples) ? space : maxSamples;
+		}
+		for (int ch{ 0 }; ch < PICO_EMULATOR_CHANNELS; ch++) {
+			if (unit->buffers[ch].max) {
+				buffers[ch] = unit->buffers[ch].max + startIndex;
+			}
+		}
+		nrSamples = unit->device->readStreaming(buffers, maxSamples, overflow);
+		for (int ch{ 0 }; ch < PICO_EMULATOR_CHANNELS; ch++) {
+			if (unit->buffers[ch].max && unit->buffers[ch].min) {
+				std::copy(buffers[ch], buffers[ch] + nrSamples, unit->buffers[ch].min + startIndex);
+			}
+		}
+		unit->streamingIndex = startIndex + nrSamples;
+	}
+	if (nrSamples > 0 && lpPs2000aReady) {
+		lpPs2000aReady(handle, (int32_t)nrSamples, startIndex, overflow, 0, 0, 0, pParameter);
+	}
+	return PICO_OK;
+}
+
+PICO_STATUS ps2000aSetSigGenBuiltIn(int16_t handle, int32_t offsetVoltage, uint32_t pkToPk, PS2000A_WAVE_TYPE waveType, float startFrequency, float stopFrequency, float increment, float dwellTime, PS2000A_SWEEP_TYPE sweepType, PS2000A_EXTRA_OPERATIONS operationType, uint32_t shots, uint32_t sweeps, PS2000A_SIGGEN_TRIG_TYPE triggerType, PS2000A_SIGGEN_TRIG_SOURCE triggerSource, int16_t extInThreshold) {
+	std::lock_guard<std::mutex> lock(unitsMutex);
+	auto unit = getUnit(handle);
+	if (!unit) {
+		return PICO_INVALID_HANDLE;
+	}
+	// the offset of the 2405A signal generator is limited to +-2 V
+	if (offsetVoltage > 2000000 || offsetVoltage < -2000000) {
+		unit->device->command();
+		return PICO_INVALID_PARAMETER;
+	}
+	unit->device->setOutputVoltage(offsetVoltage / 1e6);
+	return PICO_OK;
+}
\ No newline at end of file